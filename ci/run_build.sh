@@ -87,6 +87,10 @@ build_drivers() {
     sudo dpkg -i ./libnewlib-arm-none-eabi_3.3.0-1.3_all.deb
 
     make -j${NUM_JOBS} -C ./drivers -f Makefile
+
+    # The NEON kernels of iio_scan.c are not built by any of the above
+    arm-none-eabi-gcc -c -Wall -Werror -mcpu=cortex-a9 -mfpu=neon \
+        -mfloat-abi=hard -I./include -I./iio ./iio/iio_scan.c -o /dev/null
 }
 
 build_documentation() {
@@ -963,6 +963,40 @@ static int adxl355_iio_update_channels(void* dev, uint32_t mask)
 	return 0;
 }
 
+/**
+ * @struct adxl355_iio_scan
+ * @brief Data-set to be written by adxl355_fill_scan().
+ */
+struct adxl355_iio_scan {
+	/** Raw x, y and z data read from the device. */
+	uint32_t raw[3];
+	/** The active channels mask. */
+	uint32_t mask;
+};
+
+/***************************************************************************//**
+ * @brief Fills one scan in place with the active axes of a raw data-set.
+ *
+ * @param ctx      - The adxl355_iio_scan describing the data-set.
+ * @param scans    - Where to write the scan.
+ * @param nb_scans - Number of scans to write, always 1.
+ *
+ * @return ret     - 0 in case of success.
+*******************************************************************************/
+static int adxl355_fill_scan(void *ctx, void *scans, uint32_t nb_scans)
+{
+	struct adxl355_iio_scan *scan = ctx;
+	int32_t *data_buff = scans;
+	uint8_t i = 0;
+	uint8_t axis;
+
+	for (axis = 0; axis < 3; axis++)
+		if (scan->mask & NO_OS_BIT(axis))
+			data_buff[i++] = no_os_sign_extend32(scan->raw[axis], 19);
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief Handles trigger: reads one data-set and writes it to the buffer.
  *
@@ -973,9 +1007,8 @@ static int adxl355_iio_update_channels(void* dev, uint32_t mask)
 *******************************************************************************/
 static int32_t adxl355_trigger_handler(struct iio_device_data *dev_data)
 {
-	int32_t data_buff[3];
-	uint32_t x, y, z;
-	uint8_t i = 0;
+	struct adxl355_iio_scan scan;
+	int ret;
 
 	struct adxl355_iio_dev *iio_adxl355;
 	struct adxl355_dev *adxl355;
@@ -990,22 +1023,15 @@ static int32_t adxl355_trigger_handler(struct iio_device_data *dev_data)
 
 	adxl355 = iio_adxl355->adxl355_dev;
 
-	adxl355_get_raw_xyz(adxl355, &x, &y, &z);
+	adxl355_get_raw_xyz(adxl355, &scan.raw[0], &scan.raw[1], &scan.raw[2]);
+	scan.mask = dev_data->buffer->active_mask;
 
-	if (dev_data->buffer->active_mask & NO_OS_BIT(0)) {
-		data_buff[0] = no_os_sign_extend32(x, 19);
-		i++;
-	}
-	if (dev_data->buffer->active_mask & NO_OS_BIT(1)) {
-		data_buff[i] = no_os_sign_extend32(y, 19);
-		i++;
-	}
-	if (dev_data->buffer->active_mask & NO_OS_BIT(2)) {
-		data_buff[i] = no_os_sign_extend32(z, 19);
-		i++;
-	}
+	ret = iio_buffer_push_scans(dev_data->buffer, 1, adxl355_fill_scan,
+				    &scan);
+	if (ret < 0)
+		return ret;
 
-	return iio_buffer_push_scan(dev_data->buffer, &data_buff[0]);
+	return 0;
 }
 
 /***************************************************************************//**
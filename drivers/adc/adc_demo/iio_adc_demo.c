@@ -130,46 +130,69 @@ int set_adc_demo_attr(void *device, char *buf, uint32_t len,
 }
 
 /**
- * @brief function for reading samples from the device.
- * @param dev_data  - The iio device data structure.
- * @return the number of read samples.
+ * @struct adc_demo_fill
+ * @brief State of iio_adc_demo_fill_scans().
  */
-int32_t adc_submit_samples(struct iio_device_data *dev_data)
-{
+struct adc_demo_fill {
+	/** Device instance */
 	struct adc_demo_desc *desc;
-	uint32_t k = 0;
+	/** Sample index of the next scan */
+	uint32_t idx;
+};
+
+/**
+ * @brief Fill scans in place with the samples of the active channels.
+ * @param ctx - The adc_demo_fill state.
+ * @param scans - Where to write the scans.
+ * @param nb_scans - Number of scans to write.
+ * @return 0 in case of success.
+ */
+static int iio_adc_demo_fill_scans(void *ctx, void *scans, uint32_t nb_scans)
+{
+	struct adc_demo_fill *fill = ctx;
+	struct adc_demo_desc *desc = fill->desc;
+	int offset_per_ch = NO_OS_ARRAY_SIZE(sine_lut) / TOTAL_ADC_CHANNELS;
+	uint16_t *buff = scans;
+	uint16_t *ch_buf_ptr;
 	uint32_t ch = -1;
-	uint16_t buff[TOTAL_ADC_CHANNELS];
 	uint32_t i;
-	uint16_t *ch_buf_ptr;
-
-	if (!dev_data)
-		return -ENODEV;
-
-	desc = (struct adc_demo_desc *)dev_data->dev;
 
-	if (desc->ext_buff == NULL) {
-		int offset_per_ch = NO_OS_ARRAY_SIZE(sine_lut) / TOTAL_ADC_CHANNELS;
-		for (i = 0; i < dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
-		     i++) {
+	for (i = 0; i < nb_scans; i++, fill->idx++) {
+		if (desc->ext_buff == NULL) {
 			while (get_next_ch_idx(desc->active_ch, ch, &ch))
-				buff[k++] = sine_lut[(i + ch * offset_per_ch) % NO_OS_ARRAY_SIZE(sine_lut)];
-			k = 0;
-			iio_buffer_push_scan(dev_data->buffer, buff);
+				*buff++ = sine_lut[(fill->idx + ch * offset_per_ch) %
+						   NO_OS_ARRAY_SIZE(sine_lut)];
+			continue;
 		}
-		return dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
-	}
 
-	for (i = 0; i < dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
-	     i++) {
 		while (get_next_ch_idx(desc->active_ch, ch, &ch)) {
 			ch_buf_ptr = (uint16_t*)desc->ext_buff + (ch * desc->ext_buff_len);
-			buff[k++] = ch_buf_ptr[i];
+			*buff++ = ch_buf_ptr[fill->idx];
 		}
-		k = 0;
-		iio_buffer_push_scan(dev_data->buffer, buff);
 	}
-	return dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
+
+	return 0;
+}
+
+/**
+ * @brief function for reading samples from the device.
+ * @param dev_data  - The iio device data structure.
+ * @return the number of read samples.
+ */
+int32_t adc_submit_samples(struct iio_device_data *dev_data)
+{
+	struct adc_demo_fill fill;
+
+	if (!dev_data)
+		return -ENODEV;
+
+	fill.desc = (struct adc_demo_desc *)dev_data->dev;
+	fill.idx = 0;
+
+	return iio_buffer_push_scans(dev_data->buffer,
+				     dev_data->buffer->size /
+				     dev_data->buffer->bytes_per_scan,
+				     iio_adc_demo_fill_scans, &fill);
 }
 
 
@@ -183,40 +206,34 @@ int32_t adc_submit_samples(struct iio_device_data *dev_data)
  */
 int32_t adc_demo_trigger_handler(struct iio_device_data *dev_data)
 {
-	struct adc_demo_desc *desc;
-	uint32_t k = 0;
-	uint32_t ch = -1;
-	uint16_t buff[TOTAL_ADC_CHANNELS];
+	struct adc_demo_fill fill;
 	static uint32_t i = 0;
-	uint16_t *ch_buf_ptr;
+	int ret;
 
 	if (!dev_data)
 		return -EINVAL;
 
-	desc = (struct adc_demo_desc *)dev_data->dev;
+	fill.desc = (struct adc_demo_desc *)dev_data->dev;
+	fill.idx = i;
 
-	if (desc->ext_buff == NULL) {
-		int offset_per_ch = NO_OS_ARRAY_SIZE(sine_lut) / TOTAL_ADC_CHANNELS;
-		while (get_next_ch_idx(desc->active_ch, ch, &ch))
-			buff[k++] = sine_lut[(i + ch * offset_per_ch) % NO_OS_ARRAY_SIZE(sine_lut)];
+	ret = iio_buffer_push_scans(dev_data->buffer, 1,
+				    iio_adc_demo_fill_scans, &fill);
+	if (ret < 0)
+		return ret;
+
+	if (fill.desc->ext_buff == NULL) {
 		if (i == NO_OS_ARRAY_SIZE(sine_lut))
 			i = 0;
 		else
 			i++;
-
-		return iio_buffer_push_scan(dev_data->buffer, buff);
-	}
-
-	while (get_next_ch_idx(desc->active_ch, ch, &ch)) {
-		ch_buf_ptr = (uint16_t*)desc->ext_buff + (ch * desc->ext_buff_len);
-		buff[k++] = ch_buf_ptr[i];
+	} else {
+		if (i == (fill.desc->ext_buff_len - 1))
+			i = 0;
+		else
+			i++;
 	}
-	if (i == (desc->ext_buff_len - 1))
-		i = 0;
-	else
-		i++;
 
-	return iio_buffer_push_scan(dev_data->buffer, buff);
+	return 0;
 }
 
 #define ADC_DEMO_ATTR(_name, _priv) {\
@@ -34,6 +34,7 @@
 #include <inttypes.h>
 #include "no_os_spi.h"
 #include <stdlib.h>
+#include <string.h>
 #include "no_os_error.h"
 #include "no_os_mutex.h"
 #include "no_os_alloc.h"
@@ -76,6 +77,7 @@ int32_t no_os_spi_init(struct no_os_spi_desc **desc,
 	(*desc)->platform_ops = param->platform_ops;
 	(*desc)->parent = param->parent;
 	(*desc)->platform_delays = param->platform_delays;
+	(*desc)->batch = NULL;
 
 	return 0;
 }
@@ -118,6 +120,12 @@ int32_t no_os_spi_remove(struct no_os_spi_desc *desc)
 	if (!desc || !desc->platform_ops)
 		return -EINVAL;
 
+	if (desc->batch) {
+		no_os_free(desc->batch->msgs);
+		no_os_free(desc->batch);
+		desc->batch = NULL;
+	}
+
 	if (desc->bus)
 		no_os_spibus_remove(desc->bus->device_id);
 
@@ -276,3 +284,111 @@ int32_t no_os_spi_transfer_abort(struct no_os_spi_desc *desc)
 
 	return desc->platform_ops->transfer_abort(desc);
 }
+
+/**
+ * @brief Start a transaction batch. Until no_os_spi_batch_commit() is called,
+ * 	  messages passed to no_os_spi_batch_queue() are only recorded, and
+ * 	  are then sent together in a single transfer (a single
+ * 	  SPI_IOC_MESSAGE(N) ioctl on Linux).
+ * @param desc - The SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_spi_batch_begin(struct no_os_spi_desc *desc)
+{
+	if (!desc || !desc->platform_ops)
+		return -EINVAL;
+
+	if (!desc->batch) {
+		desc->batch = no_os_calloc(1, sizeof(*desc->batch));
+		if (!desc->batch)
+			return -ENOMEM;
+	}
+
+	if (desc->batch->active)
+		return -EBUSY;
+
+	desc->batch->len = 0;
+	desc->batch->active = true;
+
+	return 0;
+}
+
+/**
+ * @brief Queue a list of messages in the current transaction batch.
+ *
+ * The messages are copied, but the buffers they point to must stay valid until
+ * no_os_spi_batch_commit() returns; received data is only available after it.
+ * Each queued list is framed by its own chip select assertion, as it would be
+ * if it was sent with no_os_spi_transfer(). Unless the last message of the
+ * previous list already toggles CS, an empty message doing it is inserted
+ * between both lists; the messages of the caller are left unchanged.
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_spi_batch_queue(struct no_os_spi_desc *desc,
+			      struct no_os_spi_msg *msgs,
+			      uint32_t len)
+{
+	struct no_os_spi_batch *batch;
+	struct no_os_spi_msg *new_msgs;
+	struct no_os_spi_msg *last;
+	uint32_t size, sep;
+
+	if (!desc || !desc->batch || !desc->batch->active || !msgs || !len)
+		return -EINVAL;
+
+	batch = desc->batch;
+	/* The previous list ended a transfer, so CS has to toggle after it. */
+	sep = batch->len && !batch->msgs[batch->len - 1].cs_change;
+	if (batch->len + sep + len > batch->size) {
+		size = batch->size ? batch->size : 8;
+		while (size < batch->len + sep + len)
+			size *= 2;
+
+		new_msgs = no_os_calloc(size, sizeof(*new_msgs));
+		if (!new_msgs)
+			return -ENOMEM;
+
+		if (batch->len)
+			memcpy(new_msgs, batch->msgs, batch->len * sizeof(*new_msgs));
+		no_os_free(batch->msgs);
+		batch->msgs = new_msgs;
+		batch->size = size;
+	}
+
+	if (sep) {
+		last = &batch->msgs[batch->len - 1];
+		memset(&batch->msgs[batch->len], 0, sizeof(*batch->msgs));
+		batch->msgs[batch->len].cs_change = 1;
+		batch->msgs[batch->len].cs_change_delay = last->cs_change_delay;
+		batch->len++;
+	}
+
+	memcpy(&batch->msgs[batch->len], msgs, len * sizeof(*msgs));
+	batch->len += len;
+
+	return 0;
+}
+
+/**
+ * @brief Send all the messages queued since no_os_spi_batch_begin() in a
+ * 	  single transfer and end the transaction batch.
+ * @param desc - The SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_spi_batch_commit(struct no_os_spi_desc *desc)
+{
+	struct no_os_spi_batch *batch;
+
+	if (!desc || !desc->batch || !desc->batch->active)
+		return -EINVAL;
+
+	batch = desc->batch;
+	batch->active = false;
+	if (!batch->len)
+		return 0;
+
+	return no_os_spi_transfer(desc, batch->msgs, batch->len);
+}
@@ -133,14 +133,20 @@ int32_t axi_adc_set_pnsel(struct axi_adc *adc,
 int32_t axi_adc_pn_mon(struct axi_adc *adc,
 		       enum axi_adc_pn_sel sel, uint32_t delay_ms)
 {
+	struct no_os_axi_io_op ops[2];
 	uint8_t	ch;
 	uint32_t reg_data;
+	int32_t ret;
 
 	for (ch = 0; ch < adc->num_channels; ch++) {
-		axi_adc_read(adc, AXI_ADC_REG_CHAN_CNTRL(ch), &reg_data);
-		reg_data |= AXI_ADC_ENABLE;
-		axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL(ch), reg_data);
-		axi_adc_set_pnsel(adc, ch, sel);
+		ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_UPDATE(
+				 AXI_ADC_REG_CHAN_CNTRL(ch), AXI_ADC_ENABLE, AXI_ADC_ENABLE);
+		ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_UPDATE(
+				 AXI_ADC_REG_CHAN_CNTRL_3(ch), AXI_ADC_ADC_PN_SEL(~0),
+				 AXI_ADC_ADC_PN_SEL(sel));
+		ret = no_os_axi_io_batch(adc->base, ops, NO_OS_ARRAY_SIZE(ops));
+		if (ret)
+			return ret;
 	}
 	no_os_mdelay(1);
 
@@ -169,12 +175,15 @@ int32_t axi_adc_get_sampling_freq(struct axi_adc *adc,
 				  uint32_t chan,
 				  uint64_t *sampling_freq)
 {
-	uint32_t freq;
-	uint32_t ratio;
+	uint32_t clk[2];
+	int32_t ret;
 
-	axi_adc_read(adc, AXI_ADC_REG_CLK_FREQ, &freq);
-	axi_adc_read(adc, AXI_ADC_REG_CLK_RATIO, &ratio);
-	*sampling_freq = freq * ratio;
+	/* CLK_FREQ and CLK_RATIO are consecutive registers. */
+	ret = no_os_axi_io_read_burst(adc->base, AXI_ADC_REG_CLK_FREQ, clk,
+				      NO_OS_ARRAY_SIZE(clk));
+	if (ret)
+		return ret;
+	*sampling_freq = clk[0] * clk[1];
 	*sampling_freq = ((*sampling_freq) * 390625) >> 8;
 
 	return 0;
@@ -205,9 +214,11 @@ int32_t axi_adc_delay_set(struct axi_adc *adc,
 			  uint32_t no_of_lanes,
 			  uint32_t delay)
 {
+	struct no_os_axi_io_op ops[2];
 	uint32_t i;
 	uint32_t rdata;
 	uint32_t pcore_version;
+	int32_t ret;
 
 	axi_adc_read(adc, 0x0, &pcore_version);
 	pcore_version >>= 16;
@@ -217,8 +228,14 @@ int32_t axi_adc_delay_set(struct axi_adc *adc,
 		return -1;
 	} else {
 		for (i = 0; i < no_of_lanes; i++) {
-			axi_adc_idelay_set(adc, i, delay);
-			axi_adc_read(adc, AXI_ADC_REG_DELAY(i), &rdata);
+			ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+					 AXI_ADC_REG_DELAY(i), delay);
+			ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_READ(
+					 AXI_ADC_REG_DELAY(i));
+			ret = no_os_axi_io_batch(adc->base, ops, NO_OS_ARRAY_SIZE(ops));
+			if (ret)
+				return ret;
+			rdata = ops[1].value;
 			if (rdata != delay) {
 				printf("adc_delay_1: sel(%2d), rcv(%04x), exp(%04x)\n\r",
 				       (int)i, (int)rdata, (int)delay);
@@ -609,8 +626,8 @@ int32_t axi_adc_init_begin(struct axi_adc **adc_core,
 int32_t axi_adc_init_finish(struct axi_adc *adc)
 {
 	uint32_t reg_data;
-	uint32_t freq;
-	uint32_t ratio;
+	uint32_t clk[2];
+	int32_t ret;
 
 	axi_adc_read(adc, AXI_ADC_REG_STATUS, &reg_data);
 	if (reg_data == 0x0) {
@@ -618,9 +635,12 @@ int32_t axi_adc_init_finish(struct axi_adc *adc)
 		return -1;
 	}
 
-	axi_adc_read(adc, AXI_ADC_REG_CLK_FREQ, &freq);
-	axi_adc_read(adc, AXI_ADC_REG_CLK_RATIO, &ratio);
-	adc->clock_hz = freq * ratio;
+	/* CLK_FREQ and CLK_RATIO are consecutive registers. */
+	ret = no_os_axi_io_read_burst(adc->base, AXI_ADC_REG_CLK_FREQ, clk,
+				      NO_OS_ARRAY_SIZE(clk));
+	if (ret)
+		return ret;
+	adc->clock_hz = clk[0] * clk[1];
 	adc->clock_hz = (adc->clock_hz * 390625) >> 8;
 
 	printf("%s: Successfully initialized (%"PRIu64" Hz)\n",
@@ -638,6 +658,11 @@ int32_t axi_adc_init_finish(struct axi_adc *adc)
 int32_t axi_adc_init(struct axi_adc **adc_core,
 		     const struct axi_adc_init *init)
 {
+	struct no_os_axi_io_op rst_ops[] = {
+		NO_OS_AXI_IO_OP_WRITE(AXI_ADC_REG_RSTN, 0),
+		NO_OS_AXI_IO_OP_WRITE(AXI_ADC_REG_RSTN,
+				      AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN),
+	};
 	struct axi_adc *adc;
 	int32_t ret;
 	uint8_t ch;
@@ -646,9 +671,9 @@ int32_t axi_adc_init(struct axi_adc **adc_core,
 	if (ret)
 		return ret;
 
-	axi_adc_write(adc, AXI_ADC_REG_RSTN, 0);
-	axi_adc_write(adc, AXI_ADC_REG_RSTN,
-		      AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN);
+	ret = no_os_axi_io_batch(adc->base, rst_ops, NO_OS_ARRAY_SIZE(rst_ops));
+	if (ret)
+		goto error;
 
 	for (ch = 0; ch < adc->num_channels; ch++)
 		axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL(ch),
@@ -623,18 +623,20 @@ int32_t axi_dac_set_datasel(struct axi_dac *dac,
 int32_t axi_dac_dds_set_frequency(struct axi_dac *dac,
 				  uint32_t chan, uint32_t freq_hz)
 {
+	struct no_os_axi_io_op ops[3];
 	uint64_t val64;
-	uint32_t reg;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
 	val64 = (uint64_t) freq_hz * 0xFFFFULL;
 	val64 = val64 / dac->clock_hz;
-	reg = (reg & ~AXI_DAC_DDS_INCR(~0)) | AXI_DAC_DDS_INCR(val64) | 1;
-	axi_dac_write(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_SYNC_CONTROL, 0);
+	ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_UPDATE(
+			 AXI_DAC_REG_DDS_INIT_INCR(chan), AXI_DAC_DDS_INCR(~0),
+			 AXI_DAC_DDS_INCR(val64) | 1);
+	ops[2] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	return no_os_axi_io_batch(dac->base, ops, NO_OS_ARRAY_SIZE(ops));
 }
 
 /**
@@ -647,12 +649,19 @@ int32_t axi_dac_dds_set_frequency(struct axi_dac *dac,
 int32_t axi_dac_dds_get_frequency(struct axi_dac *dac,
 				  uint32_t chan, uint32_t *freq)
 {
+	struct no_os_axi_io_op ops[] = {
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_SYNC_CONTROL, 0),
+		NO_OS_AXI_IO_OP_READ(AXI_DAC_REG_DDS_INIT_INCR(chan)),
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC),
+	};
 	uint32_t reg;
 	uint64_t val64;
+	int32_t ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	ret = no_os_axi_io_batch(dac->base, ops, NO_OS_ARRAY_SIZE(ops));
+	if (ret)
+		return ret;
+	reg = ops[1].value;
 	reg = (reg & AXI_DAC_DDS_INCR(~0));
 	val64 = (uint64_t) reg * dac->clock_hz;
 	no_os_do_div(&val64, 0xFFFF);
@@ -672,18 +681,20 @@ int32_t axi_dac_dds_get_frequency(struct axi_dac *dac,
 int32_t axi_dac_dds_set_phase(struct axi_dac *dac,
 			      uint32_t chan, uint32_t phase)
 {
+	struct no_os_axi_io_op ops[3];
 	uint64_t val64;
-	uint32_t reg;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
 	val64 = (uint64_t) phase * 0x10000ULL + (360000 / 2);
 	val64 = val64 / 360000;
-	reg = (reg & ~AXI_DAC_DDS_INIT(~0)) | AXI_DAC_DDS_INIT(val64);
-	axi_dac_write(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_SYNC_CONTROL, 0);
+	ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_UPDATE(
+			 AXI_DAC_REG_DDS_INIT_INCR(chan), AXI_DAC_DDS_INIT(~0),
+			 AXI_DAC_DDS_INIT(val64));
+	ops[2] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	return no_os_axi_io_batch(dac->base, ops, NO_OS_ARRAY_SIZE(ops));
 }
 
 /**
@@ -697,12 +708,19 @@ int32_t axi_dac_dds_set_phase(struct axi_dac *dac,
 int32_t axi_dac_dds_get_phase(struct axi_dac *dac,
 			      uint32_t chan, uint32_t *phase)
 {
+	struct no_os_axi_io_op ops[] = {
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_SYNC_CONTROL, 0),
+		NO_OS_AXI_IO_OP_READ(AXI_DAC_REG_DDS_INIT_INCR(chan)),
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC),
+	};
 	uint64_t val64;
 	uint32_t reg;
+	int32_t ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	ret = no_os_axi_io_batch(dac->base, ops, NO_OS_ARRAY_SIZE(ops));
+	if (ret)
+		return ret;
+	reg = ops[1].value;
 	reg = (reg & AXI_DAC_DDS_INIT(~0));
 	reg = AXI_DAC_TO_DDS_INIT(reg);
 	val64 = reg * 360000ULL + (0x10000 / 2);
@@ -724,6 +742,7 @@ int32_t axi_dac_dds_set_scale(struct axi_dac *dac,
 			      uint32_t chan,
 			      int32_t scale_micro_units)
 {
+	struct no_os_axi_io_op ops[3];
 	uint32_t scale_reg;
 
 	scale_reg = scale_micro_units;
@@ -735,12 +754,13 @@ int32_t axi_dac_dds_set_scale(struct axi_dac *dac,
 	if (scale_micro_units < 0)
 		scale_reg = scale_reg | 0x8000;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_write(dac, AXI_DAC_REG_DDS_SCALE(chan),
-		      AXI_DAC_DDS_SCALE(scale_reg));
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
-
-	return 0;
+	ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_SYNC_CONTROL, 0);
+	ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_DDS_SCALE(chan), AXI_DAC_DDS_SCALE(scale_reg));
+	ops[2] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	return no_os_axi_io_batch(dac->base, ops, NO_OS_ARRAY_SIZE(ops));
 }
 
 /**
@@ -755,13 +775,19 @@ int32_t axi_dac_dds_get_scale(struct axi_dac *dac,
 			      uint32_t chan,
 			      int32_t *scale_micro_units)
 {
+	struct no_os_axi_io_op ops[] = {
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_SYNC_CONTROL, 0),
+		NO_OS_AXI_IO_OP_READ(AXI_DAC_REG_DDS_SCALE(chan)),
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC),
+	};
 	int32_t sign;
 	uint32_t scale_reg;
+	int32_t ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_SCALE(chan),
-		     &scale_reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	ret = no_os_axi_io_batch(dac->base, ops, NO_OS_ARRAY_SIZE(ops));
+	if (ret)
+		return ret;
+	scale_reg = ops[1].value;
 	scale_reg = AXI_DAC_TO_DDS_SCALE(scale_reg);
 	sign = (scale_reg & 0x8000) ? -1 : 1;
 	scale_reg &= ~0x8000;
@@ -1075,19 +1101,35 @@ int32_t axi_dac_load_custom_data(struct axi_dac *dac,
 				 uint32_t address)
 {
 	uint32_t index, index_mem = 0;
+	uint32_t buf[32];
+	uint32_t cnt = 0;
 	uint8_t chan;
 	uint8_t num_tx_channels = dac->num_channels / 2;
+	int32_t ret;
 
 	for (index = 0; index < custom_tx_count; index++) {
 		/* Send the same data on all the channels */
 		for (chan = 0; chan < num_tx_channels; chan++) {
-
-			no_os_axi_io_write(address, index_mem * sizeof(uint32_t),
-					   custom_data_iq[index]);
-
-			index_mem++;
+			buf[cnt++] = custom_data_iq[index];
+			if (cnt < NO_OS_ARRAY_SIZE(buf))
+				continue;
+
+			ret = no_os_axi_io_write_burst(address,
+						       index_mem * sizeof(uint32_t),
+						       buf, cnt);
+			if (ret)
+				return ret;
+			index_mem += cnt;
+			cnt = 0;
 		}
 	}
+	if (cnt) {
+		ret = no_os_axi_io_write_burst(address,
+					       index_mem * sizeof(uint32_t),
+					       buf, cnt);
+		if (ret)
+			return ret;
+	}
 
 	for (chan = 0; chan < dac->num_channels; chan++) {
 		axi_dac_write(dac, AXI_DAC_REG_DATA_SELECT((chan * 2) + 0), 0x2);
@@ -1132,8 +1174,8 @@ int32_t axi_dac_init_begin(struct axi_dac **dac_core,
 int32_t axi_dac_init_finish(struct axi_dac *dac)
 {
 	uint32_t reg_data;
-	uint32_t freq;
-	uint32_t ratio;
+	uint32_t clk[2];
+	int32_t ret;
 
 	axi_dac_read(dac, AXI_DAC_REG_STATUS, &reg_data);
 
@@ -1143,9 +1185,12 @@ int32_t axi_dac_init_finish(struct axi_dac *dac)
 		return -1;
 	}
 
-	axi_dac_read(dac, AXI_DAC_REG_CLK_FREQ, &freq);
-	axi_dac_read(dac, AXI_DAC_REG_CLK_RATIO, &ratio);
-	dac->clock_hz = freq * ratio;
+	/* CLK_FREQ and CLK_RATIO are consecutive registers. */
+	ret = no_os_axi_io_read_burst(dac->base, AXI_DAC_REG_CLK_FREQ, clk,
+				      NO_OS_ARRAY_SIZE(clk));
+	if (ret)
+		return ret;
+	dac->clock_hz = clk[0] * clk[1];
 	dac->clock_hz = (dac->clock_hz * 390625) >> 8;
 
 	printf("%s: Successfully initialized (%"PRIu64" Hz)\n",
@@ -1163,6 +1208,13 @@ int32_t axi_dac_init_finish(struct axi_dac *dac)
 int32_t axi_dac_init(struct axi_dac **dac_core,
 		     const struct axi_dac_init *init)
 {
+	struct no_os_axi_io_op rst_ops[] = {
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_RSTN, 0),
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_RSTN,
+				      AXI_DAC_MMCM_RSTN | AXI_DAC_RSTN),
+		NO_OS_AXI_IO_OP_WRITE(AXI_DAC_REG_RATECNTRL,
+				      AXI_DAC_RATE(init->rate)),
+	};
 	struct axi_dac *dac;
 	int32_t ret;
 
@@ -1170,11 +1222,9 @@ int32_t axi_dac_init(struct axi_dac **dac_core,
 	if (ret)
 		return ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_RSTN, 0);
-	axi_dac_write(dac, AXI_DAC_REG_RSTN,
-		      AXI_DAC_MMCM_RSTN | AXI_DAC_RSTN);
-
-	axi_dac_write(dac, AXI_DAC_REG_RATECNTRL, AXI_DAC_RATE(init->rate));
+	ret = no_os_axi_io_batch(dac->base, rst_ops, NO_OS_ARRAY_SIZE(rst_ops));
+	if (ret)
+		goto error;
 
 	no_os_mdelay(100);
 
@@ -41,6 +41,353 @@
 #include "no_os_alloc.h"
 #include "axi_dmac.h"
 
+/*******************************************************************************
+ * @brief Program the next burst and submit it to the DMAC in a single register
+ *			batch. The addresses are taken from the next_src_addr and
+ *			next_dest_addr fields, depending on the transfer direction.
+ *
+ * @param dmac - DMAC istance.
+ * @param burst_size - Burst length minus one, as written to X_LENGTH.
+ *
+ * @return 0 for success, negative error code otherwise.
+*******************************************************************************/
+static int32_t axi_dmac_submit_burst(struct axi_dmac *dmac, uint32_t burst_size)
+{
+	struct no_os_axi_io_op ops[7];
+	uint32_t n = 0;
+
+	if (dmac->direction == DMA_DEV_TO_MEM || dmac->direction == DMA_MEM_TO_MEM) {
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_DEST_STRIDE, 0x0);
+	}
+	if (dmac->direction == DMA_MEM_TO_DEV || dmac->direction == DMA_MEM_TO_MEM) {
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_SRC_STRIDE, 0x0);
+	}
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_X_LENGTH, burst_size);
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_Y_LENGTH, 0x0);
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
+
+	return no_os_axi_io_batch(dmac->base, ops, n);
+}
+
+/*******************************************************************************
+ * @brief Program a transfer of the queue and submit it to the DMAC in a single
+ *			register batch.
+ *
+ * @param dmac - DMAC istance.
+ * @param burst - Addresses, lengths and strides of the transfer.
+ * @param flags - Value of the FLAGS register.
+ *
+ * @return 0 for success, negative error code otherwise.
+*******************************************************************************/
+static int32_t axi_dmac_submit_segment(struct axi_dmac *dmac,
+				       const struct axi_dmac_segment *burst,
+				       uint32_t flags)
+{
+	struct no_os_axi_io_op ops[8];
+	uint32_t n = 0;
+
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_FLAGS, flags);
+	if (dmac->direction == DMA_DEV_TO_MEM || dmac->direction == DMA_MEM_TO_MEM) {
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_DEST_ADDRESS, burst->dest_addr);
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_DEST_STRIDE, burst->dest_stride);
+	}
+	if (dmac->direction == DMA_MEM_TO_DEV || dmac->direction == DMA_MEM_TO_MEM) {
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_SRC_ADDRESS, burst->src_addr);
+		ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				   AXI_DMAC_REG_SRC_STRIDE, burst->src_stride);
+	}
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_X_LENGTH, burst->x_len - 1);
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_Y_LENGTH, burst->y_len - 1);
+	ops[n++] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			   AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
+
+	return no_os_axi_io_batch(dmac->base, ops, n);
+}
+
+/*******************************************************************************
+ * @brief Submit the scatter-gather chain of a descriptor as a single transfer.
+ *
+ * @param dmac - DMAC istance.
+ * @param desc - Descriptor prepared with axi_dmac_prep_segments().
+ *
+ * @return 0 for success, negative error code otherwise.
+*******************************************************************************/
+static int32_t axi_dmac_submit_chain(struct axi_dmac *dmac,
+				     struct axi_dmac_desc *desc)
+{
+	struct no_os_axi_io_op ops[4];
+
+	ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DMAC_REG_FLAGS, DMA_LAST);
+	ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DMAC_REG_SG_ADDRESS,
+			 (uint32_t)desc->hw_descs_phys);
+	ops[2] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DMAC_REG_SG_ADDRESS_HIGH,
+			 (uint32_t)(desc->hw_descs_phys >> 32));
+	ops[3] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+			 AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
+
+	return no_os_axi_io_batch(dmac->base, ops, 4);
+}
+
+/*******************************************************************************
+ * @brief Get the next hardware transfer of a descriptor and advance its
+ *			position. A segment is transferred at once if the core
+ *			supports 2D transfers and a row fits in a burst, otherwise
+ *			its rows are split in bursts of at most max_length + 1 bytes.
+ *
+ * @param dmac - DMAC istance.
+ * @param desc - Descriptor being submitted.
+ * @param burst - Filled with the transfer to submit.
+ *
+ * @return true if burst is the last transfer of desc.
+*******************************************************************************/
+static bool axi_dmac_next_burst(struct axi_dmac *dmac,
+				struct axi_dmac_desc *desc,
+				struct axi_dmac_segment *burst)
+{
+	struct axi_dmac_segment whole = {
+		.src_addr = desc->src_addr,
+		.dest_addr = desc->dest_addr,
+		.x_len = desc->size,
+	};
+	const struct axi_dmac_segment *seg = &whole;
+	uint32_t nb_segments = 1;
+	uint32_t rows;
+
+	if (desc->segments) {
+		seg = &desc->segments[desc->seg];
+		nb_segments = desc->nb_segments;
+	}
+	rows = no_os_max(seg->y_len, 1);
+
+	if (dmac->hw_2d && rows > 1 && !desc->row && !desc->offset &&
+	    seg->x_len - 1 <= dmac->max_length) {
+		*burst = *seg;
+		desc->row = rows;
+	} else {
+		burst->src_addr = seg->src_addr + desc->row * seg->src_stride +
+				  desc->offset;
+		burst->dest_addr = seg->dest_addr + desc->row * seg->dest_stride +
+				   desc->offset;
+		burst->x_len = no_os_min(seg->x_len - desc->offset,
+					 dmac->max_length + 1);
+		burst->y_len = 1;
+		burst->src_stride = 0;
+		burst->dest_stride = 0;
+
+		desc->offset += burst->x_len;
+		if (desc->offset == seg->x_len) {
+			desc->offset = 0;
+			desc->row++;
+		}
+	}
+
+	if (desc->row == rows) {
+		desc->row = 0;
+		desc->seg++;
+	}
+
+	return desc->seg == nb_segments;
+}
+
+/*******************************************************************************
+ * @brief Check the addresses, or the strides, against the data path widths.
+ *
+ * @param dmac - DMAC istance.
+ * @param src - Source address, ignored for DMA_DEV_TO_MEM.
+ * @param dest - Destination address, ignored for DMA_MEM_TO_DEV.
+ *
+ * @return true if both are aligned.
+*******************************************************************************/
+static inline bool axi_dmac_aligned(struct axi_dmac *dmac, uint32_t src,
+				    uint32_t dest)
+{
+	return (dmac->direction == DMA_MEM_TO_DEV ||
+		!(dest % (dmac->width_dst / 8))) &&
+	       (dmac->direction == DMA_DEV_TO_MEM ||
+		!(src % (dmac->width_src / 8)));
+}
+
+/*******************************************************************************
+ * @brief Check if descriptors queued with axi_dmac_queue_transfer() are not
+ *			done yet.
+ *
+ * @param dmac - DMAC istance.
+ *
+ * @return true if the queue is in use.
+*******************************************************************************/
+static inline bool axi_dmac_queue_busy(struct axi_dmac *dmac)
+{
+	return dmac->nb_inflight || dmac->pending_first;
+}
+
+/*******************************************************************************
+ * @brief Mask or unmask the DMAC interrupts, to update the queue from thread
+ *			context without racing with the ISR. The interrupt sources
+ *			are latched while masked.
+ *
+ * @param dmac - DMAC istance.
+ * @param mask - true to mask the interrupts.
+*******************************************************************************/
+static inline void axi_dmac_queue_lock(struct axi_dmac *dmac, bool mask)
+{
+	if (mask && dmac->irq_option == IRQ_ENABLED)
+		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+			       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	else if (!mask)
+		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+}
+
+/*******************************************************************************
+ * @brief Submit bursts of the queued descriptors until the hardware queue is
+ *			full or no descriptor is left.
+ *
+ * @param dmac - DMAC istance.
+ *
+ * @return 0 for success, negative error code otherwise. The burst that failed
+ *			stays queued.
+*******************************************************************************/
+static int32_t axi_dmac_queue_submit(struct axi_dmac *dmac)
+{
+	struct no_os_axi_io_op ops[2];
+	struct axi_dmac_segment next;
+	struct axi_dmac_burst *burst;
+	struct axi_dmac_desc *desc;
+	uint32_t i, seg, row, offset;
+	int32_t ret;
+
+	while (dmac->pending_first &&
+	       dmac->nb_inflight < AXI_DMAC_QUEUE_DEPTH) {
+		ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_READ(
+				 AXI_DMAC_REG_TRANSFER_SUBMIT);
+		ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_READ(
+				 AXI_DMAC_REG_TRANSFER_ID);
+		ret = no_os_axi_io_batch(dmac->base, ops, 2);
+		if (ret)
+			return ret;
+		if (ops[0].value & AXI_DMAC_QUEUE_FULL)
+			break;
+
+		desc = dmac->pending_first;
+		i = (dmac->inflight_first + dmac->nb_inflight) %
+		    AXI_DMAC_QUEUE_DEPTH;
+		burst = &dmac->inflight[i];
+		burst->desc = desc;
+		burst->id = ops[1].value;
+
+		if (desc->hw_descs) {
+			/* The whole chain completes under a single ID */
+			burst->last = true;
+			ret = axi_dmac_submit_chain(dmac, desc);
+		} else {
+			seg = desc->seg;
+			row = desc->row;
+			offset = desc->offset;
+			burst->last = axi_dmac_next_burst(dmac, desc, &next);
+			ret = axi_dmac_submit_segment(dmac, &next,
+						      burst->last ? DMA_LAST : 0);
+			if (ret) {
+				desc->seg = seg;
+				desc->row = row;
+				desc->offset = offset;
+			}
+		}
+		if (ret)
+			return ret;
+
+		dmac->nb_inflight++;
+		if (burst->last)
+			dmac->pending_first = desc->next;
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+ * @brief Retire the bursts the hardware completed, in submission order, and
+ *			call the callback of the descriptors done.
+ *
+ * @param dmac - DMAC istance.
+ *
+ * @return Number of descriptors done.
+*******************************************************************************/
+static int32_t axi_dmac_queue_complete(struct axi_dmac *dmac)
+{
+	struct axi_dmac_burst *burst;
+	struct axi_dmac_desc *desc;
+	uint32_t done_ids, nb_checked;
+	int32_t nb = 0;
+
+	/*
+	 * Only the bursts in flight when TRANSFER_DONE is read can be retired.
+	 * The ones submitted by a callback below reuse IDs whose done bit is
+	 * still set in done_ids.
+	 */
+	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &done_ids);
+	for (nb_checked = dmac->nb_inflight; nb_checked; nb_checked--) {
+		burst = &dmac->inflight[dmac->inflight_first];
+		if (!(done_ids & NO_OS_BIT(burst->id)))
+			break;
+
+		/* Retire the burst first, the callback may queue desc again */
+		dmac->inflight_first = (dmac->inflight_first + 1) %
+				       AXI_DMAC_QUEUE_DEPTH;
+		dmac->nb_inflight--;
+		if (!burst->last)
+			continue;
+
+		desc = burst->desc;
+		desc->done = true;
+		nb++;
+		if (desc->callback)
+			desc->callback(desc, desc->ctx);
+	}
+
+	return nb;
+}
+
+/*******************************************************************************
+ * @brief Handle the DMAC interrupt sources for the queued descriptors.
+ *
+ * @param dmac - DMAC istance.
+ * @param irq_pending - Interrupt sources, already cleared.
+ *
+ * @return Number of descriptors done, negative error code if the next bursts
+ *			could not be submitted.
+*******************************************************************************/
+static int32_t axi_dmac_queue_irq(struct axi_dmac *dmac, uint32_t irq_pending)
+{
+	int32_t nb = 0;
+	int32_t ret;
+
+	if (irq_pending & AXI_DMAC_IRQ_EOT)
+		nb = axi_dmac_queue_complete(dmac);
+
+	/* Room in the hardware queue on SOT, maybe on EOT too */
+	ret = axi_dmac_queue_submit(dmac);
+	if (ret)
+		return ret;
+
+	return nb;
+}
+
 /*******************************************************************************
  * @brief ISR for dev to mem DMA transfer. It computes the next transfer params,
  *			if any, and sets the transfer structure fields accordingly.
@@ -57,6 +404,11 @@ void axi_dmac_dev_to_mem_isr(void *instance)
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
+	if (axi_dmac_queue_busy(dmac)) {
+		axi_dmac_queue_irq(dmac, reg_val);
+		return;
+	}
+
 	if (reg_val & AXI_DMAC_IRQ_SOT) {
 		if (dmac->remaining_size) {
 			/* See if remaining size is bigger than max transfer size and
@@ -67,19 +419,13 @@ void axi_dmac_dev_to_mem_isr(void *instance)
 				burst_size = dmac->remaining_size - 1;
 			}
 
-			/* The current transfer was started; set up the new one. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-			axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+			/* The current transfer was started; set up and trigger the new one. */
+			axi_dmac_submit_burst(dmac, burst_size);
 
 			/* Compute size of the next transfer. */
 			dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
 			/* Address must advance with +1 since the DMAC writes X_LENGTH+1. */
 			dmac->next_dest_addr = dmac->next_dest_addr + (burst_size + 1);
-
-			/* Trigger the next transfer. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
 		}
 	}
 	if (reg_val & AXI_DMAC_IRQ_EOT) {
@@ -106,6 +452,11 @@ void axi_dmac_mem_to_dev_isr(void *instance)
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
+	if (axi_dmac_queue_busy(dmac)) {
+		axi_dmac_queue_irq(dmac, reg_val);
+		return;
+	}
+
 	if (reg_val & AXI_DMAC_IRQ_SOT) {
 		if ((dmac->transfer.cyclic == CYCLIC) &&
 		    (dmac->next_src_addr >= (dmac->init_addr + dmac->transfer.size - 1))) {
@@ -122,19 +473,13 @@ void axi_dmac_mem_to_dev_isr(void *instance)
 				burst_size = dmac->remaining_size - 1;
 			}
 
-			/* The current transfer was started; set up the new one. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-			axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+			/* The current transfer was started; set up and trigger the new one. */
+			axi_dmac_submit_burst(dmac, burst_size);
 
 			/* Compute parameters for the next transfer. */
 			dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
 			/* Address must advance with +1 since the DMAC writes X_LENGTH+1. */
 			dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
-
-			/* Trigger the current transfer */
-			axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
 		}
 	}
 	if (reg_val & AXI_DMAC_IRQ_EOT) {
@@ -161,6 +506,11 @@ void axi_dmac_mem_to_mem_isr(void *instance)
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
+	if (axi_dmac_queue_busy(dmac)) {
+		axi_dmac_queue_irq(dmac, reg_val);
+		return;
+	}
+
 	if (reg_val & AXI_DMAC_IRQ_SOT) {
 		if (dmac->remaining_size) {
 			/** See if remaining size is bigger than max transfer size and
@@ -171,13 +521,8 @@ void axi_dmac_mem_to_mem_isr(void *instance)
 				burst_size = dmac->remaining_size - 1;
 			}
 
-			/* The current transfer was started; set up the new one. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-			axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+			/* The current transfer was started; set up and trigger the new one. */
+			axi_dmac_submit_burst(dmac, burst_size);
 
 			/* Compute parameters for the next transfer. */
 			dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
@@ -189,9 +534,6 @@ void axi_dmac_mem_to_mem_isr(void *instance)
 			if (!dmac->remaining_size) {
 				dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
 			}
-
-			/* Trigger the current transfer */
-			axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
 		}
 	}
 	if (reg_val & AXI_DMAC_IRQ_EOT) {
@@ -286,6 +628,15 @@ static int32_t axi_dmac_detect_caps(struct axi_dmac *dmac)
 	/* Restore initial value for AXI_DMAC_REG_FLAGS register */
 	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, initial_reg_val);
 
+	/* Check for 2D transfers and scatter-gather descriptors */
+	axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0xffffffff);
+	axi_dmac_read(dmac, AXI_DMAC_REG_Y_LENGTH, &reg_val);
+	dmac->hw_2d = reg_val != 0;
+	axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+	axi_dmac_write(dmac, AXI_DMAC_REG_SG_ADDRESS, 0xffffffff);
+	axi_dmac_read(dmac, AXI_DMAC_REG_SG_ADDRESS, &reg_val);
+	dmac->hw_sg = reg_val != 0;
+
 	/* Get maximum burst size and set value. */
 	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, dmac->max_length);
 	axi_dmac_read(dmac, AXI_DMAC_REG_X_LENGTH, &dmac->max_length);
@@ -334,6 +685,7 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 	dmac->name = init->name;
 	dmac->base = init->base;
 	dmac->irq_option = init->irq_option;
+	dmac->dcache_flush_range = init->dcache_flush_range;
 
 	int32_t status = axi_dmac_detect_caps(dmac);
 	if (status < 0)
@@ -376,7 +728,10 @@ int32_t axi_dmac_remove(struct axi_dmac *dmac)
 int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 				struct axi_dma_transfer *dma_transfer)
 {
+	struct no_os_axi_io_op setup_ops[3];
 	uint32_t reg_val, burst_size;
+	uint32_t flags;
+	int32_t ret;
 
 	if (dma_transfer->size == 0)
 		return 0; /* Nothing to do. */
@@ -407,26 +762,35 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 		}
 	}
 
-	/* Clear the DMA_CYCLIC flag for all transfers */
-	axi_dmac_read(dmac, AXI_DMAC_REG_FLAGS, &reg_val);
-	reg_val = reg_val & ~DMA_CYCLIC;
-	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, reg_val);
-
-	/* Cyclic transfers set to HW for MEM to DEV if smaller than maximum transfer size
-	 * and DMA has this feature. */
+	/* Clear the DMA_CYCLIC flag for all transfers. Cyclic transfers are set
+	 * to HW for MEM to DEV if smaller than maximum transfer size and DMA has
+	 * this feature. */
+	flags = 0;
 	if ((dmac->direction == DMA_MEM_TO_DEV) && (dmac->transfer.cyclic == CYCLIC)
-	    && ((dmac->remaining_size - 1) <= dmac->max_length) && (dmac->hw_cyclic)) {
-		axi_dmac_read(dmac, AXI_DMAC_REG_FLAGS, &reg_val);
-		reg_val = reg_val | DMA_CYCLIC;
-		axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, reg_val);
-	}
+	    && ((dmac->remaining_size - 1) <= dmac->max_length) && (dmac->hw_cyclic))
+		flags = DMA_CYCLIC;
 
-	/* Enable DMA if not already enabled. */
-	axi_dmac_read(dmac, AXI_DMAC_REG_CTRL, &reg_val);
-	if (!(reg_val & AXI_DMAC_CTRL_ENABLE)) {
-		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
-		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
-		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+	setup_ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_UPDATE(
+			       AXI_DMAC_REG_FLAGS, DMA_CYCLIC, flags);
+	setup_ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_READ(
+			       AXI_DMAC_REG_CTRL);
+	ret = no_os_axi_io_batch(dmac->base, setup_ops, 2);
+	if (ret)
+		return ret;
+
+	/* Enable DMA if not already enabled, without descriptor fetching. */
+	if ((setup_ops[1].value & (AXI_DMAC_CTRL_ENABLE |
+				   AXI_DMAC_CTRL_ENABLE_SG)) !=
+	    AXI_DMAC_CTRL_ENABLE) {
+		setup_ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				       AXI_DMAC_REG_CTRL, 0x0);
+		setup_ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				       AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
+		setup_ops[2] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				       AXI_DMAC_REG_IRQ_MASK, 0x0);
+		ret = no_os_axi_io_batch(dmac->base, setup_ops, 3);
+		if (ret)
+			return ret;
 	}
 
 	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, &reg_val);
@@ -436,8 +800,6 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 		switch (dmac->direction) {
 		case DMA_DEV_TO_MEM:
 			dmac->init_addr = dmac->next_dest_addr;
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
 			if (dmac->transfer.dest_addr % (dmac->width_dst / 8)) {
 				printf("Destination address should be aligned with destination data path width.\n\n");
 				return -1;
@@ -445,8 +807,6 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 			break;
 		case DMA_MEM_TO_DEV:
 			dmac->init_addr = dmac->next_src_addr;
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
 			if (dmac->transfer.src_addr % (dmac->width_src / 8)) {
 				printf("Source address should be aligned with source data path width.\n");
 				return -1;
@@ -454,10 +814,6 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 			break;
 		case DMA_MEM_TO_MEM:
 			dmac->init_addr = dmac->next_src_addr;
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
 			if ((dmac->transfer.dest_addr % (dmac->width_dst / 8))
 			    || (dmac->transfer.src_addr % (dmac->width_src / 8))) {
 				printf("Source and destination addresses should be aligned with data path widths.\n");
@@ -475,6 +831,11 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 			burst_size = dmac->remaining_size - 1;
 		}
 
+		/* Specify the addresses and length of the transfer and trigger it. */
+		ret = axi_dmac_submit_burst(dmac, burst_size);
+		if (ret)
+			return ret;
+
 		/* Compute next address (src or dest, or both, depending on type of transfer). */
 		switch (dmac->direction) {
 		case DMA_DEV_TO_MEM:
@@ -493,11 +854,6 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 
 		/* Compute remaining size. */
 		dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
-
-		/* Specify the length of the transfer and trigger transfer. */
-		axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-		axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
-		axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
 	} else {
 		return -1;
 	}
@@ -505,6 +861,64 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 	return 0;
 }
 
+/*******************************************************************************
+ * @brief Sleep us microseconds and update the time left to wait.
+ *
+ * Short no_os_udelay() calls usually sleep much longer than asked (a system
+ * call on Linux), so the time left is updated with no_os_get_time().
+ * Platforms without a time source return a constant time, us is counted per
+ * sleep there.
+ *
+ * @param us - Time to sleep, in us.
+ * @param timeout_us - Time left to wait, in us. Updated after the sleep.
+*******************************************************************************/
+static void axi_dmac_sleep(uint32_t us, uint32_t *timeout_us)
+{
+	struct no_os_time start, end;
+	uint64_t elapsed;
+
+	start = no_os_get_time();
+	no_os_udelay(us);
+	end = no_os_get_time();
+
+	elapsed = (uint64_t)(end.s - start.s) * 1000000 + end.us - start.us;
+	if (!elapsed)
+		elapsed = us;
+	if (elapsed >= *timeout_us)
+		*timeout_us = 0;
+	else
+		*timeout_us -= elapsed;
+}
+
+/*******************************************************************************
+ * @brief Sleep until the DMAC raises an interrupt, with IRQ_DISABLED. Where the
+ *			platform can't wait for it (no UIO interrupt), sleep 1 us.
+ *
+ * @param dmac - DMAC istance.
+ * @param timeout_us - Maximum time to wait, in us. Updated with the time left.
+*******************************************************************************/
+static void axi_dmac_wait_irq(struct axi_dmac *dmac, uint32_t *timeout_us)
+{
+	int32_t ret;
+
+	if (dmac->irq_option == IRQ_DISABLED) {
+		ret = no_os_axi_io_wait_irq(dmac->base, timeout_us);
+		if (!ret || ret == -ETIMEDOUT)
+			return;
+	}
+
+	axi_dmac_sleep(1, timeout_us);
+}
+
+/* Convert a timeout in ms to us, saturating instead of wrapping around */
+static uint32_t axi_dmac_ms_to_us(uint32_t timeout_ms)
+{
+	if (timeout_ms > UINT32_MAX / 1000)
+		return UINT32_MAX;
+
+	return timeout_ms * 1000;
+}
+
 /*******************************************************************************
  * @brief Wait for DMA transfer to be completed.
  *
@@ -516,30 +930,37 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
 		uint32_t timeout_ms)
 {
-	uint32_t timeout = 0;
+	uint32_t timeout_us;
 	uint32_t reg_val = 0;
+	uint32_t seen = 0;
 
 	if (dmac->irq_option == IRQ_ENABLED) {
+		/* Poll every 10 us, the transfer is usually done well before 1 ms */
+		timeout_us = axi_dmac_ms_to_us(timeout_ms);
 		while (!dmac->transfer.transfer_done) {
-			timeout++;
-			no_os_mdelay(1);
-			if (timeout == timeout_ms) {
+			if (!timeout_us) {
 				printf("Error transferring data using DMA.\n");
 				return -1;
 			}
+			axi_dmac_sleep(10, &timeout_us);
 		}
 	} else if (dmac->irq_option == IRQ_DISABLED) {
-		axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-		while (reg_val != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT)) {
-			timeout++;
-			no_os_mdelay(1);
-			if (timeout == timeout_ms) {
+		/* Clear the sources once seen, a pending one would keep waking
+		 * up axi_dmac_wait_irq() */
+		timeout_us = axi_dmac_ms_to_us(timeout_ms);
+		while (1) {
+			axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+			if (reg_val)
+				axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+			seen |= reg_val;
+			if (seen == (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+				break;
+			if (!timeout_us) {
 				printf("Error transferring data using DMA.\n");
 				return -1;
 			}
-			axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+			axi_dmac_wait_irq(dmac, &timeout_us);
 		}
-		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 	}
 
 	return 0;
@@ -554,4 +975,319 @@ int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
 void axi_dmac_transfer_stop(struct axi_dmac *dmac)
 {
 	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_DISABLE);
+
+	/* Disabling the DMAC drops its queue, queued descriptors are not done */
+	dmac->pending_first = NULL;
+	dmac->inflight_first = 0;
+	dmac->nb_inflight = 0;
+}
+
+/*******************************************************************************
+ * @brief Queue a transfer. Up to AXI_DMAC_QUEUE_DEPTH bursts are kept
+ *			submitted to the hardware, so that consecutive descriptors are
+ *			transferred without gaps. Completion is reported through
+ *			desc->done and desc->callback, from the DMAC ISR with
+ *			IRQ_ENABLED or from axi_dmac_poll() with IRQ_DISABLED.
+ *
+ * @note Cyclic transfers are not supported, queue the descriptor again from
+ *			its callback instead. Do not mix with axi_dmac_transfer_start().
+ *			Descriptors with and without a scatter-gather chain can't be
+ *			queued at the same time, the core is switched when idle.
+ *
+ * @param dmac - DMAC istance.
+ * @param desc - Transfer descriptor, valid until done.
+ *
+ * @return 0 for success, -EBUSY if the queue holds descriptors of the other
+ *			kind, negative error code otherwise. If the bursts could
+ *			not be submitted the queue is dropped, as with
+ *			axi_dmac_transfer_stop().
+*******************************************************************************/
+int32_t axi_dmac_queue_transfer(struct axi_dmac *dmac,
+				struct axi_dmac_desc *desc)
+{
+	struct no_os_axi_io_op ops[2];
+	uint32_t reg_val, ctrl;
+	int32_t ret;
+
+	if (!dmac || !desc || !desc->size)
+		return -EINVAL;
+
+	/* Segments are checked by axi_dmac_prep_segments() */
+	if (!desc->segments &&
+	    !axi_dmac_aligned(dmac, desc->src_addr, desc->dest_addr))
+		return -EINVAL;
+
+	desc->done = false;
+	desc->seg = 0;
+	desc->row = 0;
+	desc->offset = 0;
+
+	/*
+	 * With ENABLE_SG the core fetches every submitted transfer from
+	 * SG_ADDRESS, so chains and register transfers can't share the queue.
+	 */
+	ctrl = AXI_DMAC_CTRL_ENABLE;
+	if (desc->hw_descs)
+		ctrl |= AXI_DMAC_CTRL_ENABLE_SG;
+
+	axi_dmac_queue_lock(dmac, true);
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_CTRL, &reg_val);
+	if ((reg_val & (AXI_DMAC_CTRL_ENABLE | AXI_DMAC_CTRL_ENABLE_SG)) !=
+	    ctrl) {
+		if (axi_dmac_queue_busy(dmac)) {
+			axi_dmac_queue_lock(dmac, false);
+			return -EBUSY;
+		}
+
+		ops[0] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				 AXI_DMAC_REG_CTRL, 0x0);
+		ops[1] = (struct no_os_axi_io_op)NO_OS_AXI_IO_OP_WRITE(
+				 AXI_DMAC_REG_CTRL, ctrl);
+		ret = no_os_axi_io_batch(dmac->base, ops, 2);
+		if (ret) {
+			axi_dmac_queue_lock(dmac, false);
+			return ret;
+		}
+	}
+
+	desc->next = NULL;
+	if (dmac->pending_first)
+		dmac->pending_last->next = desc;
+	else
+		dmac->pending_first = desc;
+	dmac->pending_last = desc;
+	ret = axi_dmac_queue_submit(dmac);
+	if (ret)
+		axi_dmac_transfer_stop(dmac);
+
+	axi_dmac_queue_lock(dmac, false);
+
+	return ret;
+}
+
+/*******************************************************************************
+ * @brief Get the number of scatter-gather descriptors needed by a list of
+ *			segments. Segments longer than the maximum burst length or
+ *			with more than one row on cores without 2D support take
+ *			more than one.
+ *
+ * @param dmac - DMAC istance.
+ * @param segments - Segments to transfer, in order.
+ * @param nb_segments - Number of segments.
+ *
+ * @return Number of descriptors, 0 if the parameters are invalid.
+*******************************************************************************/
+uint32_t axi_dmac_sg_nb_descs(struct axi_dmac *dmac,
+			      const struct axi_dmac_segment *segments,
+			      uint32_t nb_segments)
+{
+	struct axi_dmac_desc desc = {
+		.segments = segments,
+		.nb_segments = nb_segments,
+	};
+	struct axi_dmac_segment burst;
+	uint32_t i, nb = 0;
+
+	if (!dmac || !segments || !nb_segments)
+		return 0;
+
+	for (i = 0; i < nb_segments; i++)
+		if (!segments[i].x_len)
+			return 0;
+
+	do {
+		nb++;
+	} while (!axi_dmac_next_burst(dmac, &desc, &burst));
+
+	return nb;
+}
+
+/*******************************************************************************
+ * @brief Set the segments of a descriptor, transferred back to back by
+ *			axi_dmac_queue_transfer() and completed together. With
+ *			sg_mem, on cores with scatter-gather support, the segments
+ *			are written to a chain of hardware descriptors, submitted as
+ *			one transfer. Otherwise each segment is submitted as one 2D
+ *			transfer, or row by row if the core has no 2D support.
+ *
+ * @note Call from thread context, not while desc is queued. The segments and
+ *			sg_mem must stay valid until axi_dmac_free_segments().
+ *
+ * @param dmac - DMAC istance.
+ * @param desc - Descriptor to prepare. Its size is set to the total length.
+ * @param segments - Segments to transfer, in order.
+ * @param nb_segments - Number of segments.
+ * @param sg_mem - Memory for the scatter-gather descriptors, NULL to submit
+ *			the segments from the registers.
+ *
+ * @return 0 for success, -ENOSPC if sg_mem is too small, negative error code
+ *			otherwise.
+*******************************************************************************/
+int32_t axi_dmac_prep_segments(struct axi_dmac *dmac,
+			       struct axi_dmac_desc *desc,
+			       const struct axi_dmac_segment *segments,
+			       uint32_t nb_segments,
+			       const struct axi_dmac_sg_mem *sg_mem)
+{
+	const struct axi_dmac_segment *seg;
+	struct axi_dmac_segment burst;
+	struct axi_dmac_hw_desc *hw;
+	uint32_t i, nb_hw = 0, size = 0;
+
+	if (!dmac || !desc || !segments || !nb_segments)
+		return -EINVAL;
+
+	for (i = 0; i < nb_segments; i++) {
+		seg = &segments[i];
+		if (!seg->x_len ||
+		    !axi_dmac_aligned(dmac, seg->src_addr, seg->dest_addr))
+			return -EINVAL;
+		if (seg->y_len > 1 &&
+		    !axi_dmac_aligned(dmac, seg->src_stride, seg->dest_stride))
+			return -EINVAL;
+		size += seg->x_len * no_os_max(seg->y_len, 1);
+	}
+
+	if (sg_mem && dmac->hw_sg) {
+		if (!sg_mem->virt || sg_mem->phys % AXI_DMAC_HW_DESC_ALIGN)
+			return -EINVAL;
+
+		nb_hw = axi_dmac_sg_nb_descs(dmac, segments, nb_segments);
+		if (nb_hw > sg_mem->nb_descs)
+			return -ENOSPC;
+	}
+
+	axi_dmac_free_segments(desc);
+	desc->segments = segments;
+	desc->nb_segments = nb_segments;
+	desc->size = size;
+	if (!sg_mem || !dmac->hw_sg)
+		return 0;
+
+	hw = sg_mem->virt;
+	desc->seg = 0;
+	desc->row = 0;
+	desc->offset = 0;
+	for (i = 0; i < nb_hw; i++) {
+		axi_dmac_next_burst(dmac, desc, &burst);
+		hw[i].flags = 0;
+		hw[i].id = 0;
+		hw[i].dest_addr = burst.dest_addr;
+		hw[i].src_addr = burst.src_addr;
+		hw[i].next_sg_addr = sg_mem->phys + (i + 1) * sizeof(*hw);
+		hw[i].x_len = burst.x_len - 1;
+		hw[i].y_len = no_os_max(burst.y_len, 1) - 1;
+		hw[i].src_stride = burst.src_stride;
+		hw[i].dest_stride = burst.dest_stride;
+	}
+	hw[nb_hw - 1].flags = AXI_DMAC_HW_FLAG_LAST | AXI_DMAC_HW_FLAG_IRQ;
+	hw[nb_hw - 1].next_sg_addr = 0;
+
+	if (dmac->dcache_flush_range)
+		dmac->dcache_flush_range((uintptr_t)hw, nb_hw * sizeof(*hw));
+	desc->hw_descs = hw;
+	desc->hw_descs_phys = sg_mem->phys;
+
+	return 0;
+}
+
+/*******************************************************************************
+ * @brief Drop the segments of a descriptor. Its scatter-gather memory can be
+ *			reused afterwards.
+ *
+ * @param desc - Descriptor prepared with axi_dmac_prep_segments(), not queued.
+*******************************************************************************/
+void axi_dmac_free_segments(struct axi_dmac_desc *desc)
+{
+	if (!desc)
+		return;
+
+	desc->hw_descs = NULL;
+	desc->hw_descs_phys = 0;
+	desc->segments = NULL;
+	desc->nb_segments = 0;
+}
+
+/*******************************************************************************
+ * @brief Process the DMAC events without interrupts: submit the queued
+ *			descriptors and complete the finished ones. Does not wait.
+ *
+ * @note With IRQ_ENABLED the ISR does this and nothing is done here.
+ *
+ * @param dmac - DMAC istance.
+ *
+ * @return Number of descriptors done, negative error code otherwise.
+*******************************************************************************/
+int32_t axi_dmac_poll(struct axi_dmac *dmac)
+{
+	uint32_t reg_val;
+
+	if (!dmac)
+		return -EINVAL;
+
+	if (dmac->irq_option == IRQ_ENABLED)
+		return 0;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	if (!reg_val)
+		return 0;
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+
+	return axi_dmac_queue_irq(dmac, reg_val);
+}
+
+/*******************************************************************************
+ * @brief Wait for the next DMAC event and process it. With IRQ_DISABLED the
+ *			caller sleeps until the DMAC raises an interrupt, through UIO
+ *			on Linux, then the descriptors done are completed as with
+ *			axi_dmac_poll(). Other platforms poll every 1 us. With
+ *			IRQ_ENABLED the ISR completes the descriptors, this only
+ *			sleeps 1 us.
+ *
+ * @param dmac - DMAC istance.
+ * @param timeout_us - Maximum time to wait, in us. Updated with the time left.
+ *
+ * @return Number of descriptors done, -ETIMEDOUT if no time was left.
+*******************************************************************************/
+int32_t axi_dmac_wait_event(struct axi_dmac *dmac, uint32_t *timeout_us)
+{
+	if (!dmac || !timeout_us)
+		return -EINVAL;
+
+	if (!*timeout_us)
+		return -ETIMEDOUT;
+
+	axi_dmac_wait_irq(dmac, timeout_us);
+
+	return axi_dmac_poll(dmac);
+}
+
+/*******************************************************************************
+ * @brief Wait for a queued descriptor to be done, sleeping on the DMAC events
+ *			with IRQ_DISABLED.
+ *
+ * @param dmac - DMAC istance.
+ * @param desc - Descriptor queued with axi_dmac_queue_transfer().
+ * @param timeout_us - Maximum time to wait, in us.
+ *
+ * @return 0 for success, -ETIMEDOUT if desc is not done in time, negative
+ *			error code if the DMAC could not be polled.
+*******************************************************************************/
+int32_t axi_dmac_wait(struct axi_dmac *dmac, struct axi_dmac_desc *desc,
+		      uint32_t timeout_us)
+{
+	int32_t ret;
+
+	if (!dmac || !desc)
+		return -EINVAL;
+
+	ret = axi_dmac_poll(dmac);
+	while (!desc->done) {
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		ret = axi_dmac_wait_event(dmac, &timeout_us);
+	}
+
+	return 0;
 }
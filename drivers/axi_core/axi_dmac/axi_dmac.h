@@ -52,6 +52,7 @@
 #define AXI_DMAC_CTRL_ENABLE		NO_OS_BIT(0)
 #define AXI_DMAC_CTRL_DISABLE		0u
 #define AXI_DMAC_CTRL_PAUSE			NO_OS_BIT(1)
+#define AXI_DMAC_CTRL_ENABLE_SG		NO_OS_BIT(2)
 
 #define AXI_DMAC_REG_TRANSFER_ID		0x404
 #define AXI_DMAC_REG_TRANSFER_SUBMIT	0x408
@@ -65,6 +66,17 @@
 #define AXI_DMAC_REG_DEST_STRIDE		0x420
 #define AXI_DMAC_REG_SRC_STRIDE			0x424
 #define AXI_DMAC_REG_TRANSFER_DONE		0x428
+#define AXI_DMAC_REG_SG_ADDRESS			0x47c
+#define AXI_DMAC_REG_SG_ADDRESS_HIGH	0x4bc
+
+/* Flags of the hardware scatter-gather descriptors */
+#define AXI_DMAC_HW_FLAG_LAST			NO_OS_BIT(0)
+#define AXI_DMAC_HW_FLAG_IRQ			NO_OS_BIT(1)
+/* Alignment of the scatter-gather descriptors in memory */
+#define AXI_DMAC_HW_DESC_ALIGN			64
+
+/* Number of transfer IDs, bounds the bursts queued in the hardware */
+#define AXI_DMAC_QUEUE_DEPTH			4
 
 enum use_irq {
 	IRQ_DISABLED = 0,
@@ -98,12 +110,117 @@ struct axi_dma_transfer {
 	uint32_t dest_addr;
 };
 
+/**
+ * @struct axi_dmac_segment
+ * @brief Part of a transfer: y_len rows of x_len bytes. The rows start
+ * src_stride and dest_stride bytes apart.
+ */
+struct axi_dmac_segment {
+	/** Source address, unused for DMA_DEV_TO_MEM */
+	uint32_t src_addr;
+	/** Destination address, unused for DMA_MEM_TO_DEV */
+	uint32_t dest_addr;
+	/** Bytes per row */
+	uint32_t x_len;
+	/** Number of rows, 0 is the same as 1 */
+	uint32_t y_len;
+	/** Distance in bytes between two source rows */
+	uint32_t src_stride;
+	/** Distance in bytes between two destination rows */
+	uint32_t dest_stride;
+};
+
+/* Scatter-gather descriptor, as read by the DMAC from memory */
+struct axi_dmac_hw_desc {
+	uint32_t flags;
+	uint32_t id;
+	uint64_t dest_addr;
+	uint64_t src_addr;
+	uint64_t next_sg_addr;
+	uint32_t y_len;
+	uint32_t x_len;
+	uint32_t src_stride;
+	uint32_t dest_stride;
+	uint64_t pad[2];
+};
+
+/**
+ * @struct axi_dmac_sg_mem
+ * @brief Memory the DMAC can read the scatter-gather descriptors from, such as
+ * an uncached or coherent region. Cached memory is flushed with the
+ * dcache_flush_range callback of the DMAC.
+ */
+struct axi_dmac_sg_mem {
+	/** Address of the descriptors for the CPU */
+	struct axi_dmac_hw_desc *virt;
+	/** Address of the same memory for the DMAC, aligned to
+	 * AXI_DMAC_HW_DESC_ALIGN */
+	uint64_t phys;
+	/** Number of descriptors that fit, see axi_dmac_sg_nb_descs() */
+	uint32_t nb_descs;
+};
+
+struct axi_dmac_desc;
+
+/* Called, from the DMAC ISR or from axi_dmac_poll(), when a descriptor is
+ * done. The descriptor may be queued again from the callback. */
+typedef void (*axi_dmac_callback)(struct axi_dmac_desc *desc, void *ctx);
+
+/**
+ * @struct axi_dmac_desc
+ * @brief Transfer queued with axi_dmac_queue_transfer(). The descriptor is
+ * owned by the driver until done is set and must stay valid until then.
+ */
+struct axi_dmac_desc {
+	/** Source address, unused for DMA_DEV_TO_MEM */
+	uint32_t src_addr;
+	/** Destination address, unused for DMA_MEM_TO_DEV */
+	uint32_t dest_addr;
+	/** Size in bytes, split in bursts of at most max_length + 1 bytes.
+	 * Set by axi_dmac_prep_segments() for a segment list. */
+	uint32_t size;
+	/** Optional completion callback */
+	axi_dmac_callback callback;
+	/** Passed to callback */
+	void *ctx;
+	/** Set once all the bytes were transferred */
+	volatile bool done;
+	/** Segments transferred instead of src_addr and dest_addr, set with
+	 * axi_dmac_prep_segments() */
+	const struct axi_dmac_segment *segments;
+	/** Number of segments */
+	uint32_t nb_segments;
+	/* Private fields */
+	/* Segment, row and offset in the row of the next burst */
+	uint32_t seg;
+	uint32_t row;
+	uint32_t offset;
+	/* Scatter-gather chain built by axi_dmac_prep_segments() */
+	struct axi_dmac_hw_desc *hw_descs;
+	uint64_t hw_descs_phys;
+	/* Next descriptor in the queue of the ones not fully submitted */
+	struct axi_dmac_desc *next;
+};
+
+/* Burst submitted to the hardware */
+struct axi_dmac_burst {
+	struct axi_dmac_desc *desc;
+	/* Transfer ID assigned by the hardware */
+	uint32_t id;
+	/* Last burst of desc */
+	bool last;
+};
+
 struct axi_dmac {
 	const char *name;
 	uint32_t base;
 	enum use_irq irq_option;
 	enum dma_direction direction;
 	bool hw_cyclic;
+	/* Y_LENGTH and the strides are implemented */
+	bool hw_2d;
+	/* Transfers can be read from scatter-gather descriptors in memory */
+	bool hw_sg;
 	uint32_t max_length;
 	uint32_t width_dst;
 	uint32_t width_src;
@@ -113,12 +230,23 @@ struct axi_dmac {
 	uint32_t remaining_size;
 	uint32_t next_src_addr;
 	uint32_t next_dest_addr;
+	/* Descriptors queued and not fully submitted, in order */
+	struct axi_dmac_desc *pending_first;
+	struct axi_dmac_desc *pending_last;
+	/* Bursts submitted to the hardware, in completion order */
+	struct axi_dmac_burst inflight[AXI_DMAC_QUEUE_DEPTH];
+	uint32_t inflight_first;
+	uint32_t nb_inflight;
+	void (*dcache_flush_range)(uint32_t address, uint32_t bytes_count);
 };
 
 struct axi_dmac_init {
 	const char *name;
 	uint32_t base;
 	enum use_irq irq_option;
+	/** Optional, flushes the scatter-gather descriptors on cached
+	 * platforms */
+	void (*dcache_flush_range)(uint32_t address, uint32_t bytes_count);
 };
 
 void axi_dmac_dev_to_mem_isr(void *instance);
@@ -138,5 +266,20 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
 		uint32_t timeout_ms);
 void axi_dmac_transfer_stop(struct axi_dmac *dmac);
+int32_t axi_dmac_queue_transfer(struct axi_dmac *dmac,
+				struct axi_dmac_desc *desc);
+uint32_t axi_dmac_sg_nb_descs(struct axi_dmac *dmac,
+			      const struct axi_dmac_segment *segments,
+			      uint32_t nb_segments);
+int32_t axi_dmac_prep_segments(struct axi_dmac *dmac,
+			       struct axi_dmac_desc *desc,
+			       const struct axi_dmac_segment *segments,
+			       uint32_t nb_segments,
+			       const struct axi_dmac_sg_mem *sg_mem);
+void axi_dmac_free_segments(struct axi_dmac_desc *desc);
+int32_t axi_dmac_poll(struct axi_dmac *dmac);
+int32_t axi_dmac_wait_event(struct axi_dmac *dmac, uint32_t *timeout_us);
+int32_t axi_dmac_wait(struct axi_dmac *dmac, struct axi_dmac_desc *desc,
+		      uint32_t timeout_us);
 
 #endif
@@ -38,10 +38,13 @@
 #include <inttypes.h>
 #include "no_os_error.h"
 #include "no_os_alloc.h"
+#include "no_os_circular_buffer.h"
 #include "iio.h"
 #include "iio_axi_adc.h"
 
 #define STORAGE_BITS 16
+/* Maximum time to wait for a block, in us */
+#define IIO_AXI_ADC_TIMEOUT_US	500000
 
 /**
  * @brief get_cf_calibphase().
@@ -279,6 +282,23 @@ static int set_sampling_frequency(void *device, char *buf, uint32_t len,
 }
 
 
+/**
+ * @brief Get the number of times streaming stopped because the client didn't
+ * read the buffer in time.
+ * @param device - Physical instance of a iio_axi_adc_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static int get_overruns(void *device, char *buf, uint32_t len,
+			const struct iio_ch_info *channel, intptr_t priv)
+{
+	struct iio_axi_adc_desc *iio_adc = (struct iio_axi_adc_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_adc->overruns);
+}
+
 /**
  * List containing attributes, corresponding to "voltage" channels.
  */
@@ -311,6 +331,17 @@ static struct iio_attribute iio_voltage_attributes[] = {
 	END_ATTRIBUTES_ARRAY
 };
 
+/**
+ * List containing the buffer attributes of a streaming device.
+ */
+static struct iio_attribute iio_buffer_attributes[] = {
+	{
+		.name = "overruns",
+		.show = get_overruns,
+	},
+	END_ATTRIBUTES_ARRAY
+};
+
 /**
  * @brief Update active channels
  * @param dev - Instance of the iio_axi_adc
@@ -371,6 +402,163 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 	return 0;
 }
 
+/**
+ * @brief Queue a DMA transfer into each free block of the buffer. Blocks
+ * holding data not read yet are not reused.
+ * @param iio_adc - Instance of the iio_axi_adc
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_axi_adc_queue_blocks(struct iio_axi_adc_desc *iio_adc)
+{
+	struct iio_buffer *buffer = iio_adc->buffer;
+	struct axi_dmac_desc *desc;
+	void *addr;
+	int ret;
+
+	while (buffer->nb_pending < buffer->nb_blocks) {
+		ret = iio_buffer_get_block(buffer, &addr);
+		if (ret == -EAGAIN)
+			break;
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		desc = &iio_adc->blocks[((int8_t *)addr - buffer->buf->buff) /
+						 buffer->size];
+		desc->src_addr = 0;
+		desc->dest_addr = (uintptr_t)addr;
+		desc->size = buffer->size;
+		ret = axi_dmac_queue_transfer(iio_adc->dmac, desc);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			/* Give the block back, it wasn't queued */
+			buffer->nb_pending--;
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Hand the oldest block to the client, if its DMA transfer is done.
+ * @param iio_adc - Instance of the iio_axi_adc
+ * @return 1 if a block was handed over, 0 if none is done yet or negative value
+ * otherwise.
+ */
+static int iio_axi_adc_retire_block(struct iio_axi_adc_desc *iio_adc)
+{
+	struct iio_buffer *buffer = iio_adc->buffer;
+	struct axi_dmac_desc *desc, *newest;
+	uint32_t first;
+	int ret;
+
+	if (!buffer->nb_pending)
+		return 0;
+
+	/* Blocks are done in order, the oldest one starts at the write index */
+	first = buffer->buf->write.idx / buffer->size;
+	desc = &iio_adc->blocks[first];
+	if (!desc->done)
+		return 0;
+
+	/* No transfer left in flight, samples are lost until the next submit */
+	newest = &iio_adc->blocks[(first + buffer->nb_pending - 1) %
+						  buffer->nb_blocks];
+	if (newest->done && buffer->nb_blocks > 1)
+		iio_adc->overruns++;
+
+	if (iio_adc->dcache_invalidate_range)
+		iio_adc->dcache_invalidate_range(desc->dest_addr, desc->size);
+
+	ret = iio_buffer_block_done(buffer);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return 1;
+}
+
+/**
+ * @brief Make sure a block of samples is available, starting or restarting
+ * the DMA chain if needed.
+ * @param dev_data - The iio device data structure.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_submit(struct iio_device_data *dev_data)
+{
+	struct iio_axi_adc_desc *iio_adc;
+	struct iio_buffer *buffer;
+	uint32_t timeout = IIO_AXI_ADC_TIMEOUT_US;
+	uint32_t size;
+	int retired = 0;
+	int ret;
+
+	if (!dev_data)
+		return -EINVAL;
+
+	iio_adc = dev_data->dev;
+	buffer = dev_data->buffer;
+
+	if (!iio_adc->blocks) {
+		iio_adc->blocks = no_os_calloc(buffer->nb_blocks,
+					       sizeof(*iio_adc->blocks));
+		if (!iio_adc->blocks)
+			return -ENOMEM;
+		iio_adc->buffer = buffer;
+		iio_adc->overruns = 0;
+	}
+
+	/*
+	 * The buffer is only updated from here, in the context of the client.
+	 * The DMA completion only marks the descriptors done, so the blocks are
+	 * handed over and queued again here, one block per read.
+	 */
+	ret = axi_dmac_poll(iio_adc->dmac);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	while (1) {
+		ret = no_os_cb_size(buffer->buf, &size);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		if (size < buffer->size) {
+			retired = iio_axi_adc_retire_block(iio_adc);
+			if (NO_OS_IS_ERR_VALUE(retired))
+				return retired;
+		}
+
+		/* Queue the blocks read since the last call, restarting the DMA */
+		ret = iio_axi_adc_queue_blocks(iio_adc);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		if (size >= buffer->size || retired)
+			return 0;
+
+		ret = axi_dmac_wait_event(iio_adc->dmac, &timeout);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+}
+
+/**
+ * @brief Stop streaming.
+ * @param dev - Instance of the iio_axi_adc
+ * @return 0 in case of success.
+ */
+static int32_t iio_axi_adc_post_disable(void *dev)
+{
+	struct iio_axi_adc_desc *iio_adc = dev;
+
+	if (!iio_adc->blocks)
+		return 0;
+
+	axi_dmac_transfer_stop(iio_adc->dmac);
+	no_os_free(iio_adc->blocks);
+	iio_adc->blocks = NULL;
+	iio_adc->buffer = NULL;
+
+	return 0;
+}
+
 /**
  * @brief Delete iio_device.
  * @param iio_device - Structure describing a device, channels and attributes.
@@ -437,7 +625,13 @@ static int32_t iio_axi_adc_create_device_descriptor(
 	}
 
 	iio_device->pre_enable = iio_axi_adc_prepare_transfer;
-	iio_device->read_dev = iio_axi_adc_read_dev;
+	if (desc->streaming) {
+		iio_device->buffer_attributes = iio_buffer_attributes;
+		iio_device->submit = iio_axi_adc_submit;
+		iio_device->post_disable = iio_axi_adc_post_disable;
+	} else {
+		iio_device->read_dev = iio_axi_adc_read_dev;
+	}
 
 	return 0;
 error:
@@ -493,6 +687,7 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 	if (init->rx_dmac) {
 		iio_axi_adc_inst->dmac = init->rx_dmac;
 		iio_axi_adc_inst->dcache_invalidate_range = init->dcache_invalidate_range;
+		iio_axi_adc_inst->streaming = init->streaming;
 	}
 	iio_axi_adc_inst->get_sampling_frequency = init->get_sampling_frequency;
 
@@ -525,6 +720,8 @@ int32_t iio_axi_adc_remove(struct iio_axi_adc_desc *desc)
 	if (!desc)
 		return -1;
 
+	iio_axi_adc_post_disable(desc);
+
 	status = iio_axi_adc_delete_device_descriptor(desc);
 	if (status < 0)
 		return status;
@@ -60,6 +60,14 @@ struct iio_axi_adc_desc {
 	char (*ch_names)[20];
 	/** Custom data format */
 	struct scan_type *scan_type_common;
+	/** Stream the samples with chained DMA transfers */
+	bool streaming;
+	/** DMA descriptor of each block of the buffer, while streaming */
+	struct axi_dmac_desc *blocks;
+	/** Buffer being streamed */
+	struct iio_buffer *buffer;
+	/** Number of times the DMA stopped because no block was free */
+	uint32_t overruns;
 };
 
 /**
@@ -79,6 +87,13 @@ struct iio_axi_adc_init_param {
 	/** Custom data format (unpopulated if not used, set to default)
 	    Common to all channels */
 	struct scan_type *scan_type_common;
+	/**
+	 * Keep the DMA running into the next blocks of the IIO buffer while
+	 * the completed ones are read, instead of starting one transfer per
+	 * read. Capture is gapless as long as the client keeps up and the
+	 * buffers count is at least 2. Requires rx_dmac.
+	 */
+	bool streaming;
 };
 
 /* Init iio. */
@@ -39,6 +39,7 @@
 #include <stdlib.h>
 #include "no_os_error.h"
 #include "no_os_alloc.h"
+#include "no_os_atomic.h"
 #include "iio.h"
 #include "iio_axi_dac.h"
 
@@ -448,6 +449,33 @@ static struct iio_attribute iio_altvoltage_attributes[] = {
 	END_ATTRIBUTES_ARRAY,
 };
 
+/**
+ * @brief Get the number of times the DMA ran out of samples while streaming.
+ * @param device - Physical instance of a iio_axi_dac_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static int get_underruns(void *device, char *buf, uint32_t len,
+			 const struct iio_ch_info *channel, intptr_t priv)
+{
+	struct iio_axi_dac_desc *iio_dac = (struct iio_axi_dac_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_dac->underruns);
+}
+
+/**
+ * List containing the buffer attributes of a streaming device.
+ */
+static struct iio_attribute iio_buffer_attributes[] = {
+	{
+		.name = "underruns",
+		.show = get_underruns,
+	},
+	END_ATTRIBUTES_ARRAY,
+};
+
 /**
  * @brief Update active channels
  * @param dev - Instance of the iio_axi_dac
@@ -513,6 +541,284 @@ int32_t iio_axi_dac_write_data(void *dev, void *buff, uint32_t nb_samples)
 	return axi_dmac_transfer_start(iio_dac->dmac, &transfer);
 }
 
+static void iio_axi_dac_block_done(struct axi_dmac_desc *desc, void *ctx);
+
+/**
+ * @brief Queue a DMA transfer from each block of the buffer pushed by the
+ * client and not queued yet.
+ * @param iio_dac - Instance of the iio_axi_dac
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_axi_dac_queue_blocks(struct iio_axi_dac_desc *iio_dac)
+{
+	struct iio_buffer *buffer = iio_dac->buffer;
+	struct axi_dmac_desc *desc;
+	void *addr;
+	int ret;
+
+	while (1) {
+		ret = iio_buffer_get_block(buffer, &addr);
+		if (ret == -EAGAIN || ret == -EBUSY)
+			return 0;
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		if (iio_dac->dcache_flush_range)
+			iio_dac->dcache_flush_range((uintptr_t)addr, buffer->size);
+
+		desc = &iio_dac->blocks[((int8_t *)addr - buffer->buf->buff) /
+						 buffer->size];
+		desc->src_addr = (uintptr_t)addr;
+		desc->dest_addr = 0;
+		desc->size = buffer->size;
+		desc->callback = iio_axi_dac_block_done;
+		desc->ctx = iio_dac;
+		ret = axi_dmac_queue_transfer(iio_dac->dmac, desc);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			/* Give the block back, it wasn't queued */
+			buffer->nb_pending--;
+			return ret;
+		}
+	}
+}
+
+/**
+ * @brief DMA completion callback while streaming: give the block back to the
+ * client and queue the ones pushed meanwhile.
+ * @param desc - DMA descriptor of the block.
+ * @param ctx - Instance of the iio_axi_dac
+ */
+static void iio_axi_dac_block_done(struct axi_dmac_desc *desc, void *ctx)
+{
+	struct iio_axi_dac_desc *iio_dac = ctx;
+	int ret;
+
+	ret = iio_buffer_block_done(iio_dac->buffer);
+	if (!NO_OS_IS_ERR_VALUE(ret))
+		ret = iio_axi_dac_queue_blocks(iio_dac);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		iio_dac->queue_err = ret;
+
+	/* Nothing left to send, the DAC starves until the next push */
+	if (!iio_dac->buffer->nb_pending)
+		iio_dac->underruns++;
+}
+
+/**
+ * @brief DMA completion callback of a cyclic waveform: play the latest
+ * waveform once more, so a swap takes effect at the end of a period. Once
+ * both transfers play the latest waveform, the IIO buffer block of the
+ * previous one is given back to the client.
+ * @param desc - One of the wave_descs.
+ * @param ctx - Instance of the iio_axi_dac
+ */
+static void iio_axi_dac_wave_done(struct axi_dmac_desc *desc, void *ctx)
+{
+	struct iio_axi_dac_desc *iio_dac = ctx;
+	struct iio_axi_dac_wave *wave, *prev;
+	struct axi_dmac_desc *other;
+	uint32_t idx;
+	int32_t ret;
+
+	if (!iio_dac->wave_active)
+		return;
+
+	idx = no_os_load_acquire(&iio_dac->wave_idx);
+	wave = &iio_dac->waves[idx];
+	desc->src_addr = wave->addr;
+	desc->size = wave->size;
+	ret = axi_dmac_queue_transfer(iio_dac->dmac, desc);
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		/* The waveform is played with a gap from now on */
+		iio_dac->queue_err = ret;
+		iio_dac->underruns++;
+	}
+
+	prev = &iio_dac->waves[!idx];
+	other = &iio_dac->wave_descs[desc == &iio_dac->wave_descs[0]];
+	if (prev->block && other->src_addr == wave->addr) {
+		prev->block = false;
+		iio_buffer_block_done(iio_dac->buffer);
+	}
+}
+
+/**
+ * @brief Stop the DMA chains started by iio_axi_dac_submit() or
+ * iio_axi_dac_swap_cyclic().
+ * @param iio_dac - Instance of the iio_axi_dac
+ */
+static void iio_axi_dac_stop(struct iio_axi_dac_desc *iio_dac)
+{
+	if (!iio_dac->blocks && !iio_dac->wave_active)
+		return;
+
+	iio_dac->wave_active = false;
+	iio_dac->waves[0].block = false;
+	iio_dac->waves[1].block = false;
+	axi_dmac_transfer_stop(iio_dac->dmac);
+	no_os_free(iio_dac->blocks);
+	iio_dac->blocks = NULL;
+	iio_dac->buffer = NULL;
+}
+
+/**
+ * @brief Play a waveform in a loop. If one is already played, the new one
+ * replaces it at the end of a period, without a gap. Both are played with
+ * two DMA transfers queued in turns, so the previous waveform may be played
+ * once more before the new one.
+ * @param desc - Instance of the iio_axi_dac
+ * @param buff - Samples of the active channels, valid while played
+ * @param nb_samples - Number of samples per channel
+ * @return 0 in case of success, -EBUSY if the previous swap is not done yet,
+ * in which case the memory of the waveform it replaces may still be read, or
+ * negative value otherwise.
+ */
+int32_t iio_axi_dac_swap_cyclic(struct iio_axi_dac_desc *desc, void *buff,
+				uint32_t nb_samples)
+{
+	struct iio_axi_dac_wave *wave;
+	uint32_t bytes, idx, i;
+	int32_t ret;
+
+	if (!desc || !desc->dmac || !buff)
+		return -EINVAL;
+
+	bytes = nb_samples * no_os_hweight32(desc->mask) * (STORAGE_BITS / 8);
+	if (!bytes)
+		return -EINVAL;
+
+	/* A non cyclic buffer is streamed */
+	if (desc->blocks)
+		return -EBUSY;
+
+	idx = desc->wave_idx;
+	if (desc->wave_active)
+		for (i = 0; i < NO_OS_ARRAY_SIZE(desc->wave_descs); i++)
+			if (desc->wave_descs[i].src_addr != desc->waves[idx].addr)
+				return -EBUSY;
+
+	if (desc->dcache_flush_range)
+		desc->dcache_flush_range((uintptr_t)buff, bytes);
+
+	if (desc->wave_active) {
+		wave = &desc->waves[!idx];
+		wave->addr = (uintptr_t)buff;
+		wave->size = bytes;
+		no_os_store_release(&desc->wave_idx, !idx);
+
+		return 0;
+	}
+
+	desc->waves[idx].addr = (uintptr_t)buff;
+	desc->waves[idx].size = bytes;
+	desc->wave_active = true;
+	desc->underruns = 0;
+	desc->queue_err = 0;
+	for (i = 0; i < NO_OS_ARRAY_SIZE(desc->wave_descs); i++) {
+		desc->wave_descs[i].src_addr = (uintptr_t)buff;
+		desc->wave_descs[i].dest_addr = 0;
+		desc->wave_descs[i].size = bytes;
+		desc->wave_descs[i].callback = iio_axi_dac_wave_done;
+		desc->wave_descs[i].ctx = desc;
+		ret = axi_dmac_queue_transfer(desc->dmac, &desc->wave_descs[i]);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			iio_axi_dac_stop(desc);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Send the blocks pushed by the client. A cyclic buffer replaces the
+ * waveform being played.
+ * @param dev_data - The iio device data structure.
+ * @return 0 in case of success or negative value otherwise. A DMA transfer
+ * that a completion callback failed to queue is reported by the next call.
+ */
+static int32_t iio_axi_dac_submit(struct iio_device_data *dev_data)
+{
+	struct iio_axi_dac_desc *iio_dac;
+	struct iio_buffer *buffer;
+	void *addr;
+	int ret;
+
+	if (!dev_data)
+		return -EINVAL;
+
+	iio_dac = dev_data->dev;
+	buffer = dev_data->buffer;
+
+	/* Report the failure of a DMA callback once */
+	if (iio_dac->queue_err) {
+		ret = iio_dac->queue_err;
+		iio_dac->queue_err = 0;
+
+		return ret;
+	}
+
+	if (buffer->cyclic_info.is_cyclic) {
+		/*
+		 * The block stays pending while it is played. The DMA callback
+		 * releases the block of the previous waveform once replaced, so
+		 * no other swap may start until then.
+		 */
+		if (iio_dac->waves[!iio_dac->wave_idx].block)
+			return -EBUSY;
+
+		ret = iio_buffer_get_block(buffer, &addr);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		iio_dac->buffer = buffer;
+		ret = iio_axi_dac_swap_cyclic(iio_dac, addr, buffer->samples);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			buffer->nb_pending--;
+			return ret;
+		}
+		iio_dac->waves[iio_dac->wave_idx].block = true;
+
+		return 0;
+	}
+
+	if (!iio_dac->blocks) {
+		if (iio_dac->wave_active)
+			return -EBUSY;
+
+		iio_dac->blocks = no_os_calloc(buffer->nb_blocks,
+					       sizeof(*iio_dac->blocks));
+		if (!iio_dac->blocks)
+			return -ENOMEM;
+		iio_dac->buffer = buffer;
+		iio_dac->underruns = 0;
+		iio_dac->queue_err = 0;
+	}
+
+	/*
+	 * With interrupts, the completion callback queues the blocks pushed
+	 * while transfers are in flight. Queue from here only when it can't
+	 * run concurrently.
+	 */
+	axi_dmac_poll(iio_dac->dmac);
+	if (iio_dac->dmac->irq_option != IRQ_ENABLED || !buffer->nb_pending)
+		return iio_axi_dac_queue_blocks(iio_dac);
+
+	return 0;
+}
+
+/**
+ * @brief Stop streaming.
+ * @param dev - Instance of the iio_axi_dac
+ * @return 0 in case of success.
+ */
+static int32_t iio_axi_dac_post_disable(void *dev)
+{
+	iio_axi_dac_stop(dev);
+
+	return 0;
+}
+
 enum ch_type {
 	CH_VOLTGE,
 	CH_ALTVOLTGE,
@@ -619,7 +925,13 @@ static int32_t iio_axi_dac_create_device_descriptor(
 			goto error;
 	}
 	iio_device->pre_enable = iio_axi_dac_prepare_transfer;
-	iio_device->write_dev = iio_axi_dac_write_data;
+	if (desc->streaming) {
+		iio_device->buffer_attributes = iio_buffer_attributes;
+		iio_device->submit = iio_axi_dac_submit;
+		iio_device->post_disable = iio_axi_dac_post_disable;
+	} else {
+		iio_device->write_dev = iio_axi_dac_write_data;
+	}
 
 	return 0;
 
@@ -669,6 +981,7 @@ int32_t iio_axi_dac_init(struct iio_axi_dac_desc **desc,
 	if (init->tx_dmac) {
 		iio_axi_dac_inst->dmac = init->tx_dmac;
 		iio_axi_dac_inst->dcache_flush_range = init->dcache_flush_range;
+		iio_axi_dac_inst->streaming = init->streaming;
 	}
 
 	status = iio_axi_dac_create_device_descriptor(iio_axi_dac_inst,
@@ -695,6 +1008,8 @@ int32_t iio_axi_dac_remove(struct iio_axi_dac_desc *desc)
 	if (!desc)
 		return -1;
 
+	iio_axi_dac_stop(desc);
+
 	status = iio_axi_dac_delete_device_descriptor(desc);
 	if (status < 0)
 		return status;
@@ -38,6 +38,19 @@
 #include "axi_dac_core.h"
 #include "axi_dmac.h"
 
+/**
+ * @struct iio_axi_dac_wave
+ * @brief Waveform played in a loop.
+ */
+struct iio_axi_dac_wave {
+	/** Address of the samples */
+	uint32_t addr;
+	/** Size in bytes */
+	uint32_t size;
+	/** Block of the IIO buffer, released once no longer played */
+	bool block;
+};
+
 /**
  * @struct iio_basic_desc
  * @brief Application desciptor.
@@ -54,6 +67,24 @@ struct iio_axi_dac_desc {
 	struct iio_device dev_descriptor;
 	/** Channel names */
 	char (*ch_names)[20];
+	/** Feed the DAC with chained DMA transfers */
+	bool streaming;
+	/** DMA descriptor of each block of the buffer, while streaming */
+	struct axi_dmac_desc *blocks;
+	/** Buffer being streamed */
+	struct iio_buffer *buffer;
+	/** Number of times the DMA ran out of samples while streaming */
+	uint32_t underruns;
+	/** Failure to queue a transfer from a DMA callback, for the next submit */
+	int32_t queue_err;
+	/** DMA descriptors playing the cyclic waveform in turns */
+	struct axi_dmac_desc wave_descs[2];
+	/** Waveform being played and the one staged by the last swap */
+	struct iio_axi_dac_wave waves[2];
+	/** Index in waves of the latest waveform */
+	uint32_t wave_idx;
+	/** Set while a waveform is played in a loop */
+	bool wave_active;
 };
 
 /**
@@ -67,6 +98,13 @@ struct iio_axi_dac_init_param {
 	struct axi_dmac *tx_dmac;
 	/** Function pointer to flush the data cache for the given address range */
 	void (*dcache_flush_range)(uint32_t address, uint32_t bytes_count);
+	/**
+	 * Feed the DAC from the blocks of the IIO buffer with chained DMA
+	 * transfers instead of one transfer per push. Cyclic buffers are
+	 * played in a loop and may be swapped with iio_axi_dac_swap_cyclic().
+	 * Requires tx_dmac.
+	 */
+	bool streaming;
 };
 
 /* Init application. */
@@ -75,6 +113,9 @@ int32_t iio_axi_dac_init(struct iio_axi_dac_desc **desc,
 /** Get device descriptor. */
 void iio_axi_dac_get_dev_descriptor(struct iio_axi_dac_desc *desc,
 				    struct iio_device **dev_descriptor);
+/* Play a waveform in a loop, replacing the current one at its end. */
+int32_t iio_axi_dac_swap_cyclic(struct iio_axi_dac_desc *desc, void *buff,
+				uint32_t nb_samples);
 /* Free the resources allocated by iio_axi_dac_init(). */
 int32_t iio_axi_dac_remove(struct iio_axi_dac_desc *desc);
 
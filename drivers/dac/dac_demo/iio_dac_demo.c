@@ -95,6 +95,48 @@ int get_dac_demo_attr(void *device, char *buf, uint32_t len,
 	return -EINVAL;
 }
 
+/**
+ * @struct dac_demo_drain
+ * @brief State of iio_dac_demo_drain_scans().
+ */
+struct dac_demo_drain {
+	/** Device instance */
+	struct dac_demo_desc *desc;
+	/** Sample index of the next scan */
+	uint32_t idx;
+};
+
+/**
+ * @brief Write scans to the loopback buffers of the active channels.
+ * @param ctx - The dac_demo_drain state.
+ * @param scans - Scans to be written.
+ * @param nb_scans - Number of scans.
+ * @return 0 in case of success.
+ */
+static int iio_dac_demo_drain_scans(void *ctx, void *scans, uint32_t nb_scans)
+{
+	struct dac_demo_drain *drain = ctx;
+	struct dac_demo_desc *desc = drain->desc;
+	uint16_t *data = scans;
+	uint32_t ch = -1;
+	uint32_t i;
+
+	for (i = 0; i < nb_scans; i++) {
+		while (get_next_ch_idx(desc->active_ch, ch, &ch)) {
+			uint16_t* ch_buffer = (uint16_t*)(desc->loopback_buffers +
+							  (ch * desc->loopback_buffer_len *
+							   sizeof(uint16_t) / sizeof(ch_buffer)));
+			ch_buffer[drain->idx] = *data++;
+		}
+		if (drain->idx == (desc->loopback_buffer_len - 1))
+			drain->idx = 0;
+		else
+			drain->idx++;
+	}
+
+	return 0;
+}
+
 /**
  * @brief function for writing samples to the device.
  * @param dev_data  - The iio device data structure.
@@ -103,36 +145,24 @@ int get_dac_demo_attr(void *device, char *buf, uint32_t len,
  */
 int32_t dac_submit_samples(struct iio_device_data *dev_data)
 {
-	struct dac_demo_desc *desc;
-	uint32_t k = 0;
-	uint32_t ch = -1;
-	uint16_t data[TOTAL_DAC_CHANNELS] = {0};
+	struct dac_demo_drain drain;
 	int ret;
-	uint32_t i = 0;
 
 	if (!dev_data)
 		return -ENODEV;
 
-	desc = dev_data->dev;
+	drain.desc = dev_data->dev;
+	drain.idx = 0;
 
-	if (!desc->loopback_buffers)
+	if (!drain.desc->loopback_buffers)
 		return -EINVAL;
 
-	for (i = 0; i < dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
-	     i++) {
-		ret = iio_buffer_pop_scan(dev_data->buffer, data);
-		if (ret)
-			return ret;
-
-		while (get_next_ch_idx(desc->active_ch, ch, &ch)) {
-			uint16_t* ch_buffer = (uint16_t*)(desc->loopback_buffers +
-							  (ch * desc->loopback_buffer_len *
-							   sizeof(uint16_t) / sizeof(ch_buffer)));
-			ch_buffer[i] = data[k++];
-		}
-
-		k = 0;
-	}
+	ret = iio_buffer_pop_scans(dev_data->buffer,
+				   dev_data->buffer->size /
+				   dev_data->buffer->bytes_per_scan,
+				   iio_dac_demo_drain_scans, &drain);
+	if (ret < 0)
+		return ret;
 
 	return 0;
 }
@@ -146,37 +176,22 @@ int32_t dac_submit_samples(struct iio_device_data *dev_data)
  */
 int32_t dac_demo_trigger_handler(struct iio_device_data *dev_data)
 {
-	struct dac_demo_desc *desc;
-	uint32_t k = 0;
-	uint32_t ch = -1;
-	uint16_t data[TOTAL_DAC_CHANNELS] = {0};
+	struct dac_demo_drain drain;
 	static uint32_t i = 0;
-	int ret;
 
 	if (!dev_data)
 		return -ENODEV;
 
-	desc = (struct dac_demo_desc *)dev_data->dev;
+	drain.desc = (struct dac_demo_desc *)dev_data->dev;
+	drain.idx = i;
 
-	if (!desc->loopback_buffers)
+	if (!drain.desc->loopback_buffers)
 		return -EINVAL;
 
-	ret = iio_buffer_pop_scan(dev_data->buffer, data);
-	if (ret)
-		/* No data to be processed, simply return 0 */
-		return 0;
-
-	/* Write data to the device one sample/channel at a time */
-	while (get_next_ch_idx(desc->active_ch, ch, &ch)) {
-		uint16_t* ch_buffer = (uint16_t*)(desc->loopback_buffers +
-						  (ch * desc->loopback_buffer_len *
-						   sizeof(uint16_t) / sizeof(ch_buffer)));
-		ch_buffer[i] = data[k++];
-	}
-	if (i == (desc->loopback_buffer_len - 1))
-		i = 0;
-	else
-		i++;
+	/* No data to be processed leaves i unchanged */
+	iio_buffer_pop_scans(dev_data->buffer, 1, iio_dac_demo_drain_scans,
+			     &drain);
+	i = drain.idx;
 
 	return 0;
 }
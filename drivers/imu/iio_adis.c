@@ -1476,76 +1476,44 @@ int adis_iio_post_disable(void* dev, uint32_t mask)
 }
 
 /**
- * @brief API to be called to get one single sample-set based on the given mask.
- * @param iio_adis - The iio adis structure.
- * @param mask     - The active channels mask.
- * @param buffer   - IIO buffer to push the sample set to.
- * @return 0 in case of success, error code otherwise.
+ * @struct adis_iio_scan
+ * @brief Sample-set to be written by adis_iio_fill_scan().
  */
-static int adis_iio_trigger_push_single_sample(struct adis_iio_dev *iio_adis,
-		uint32_t mask, struct iio_buffer *buffer, bool pop)
+struct adis_iio_scan {
+	/** The iio adis structure. */
+	struct adis_iio_dev *iio_adis;
+	/** Burst data read from the device. */
+	struct adis_burst_data *data;
+	/** The active channels mask. */
+	uint32_t mask;
+};
+
+/**
+ * @brief Fill one scan in place from a burst data read.
+ * @param ctx      - The adis_iio_scan describing the sample-set.
+ * @param scans    - Where to write the scan.
+ * @param nb_scans - Number of scans to write, always 1.
+ * @return 0 in case of success.
+ */
+static int adis_iio_fill_scan(void *ctx, void *scans, uint32_t nb_scans)
 {
-	struct adis_dev *adis;
-	int ret;
-	struct adis_burst_data data;
+	struct adis_iio_scan *scan = ctx;
+	struct adis_iio_dev *iio_adis = scan->iio_adis;
+	struct adis_burst_data *data = scan->data;
+	uint32_t mask = scan->mask;
+	uint16_t *buff = scans;
 	uint8_t i = 0;
-	uint32_t res1;
-	uint32_t res2;
 	uint8_t chan;
 
-	adis = iio_adis->adis_dev;
-
-	ret = adis_read_burst_data(adis, &data, iio_adis->burst_size,
-				   iio_adis->burst_sel, pop, false);
-
-	/* If ret ==  EAGAIN then no data is available to read (will happen
-	for a burst request or in case burst32 or burst select has been changed) */
-	if (ret == -EAGAIN)
-		return 0;
-
-	if (ret)
-		return ret;
-
-	uint32_t current_data_cntr = data.data_cntr_lsb | data.data_cntr_msb << 16;
-
-	if (iio_adis->data_cntr) {
-		if (current_data_cntr > iio_adis->data_cntr) {
-			if (iio_adis->sync_mode != ADIS_SYNC_SCALED)
-				iio_adis->samples_lost += current_data_cntr - iio_adis->data_cntr - 1;
-			else {
-				res1 = (current_data_cntr - iio_adis->data_cntr) * 49;
-				res2 = NO_OS_DIV_ROUND_CLOSEST(1000000, iio_adis->sampling_frequency);
-
-				if (res1 > res2) {
-					iio_adis->samples_lost += res1 / res2;
-					if (res1 % res2 < res2 / 2)
-						iio_adis->samples_lost--;
-				}
-			}
-
-		} else if (current_data_cntr == iio_adis->data_cntr) {
-			/* No new data, nothing else to do */
-			return 0;
-		}
-
-		else { /* data counter overflowed occurred */
-			if (iio_adis->sync_mode != ADIS_SYNC_SCALED)
-				iio_adis->samples_lost += NO_OS_U16_MAX - iio_adis->data_cntr +
-							  current_data_cntr;
-		}
-	}
-
-	iio_adis->data_cntr = current_data_cntr;
-
 	for (chan = 0; chan < ADIS_NUM_CHAN; chan++) {
 		if (mask & (1 << chan)) {
 			switch (chan) {
 			case ADIS_TEMP:
 
 				if (iio_adis->iio_dev->channels[chan].scan_type->storagebits == 32)
-					iio_adis->data[i++] = data.temp_msb;
+					buff[i++] = data->temp_msb;
 
-				iio_adis->data[i++] = data.temp_lsb;
+				buff[i++] = data->temp_lsb;
 				/*
 				 * The temperature channel has 16-bit storage size.
 				 * We need to perform the padding to have the buffer
@@ -1556,138 +1524,138 @@ static int adis_iio_trigger_push_single_sample(struct adis_iio_dev *iio_adis,
 				 */
 				if (mask & NO_OS_GENMASK(ADIS_DELTA_VEL_Z, ADIS_DELTA_ANGL_X)
 				    && iio_adis->iio_dev->channels[chan].scan_type->storagebits == 16)
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
 				break;
 			case ADIS_GYRO_X:
 				if (iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.x_gyro_msb;
+					buff[i++] = data->x_gyro_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.x_gyro_lsb;
+					buff[i++] =  data->x_gyro_lsb;
 				}
 				break;
 			case ADIS_GYRO_Y:
 				if (iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.y_gyro_msb;
+					buff[i++] = data->y_gyro_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.y_gyro_lsb;
+					buff[i++] =  data->y_gyro_lsb;
 				}
 				break;
 			case ADIS_GYRO_Z:
 				if (iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.z_gyro_msb;
+					buff[i++] = data->z_gyro_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.z_gyro_lsb;
+					buff[i++] =  data->z_gyro_lsb;
 				}
 				break;
 			case ADIS_ACCEL_X:
 				if (iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.x_accel_msb;
+					buff[i++] = data->x_accel_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.x_accel_lsb;
+					buff[i++] =  data->x_accel_lsb;
 				}
 				break;
 			case ADIS_ACCEL_Y:
 				if (iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.y_accel_msb;
+					buff[i++] = data->y_accel_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.y_accel_lsb;
+					buff[i++] =  data->y_accel_lsb;
 				}
 				break;
 			case ADIS_ACCEL_Z:
 				if (iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.z_accel_msb;
+					buff[i++] = data->z_accel_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.z_accel_lsb;
+					buff[i++] =  data->z_accel_lsb;
 				}
 				break;
 			case ADIS_DELTA_ANGL_X:
 				if (!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.x_gyro_msb;
+					buff[i++] = data->x_gyro_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.x_gyro_lsb;
+					buff[i++] =  data->x_gyro_lsb;
 				}
 				break;
 			case ADIS_DELTA_ANGL_Y:
 				if (!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.y_gyro_msb;
+					buff[i++] = data->y_gyro_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.y_gyro_lsb;
+					buff[i++] =  data->y_gyro_lsb;
 				}
 				break;
 			case ADIS_DELTA_ANGL_Z:
 				if (!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.z_gyro_msb;
+					buff[i++] = data->z_gyro_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.z_gyro_lsb;
+					buff[i++] =  data->z_gyro_lsb;
 				}
 				break;
 			case ADIS_DELTA_VEL_X:
 				if (!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.x_accel_msb;
+					buff[i++] = data->x_accel_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.x_accel_lsb;
+					buff[i++] =  data->x_accel_lsb;
 				}
 				break;
 			case ADIS_DELTA_VEL_Y:
 				if (!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.y_accel_msb;
+					buff[i++] = data->y_accel_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.y_accel_lsb;
+					buff[i++] =  data->y_accel_lsb;
 				}
 				break;
 			case ADIS_DELTA_VEL_Z:
 				if (!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
+					buff[i++] = 0;
+					buff[i++] = 0;
 				} else {
 					/* upper 16 */
-					iio_adis->data[i++] = data.z_accel_msb;
+					buff[i++] = data->z_accel_msb;
 					/* lower 16 */
-					iio_adis->data[i++] =  data.z_accel_lsb;
+					buff[i++] =  data->z_accel_lsb;
 				}
 				break;
 			default:
@@ -1696,7 +1664,79 @@ static int adis_iio_trigger_push_single_sample(struct adis_iio_dev *iio_adis,
 		}
 	}
 
-	return iio_buffer_push_scan(buffer, &iio_adis->data[0]);
+	return 0;
+}
+
+/**
+ * @brief API to be called to get one single sample-set based on the given mask.
+ * @param iio_adis - The iio adis structure.
+ * @param mask     - The active channels mask.
+ * @param buffer   - IIO buffer to push the sample set to.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int adis_iio_trigger_push_single_sample(struct adis_iio_dev *iio_adis,
+		uint32_t mask, struct iio_buffer *buffer, bool pop)
+{
+	struct adis_dev *adis;
+	int ret;
+	struct adis_burst_data data;
+	struct adis_iio_scan scan;
+	uint32_t res1;
+	uint32_t res2;
+
+	adis = iio_adis->adis_dev;
+
+	ret = adis_read_burst_data(adis, &data, iio_adis->burst_size,
+				   iio_adis->burst_sel, pop, false);
+
+	/* If ret ==  EAGAIN then no data is available to read (will happen
+	for a burst request or in case burst32 or burst select has been changed) */
+	if (ret == -EAGAIN)
+		return 0;
+
+	if (ret)
+		return ret;
+
+	uint32_t current_data_cntr = data.data_cntr_lsb | data.data_cntr_msb << 16;
+
+	if (iio_adis->data_cntr) {
+		if (current_data_cntr > iio_adis->data_cntr) {
+			if (iio_adis->sync_mode != ADIS_SYNC_SCALED)
+				iio_adis->samples_lost += current_data_cntr - iio_adis->data_cntr - 1;
+			else {
+				res1 = (current_data_cntr - iio_adis->data_cntr) * 49;
+				res2 = NO_OS_DIV_ROUND_CLOSEST(1000000, iio_adis->sampling_frequency);
+
+				if (res1 > res2) {
+					iio_adis->samples_lost += res1 / res2;
+					if (res1 % res2 < res2 / 2)
+						iio_adis->samples_lost--;
+				}
+			}
+
+		} else if (current_data_cntr == iio_adis->data_cntr) {
+			/* No new data, nothing else to do */
+			return 0;
+		}
+
+		else { /* data counter overflowed occurred */
+			if (iio_adis->sync_mode != ADIS_SYNC_SCALED)
+				iio_adis->samples_lost += NO_OS_U16_MAX - iio_adis->data_cntr +
+							  current_data_cntr;
+		}
+	}
+
+	iio_adis->data_cntr = current_data_cntr;
+
+	scan.iio_adis = iio_adis;
+	scan.data = &data;
+	scan.mask = mask;
+
+	ret = iio_buffer_push_scans(buffer, 1, adis_iio_fill_scan, &scan);
+	if (ret < 0)
+		return ret;
+
+	return 0;
 }
 
 /**
@@ -143,7 +143,6 @@ static int32_t aducm3029_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 	uint32_t		errors;
 	uint32_t		to_read;
 	uint32_t		idx = 0;
-	int ret;
 
 	if (!desc || !data)
 		return -1;
@@ -155,12 +154,8 @@ static int32_t aducm3029_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 	}
 
 	if (desc->rx_fifo) {
-		for (idx = 0; idx < bytes_number; idx++) {
-			ret = lf256fifo_read(desc->rx_fifo, &data[idx]);
-			if (ret)
-				return idx ? idx : -EAGAIN;
-		}
-		return idx;
+		idx = lf256fifo_read_bulk(desc->rx_fifo, data, bytes_number);
+		return idx ? idx : -EAGAIN;
 	}
 
 	/* Wait until a previously aducm3029_uart_read_nonblocking ends */
@@ -31,7 +31,17 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 
+/* Implements the allocator the NO_OS_ALLOC_TRACE layer forwards to */
+#define NO_OS_ALLOC_BACKEND
 #include "no_os_alloc.h"
+
+/*
+ * The pool backend allocates the tagged blocks (IIO, lists, fifos) and frees
+ * them through no_os_free(). It can't share no_os_free() with this heap.
+ */
+#ifdef NO_OS_ALLOC_POOL
+#error "NO_OS_ALLOC_POOL is not supported with the platform allocator"
+#endif
 #include "hal.h"
 #include <string.h>
 
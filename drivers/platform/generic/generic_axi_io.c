@@ -34,6 +34,7 @@
 #include <stdint.h>
 #include "no_os_error.h"
 #include "no_os_util.h"
+#include "no_os_axi_io.h"
 
 /**
  * @brief AXI IO generic read function.
@@ -66,3 +67,72 @@ int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 
 	return 0;
 }
+
+/**
+ * @brief AXI IO generic burst read function.
+ * @param base - Base address
+ * @param offset - Offset of the first register
+ * @param data - array where the values of the registers are stored
+ * @param count - number of consecutive registers to be read
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(offset);
+	NO_OS_UNUSED_PARAM(data);
+	NO_OS_UNUSED_PARAM(count);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic burst write function.
+ * @param base - Base address
+ * @param offset - Offset of the first register
+ * @param data - values to be written to the registers
+ * @param count - number of consecutive registers to be written
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_write_burst(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(offset);
+	NO_OS_UNUSED_PARAM(data);
+	NO_OS_UNUSED_PARAM(count);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic batch function.
+ * @param base - Base address
+ * @param ops - register operations, the read values are stored in place
+ * @param num_ops - number of operations
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_batch(uint32_t base, struct no_os_axi_io_op *ops,
+			   uint32_t num_ops)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(ops);
+	NO_OS_UNUSED_PARAM(num_ops);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic wait for interrupt function, not supported.
+ * @param base - Base address
+ * @param timeout_us - maximum time to wait, in us
+ * @return -ENOSYS.
+ */
+int32_t no_os_axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(timeout_us);
+
+	return -ENOSYS;
+}
@@ -51,3 +51,14 @@ void no_os_mdelay(uint32_t msecs)
 {
 	NO_OS_UNUSED_PARAM(msecs);
 }
+
+/**
+ * @brief Get current time.
+ * @return Always 0, there is no time source.
+ */
+struct no_os_time no_os_get_time(void)
+{
+	struct no_os_time t = {0, 0};
+
+	return t;
+}
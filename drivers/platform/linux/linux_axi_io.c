@@ -33,147 +33,656 @@
 
 #include <fcntl.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <poll.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include "no_os_error.h"
+#include "no_os_util.h"
 #include "no_os_axi_io.h"
 
 /**
- * @brief AXI IO through UIO read/write function.
- * @param base - UIO index (/dev/uioX).
- * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @struct axi_io_window
+ * @brief Mapped register range, resolved once for a batch of accesses.
+ */
+struct axi_io_window {
+	/** Offset, relative to the base, of the first mapped byte */
+	uint32_t offset;
+	/** Size of the mapped range in bytes */
+	uint32_t size;
+	/** Start of the mapped range */
+	volatile uint8_t *addr;
+};
+
+#ifndef DEVMEM
+/** Path prefix of the UIO character devices */
+#ifndef UIO_DEV_PATH
+#define UIO_DEV_PATH		"/dev/uio"
+#endif
+
+/** Path prefix of the UIO sysfs entries */
+#ifndef UIO_SYSFS_PATH
+#define UIO_SYSFS_PATH		"/sys/class/uio/uio"
+#endif
+
+/** Maximum number of UIO devices that can be kept mapped at once */
+#ifndef UIO_MAX_DEVICES
+#define UIO_MAX_DEVICES		32
+#endif
+
+/**
+ * @struct uio_map
+ * @brief Mapping of the first memory region of a UIO device.
+ */
+struct uio_map {
+	/** Start of the mapped region, NULL if not mapped yet */
+	volatile void *addr;
+	/** Size of the mapped region in bytes */
+	size_t size;
+	/** UIO device kept open to wait for its interrupt, -1 if it has none */
+	int fd;
+};
+
+/** UIO mappings, indexed by the UIO device number */
+static struct uio_map uio_maps[UIO_MAX_DEVICES];
+
+/** Set once the unmap handler has been registered with atexit() */
+static bool uio_atexit_registered;
+
+/**
+ * @brief Unmap all the cached UIO regions.
+ * @return None.
  */
-static int32_t uio_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-			      uint32_t *write)
+static void uio_unmap_all(void)
 {
-	char buf[32];
+	uint32_t i;
+
+	for (i = 0; i < UIO_MAX_DEVICES; i++) {
+		if (!uio_maps[i].addr)
+			continue;
+
+		munmap((void *)uio_maps[i].addr, uio_maps[i].size);
+		if (uio_maps[i].fd >= 0)
+			close(uio_maps[i].fd);
+		uio_maps[i].fd = -1;
+		uio_maps[i].addr = NULL;
+		uio_maps[i].size = 0;
+	}
+}
+
+/**
+ * @brief Get the size of the first memory region of a UIO device.
+ *
+ * The size is read from sysfs. If the sysfs entry is not available, the size
+ * of the device file itself is used instead, which allows using a regular
+ * file as a stand-in for the UIO device.
+ * @param index - UIO index (/dev/uioX).
+ * @param fd - File descriptor of the opened UIO device.
+ * @param size - Location where the region size will be stored.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t uio_get_map_size(uint32_t index, int fd, size_t *size)
+{
+	char path[64];
+	unsigned long long val;
+	struct stat st;
+	FILE *f;
 	int ret;
+
+	sprintf(path, UIO_SYSFS_PATH "%"PRIu32"/maps/map0/size", index);
+
+	f = fopen(path, "r");
+	if (f) {
+		ret = fscanf(f, "%llx", &val);
+		fclose(f);
+		if (ret == 1 && val) {
+			*size = val;
+			return 0;
+		}
+	}
+
+	if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(uint32_t))
+		return -ENODEV;
+
+	*size = st.st_size;
+
+	return 0;
+}
+
+/**
+ * @brief Map the first memory region of a UIO device and cache the mapping.
+ * @param index - UIO index (/dev/uioX).
+ * @return Pointer to the cached mapping in case of success, NULL otherwise.
+ */
+static struct uio_map *uio_map_get(uint32_t index)
+{
+	struct uio_map *map;
+	struct stat st;
+	char buf[32];
+	size_t size;
+	void *addr;
 	int uio_fd;
-	int32_t status = 0;
-	void *uio_addr;
+	int ret;
 
-	sprintf(buf, "/dev/uio%"PRIu32"", base);
+	if (index >= UIO_MAX_DEVICES)
+		return NULL;
 
-	uio_fd = open(buf, O_RDWR);
+	map = &uio_maps[index];
+	if (map->addr)
+		return map;
+
+	sprintf(buf, UIO_DEV_PATH "%"PRIu32"", index);
+
+	uio_fd = open(buf, O_RDWR | O_SYNC);
 	if (uio_fd < 0) {
 		printf("%s: Can't open %s\n\r", __func__, buf);
-		return -1;
+		return NULL;
+	}
+
+	ret = uio_get_map_size(index, uio_fd, &size);
+	if (ret) {
+		printf("%s: Can't get the map size of %s\n\r", __func__, buf);
+		goto close;
 	}
 
-	uio_addr = mmap(NULL,
-			offset + sizeof(*read),
-			PROT_READ | PROT_WRITE,
-			MAP_SHARED,
-			uio_fd,
-			0);
-	if (uio_addr == MAP_FAILED) {
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, uio_fd, 0);
+	if (addr == MAP_FAILED) {
 		printf("%s: mmap() failed\n\r", __func__);
-		status = -1;
 		goto close;
 	}
 
-	if (read)
-		*read = *(uint32_t *)((uintptr_t)uio_addr + offset);
-	if (write)
-		*(uint32_t *)((uintptr_t)uio_addr + offset) = *write;
+	/*
+	 * The mapping stays valid after the file descriptor is closed. Keep
+	 * the ones of UIO devices open to wait for their interrupt, a regular
+	 * file standing in for the device has none.
+	 */
+	if (fstat(uio_fd, &st) < 0 || !S_ISCHR(st.st_mode)) {
+		close(uio_fd);
+		uio_fd = -1;
+	}
 
-	ret = munmap(uio_addr, offset + sizeof(*read));
-	if (ret < 0) {
-		printf("%s: munmap() failed\n\r", __func__);
-		status = -1;
+	if (!uio_atexit_registered) {
+		atexit(uio_unmap_all);
+		uio_atexit_registered = true;
 	}
 
+	map->addr = addr;
+	map->size = size;
+	map->fd = uio_fd;
+
+	return map;
+
 close:
-	ret = close(uio_fd);
-	if (ret < 0) {
-		printf("%s: Can't close %s\n\r", __func__, buf);
-		status = -1;
-	}
+	close(uio_fd);
 
-	return status;
+	return NULL;
 }
 
-#ifdef DEVMEM
 /**
- * @brief AXI IO through devmem read/write function.
- * @param base - Base address.
+ * @brief Get the mapped address of a UIO register.
+ *
+ * The UIO device is mapped on first access and stays mapped until the process
+ * exits, so every subsequent access is a single load/store.
+ * @param base - UIO index (/dev/uioX).
  * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @param reg - Location where the register address will be stored.
+ * @return 0 in case of success, negative error code otherwise.
  */
-static int32_t devmem_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-				 uint32_t *write)
+static int32_t axi_io_reg_get(uint32_t base, uint32_t offset,
+			      volatile uint32_t **reg)
 {
-	char command[64];
-	char answer[64];
-	FILE *stream;
-	int32_t ret;
+	struct uio_map *map;
+
+	map = uio_map_get(base);
+	if (!map)
+		return -ENODEV;
+
+	if (offset > map->size - sizeof(**reg) || (offset & 0x3))
+		return -EINVAL;
+
+	*reg = (volatile uint32_t *)((uintptr_t)map->addr + offset);
+
+	return 0;
+}
+
+/**
+ * @brief Get the mapped register range of a UIO device.
+ * @param base - UIO index (/dev/uioX).
+ * @param offset - Address offset, unused since the whole region is mapped.
+ * @param win - Location where the mapped range will be stored.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t axi_io_window_get(uint32_t base, uint32_t offset,
+				 struct axi_io_window *win)
+{
+	struct uio_map *map;
+
+	NO_OS_UNUSED_PARAM(offset);
+
+	map = uio_map_get(base);
+	if (!map)
+		return -ENODEV;
 
-	if (write)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x w 0x%x", base + offset, *write);
-	else if (read)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x", base + offset);
+	win->offset = 0;
+	win->size = map->size;
+	win->addr = map->addr;
+
+	return 0;
+}
+
+/**
+ * @brief Wait for the interrupt of a UIO device.
+ *
+ * The interrupt is unmasked by writing 1 to the device, the kernel masks it
+ * again once it fires. A level interrupt still asserted when unmasked fires
+ * right away, so no event is lost between two waits.
+ * @param base - UIO index (/dev/uioX).
+ * @param timeout_us - Maximum time to wait, in us. Updated with the time left.
+ * @return 0 once the interrupt fired, -ETIMEDOUT if it did not in time,
+ *	   -ENOSYS if the device has no interrupt, negative error code otherwise.
+ */
+int32_t no_os_axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	struct timespec start, end;
+	struct uio_map *map;
+	struct pollfd pfd;
+	uint32_t enable = 1;
+	uint32_t count;
+	uint64_t elapsed;
+	int ret;
+
+	map = uio_map_get(base);
+	if (!map)
+		return -ENODEV;
+
+	if (map->fd < 0)
+		return -ENOSYS;
+
+	/* Without interrupt control the UIO driver can't unmask the line */
+	if (write(map->fd, &enable, sizeof(enable)) != sizeof(enable)) {
+		close(map->fd);
+		map->fd = -1;
+		return -ENOSYS;
+	}
+
+	pfd.fd = map->fd;
+	pfd.events = POLLIN;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	/* Rounded up to the next ms, without overflowing near UINT32_MAX */
+	ret = poll(&pfd, 1, *timeout_us / 1000 + !!(*timeout_us % 1000));
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	elapsed = (end.tv_sec - start.tv_sec) * 1000000ull +
+		  (end.tv_nsec - start.tv_nsec) / 1000;
+	if (ret == 0 || elapsed >= *timeout_us)
+		*timeout_us = 0;
 	else
-		return -1;
+		*timeout_us -= elapsed;
 
-	if (ret < 0 || ret >= (int32_t) sizeof(command))
-		return -1;
+	if (ret < 0)
+		return -errno;
+	if (ret == 0)
+		return -ETIMEDOUT;
 
-	stream = popen(command, "r");
-	if (stream == NULL)
-		return -1;
+	/* Consume the event, the value is the number of interrupts so far */
+	if (read(map->fd, &count, sizeof(count)) != sizeof(count))
+		return -EIO;
 
-	if (!(fgets(answer, sizeof(answer), stream))) {
-		ret = -1;
-		goto close;
+	return 0;
+}
+#else
+/** Path of the physical memory device */
+#ifndef DEVMEM_PATH
+#define DEVMEM_PATH		"/dev/mem"
+#endif
+
+/** Size of a /dev/mem mapping window, power of two multiple of the page size */
+#ifndef DEVMEM_MAP_SIZE
+#define DEVMEM_MAP_SIZE		0x10000
+#endif
+
+/** Maximum number of /dev/mem windows that can be kept mapped at once */
+#ifndef DEVMEM_MAX_MAPS
+#define DEVMEM_MAX_MAPS		64
+#endif
+
+/**
+ * @struct devmem_map
+ * @brief Mapping of a window of the physical address space.
+ */
+struct devmem_map {
+	/** Physical start address of the window */
+	uintptr_t phys;
+	/** Start of the mapped window */
+	volatile void *addr;
+};
+
+/** Mapped windows, sorted by physical start address */
+static struct devmem_map devmem_maps[DEVMEM_MAX_MAPS];
+
+/** Number of valid entries in devmem_maps */
+static uint32_t devmem_maps_cnt;
+
+/** /dev/mem file descriptor, kept open while windows are mapped */
+static int devmem_fd = -1;
+
+/**
+ * @brief Unmap all the cached /dev/mem windows and close /dev/mem.
+ * @return None.
+ */
+static void devmem_unmap_all(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < devmem_maps_cnt; i++)
+		munmap((void *)devmem_maps[i].addr, DEVMEM_MAP_SIZE);
+	devmem_maps_cnt = 0;
+
+	if (devmem_fd >= 0) {
+		close(devmem_fd);
+		devmem_fd = -1;
+	}
+}
+
+/**
+ * @brief Find the position of a window in the sorted window table.
+ * @param phys - Window aligned physical address.
+ * @return Index of the window if it is mapped, otherwise the index at which
+ *	   it has to be inserted to keep the table sorted.
+ */
+static uint32_t devmem_map_find(uintptr_t phys)
+{
+	uint32_t lo = 0;
+	uint32_t hi = devmem_maps_cnt;
+	uint32_t mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (devmem_maps[mid].phys < phys)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	if (read)
-		*read = strtol(answer, NULL, 0);
+	return lo;
+}
 
-	ret = 0;
-close:
-	pclose(stream);
+/**
+ * @brief Get the virtual address of a physical address, mapping the window
+ *	  which contains it if needed.
+ * @param addr - Physical address.
+ * @return Virtual address in case of success, NULL otherwise.
+ */
+static volatile void *devmem_map_get(uintptr_t addr)
+{
+	uintptr_t phys = addr & ~((uintptr_t)DEVMEM_MAP_SIZE - 1);
+	uint32_t i;
+	void *virt;
 
-	return ret;
+	i = devmem_map_find(phys);
+	if (i < devmem_maps_cnt && devmem_maps[i].phys == phys)
+		goto found;
+
+	if (devmem_maps_cnt == DEVMEM_MAX_MAPS) {
+		printf("%s: Too many mapped windows\n\r", __func__);
+		return NULL;
+	}
+
+	if (devmem_fd < 0) {
+		if (DEVMEM_MAP_SIZE % sysconf(_SC_PAGESIZE))
+			return NULL;
+
+		devmem_fd = open(DEVMEM_PATH, O_RDWR | O_SYNC);
+		if (devmem_fd < 0) {
+			printf("%s: Can't open %s\n\r", __func__, DEVMEM_PATH);
+			return NULL;
+		}
+
+		atexit(devmem_unmap_all);
+	}
+
+	virt = mmap(NULL, DEVMEM_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+		    devmem_fd, phys);
+	if (virt == MAP_FAILED) {
+		printf("%s: mmap() failed\n\r", __func__);
+		return NULL;
+	}
+
+	memmove(&devmem_maps[i + 1], &devmem_maps[i],
+		(devmem_maps_cnt - i) * sizeof(devmem_maps[0]));
+	devmem_maps[i].phys = phys;
+	devmem_maps[i].addr = virt;
+	devmem_maps_cnt++;
+
+found:
+	return (volatile uint8_t *)devmem_maps[i].addr + (addr - phys);
+}
+
+/**
+ * @brief Get the mapped address of a physical register.
+ * @param base - Base address.
+ * @param offset - Address offset.
+ * @param reg - Location where the register address will be stored.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t axi_io_reg_get(uint32_t base, uint32_t offset,
+			      volatile uint32_t **reg)
+{
+	uintptr_t addr = (uintptr_t)base + offset;
+
+	if (addr & 0x3)
+		return -EINVAL;
+
+	*reg = devmem_map_get(addr);
+	if (!*reg)
+		return -ENODEV;
+
+	return 0;
+}
+
+/**
+ * @brief Get the mapped /dev/mem window which contains a register.
+ * @param base - Base address.
+ * @param offset - Address offset.
+ * @param win - Location where the mapped window will be stored.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t axi_io_window_get(uint32_t base, uint32_t offset,
+				 struct axi_io_window *win)
+{
+	uintptr_t addr = (uintptr_t)base + offset;
+	uintptr_t phys = addr & ~((uintptr_t)DEVMEM_MAP_SIZE - 1);
+	volatile uint8_t *virt;
+
+	virt = devmem_map_get(addr);
+	if (!virt)
+		return -ENODEV;
+
+	/* Wraps around when the window starts below the base */
+	win->offset = offset - (uint32_t)(addr - phys);
+	win->size = DEVMEM_MAP_SIZE;
+	win->addr = virt - (addr - phys);
+
+	return 0;
+}
+
+/**
+ * @brief Wait for the interrupt of a device, not supported through /dev/mem.
+ * @param base - Base address.
+ * @param timeout_us - Maximum time to wait, in us.
+ * @return -ENOSYS.
+ */
+int32_t no_os_axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(timeout_us);
+
+	return -ENOSYS;
 }
 #endif //DEVMEM
+
 /**
  * @brief AXI IO through UIO/devmem read function.
  * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
  * @param data - Location where read data will be stored.
- * @return 0 in case of success, -1 otherwise.
+ * @return 0 in case of success, negative error code otherwise.
  */
 int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, data, NULL);
-#else
-	return uio_read_write(base, offset, data, NULL);
-#endif
+	volatile uint32_t *reg;
+	int32_t ret;
+
+	ret = axi_io_reg_get(base, offset, &reg);
+	if (ret)
+		return ret;
+
+	*data = *reg;
+
+	return 0;
 }
 
 /**
- * @brief AXI IO through UIO specific write function.
- * @param base - UIO index (/dev/uioX).
+ * @brief AXI IO through UIO/devmem write function.
+ * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
  * @param data - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @return 0 in case of success, negative error code otherwise.
  */
 int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, NULL, &data);
-#else
-	return uio_read_write(base, offset, NULL, &data);
-#endif
+	volatile uint32_t *reg;
+	int32_t ret;
+
+	ret = axi_io_reg_get(base, offset, &reg);
+	if (ret)
+		return ret;
+
+	*reg = data;
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem burst read function.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Offset of the first register.
+ * @param data - Array where the values of the registers will be stored.
+ * @param count - Number of consecutive registers to be read.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	volatile uint32_t *reg;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < count; i++) {
+		ret = axi_io_reg_get(base, offset + i * sizeof(*reg), &reg);
+		if (ret)
+			return ret;
+
+		data[i] = *reg;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem burst write function.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Offset of the first register.
+ * @param data - Values to be written to the registers.
+ * @param count - Number of consecutive registers to be written.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_write_burst(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	volatile uint32_t *reg;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < count; i++) {
+		ret = axi_io_reg_get(base, offset + i * sizeof(*reg), &reg);
+		if (ret)
+			return ret;
+
+		*reg = data[i];
+	}
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem batch function.
+ *
+ * The operations are run in order. The mapping is resolved once and only
+ * looked up again when an operation falls outside of it, and a single memory
+ * barrier makes all the accesses complete before returning. The batch stops
+ * at the first failing operation, the ones before it have already been
+ * applied.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param ops - Register operations, the read values are stored in place.
+ * @param num_ops - Number of operations.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_batch(uint32_t base, struct no_os_axi_io_op *ops,
+			   uint32_t num_ops)
+{
+	struct axi_io_window win = { 0 };
+	volatile uint32_t *reg;
+	uint32_t off;
+	uint32_t val;
+	uint32_t i;
+	int32_t ret = 0;
+
+	for (i = 0; i < num_ops; i++) {
+		off = ops[i].offset - win.offset;
+		if (!win.addr || off >= win.size) {
+			ret = axi_io_window_get(base, ops[i].offset, &win);
+			if (ret)
+				break;
+
+			off = ops[i].offset - win.offset;
+		}
+
+		if (off > win.size - sizeof(*reg) || (off & 0x3)) {
+			ret = -EINVAL;
+			break;
+		}
+
+		reg = (volatile uint32_t *)(win.addr + off);
+
+		switch (ops[i].op) {
+		case NO_OS_AXI_IO_READ:
+			ops[i].value = *reg;
+			break;
+		case NO_OS_AXI_IO_WRITE:
+			*reg = ops[i].value;
+			break;
+		case NO_OS_AXI_IO_UPDATE:
+			val = *reg;
+			val &= ~ops[i].mask;
+			val |= ops[i].value & ops[i].mask;
+			*reg = val;
+			break;
+		default:
+			ret = -EINVAL;
+			break;
+		}
+
+		if (ret)
+			break;
+	}
+
+	__sync_synchronize();
+
+	return ret;
 }
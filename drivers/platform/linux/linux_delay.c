@@ -32,7 +32,9 @@
 *******************************************************************************/
 
 #include <stdint.h>
+#include <time.h>
 #include <unistd.h>
+#include "no_os_delay.h"
 
 /**
  * @brief Generate microseconds delay.
@@ -51,3 +53,20 @@ void no_os_mdelay(uint32_t msecs)
 {
 	usleep(msecs * 1000);
 }
+
+/**
+ * @brief Get current time.
+ * @return Current time structure from an unspecified start point (seconds,
+ * microseconds), not affected by changes of the system time.
+ */
+struct no_os_time no_os_get_time(void)
+{
+	struct no_os_time t;
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	t.s = ts.tv_sec;
+	t.us = ts.tv_nsec / 1000;
+
+	return t;
+}
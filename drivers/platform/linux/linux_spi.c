@@ -39,12 +39,16 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <linux/spi/spidev.h>
 
 #warning SPI cs_delay_first and cs_delay_last delays are not supported on the linux platform
 
+/** Transfers with up to this many messages don't use the descriptor pool */
+#define LINUX_SPI_STACK_XFERS	4
+
 /**
  * @struct linux_spi_desc
  * @brief Linux platform specific SPI descriptor
@@ -52,6 +56,10 @@
 struct linux_spi_desc {
 	/** /dev/spidev"device_id"."chip_select" file descriptor */
 	int spidev_fd;
+	/** spi_ioc_transfer pool, reused by all the transfers */
+	struct spi_ioc_transfer *xfers;
+	/** Number of entries in the spi_ioc_transfer pool */
+	uint32_t xfers_cnt;
 };
 
 /**
@@ -78,6 +86,9 @@ int32_t linux_spi_init(struct no_os_spi_desc **desc,
 	if (!linux_desc)
 		goto free_desc;
 
+	linux_desc->xfers = NULL;
+	linux_desc->xfers_cnt = 0;
+
 	descriptor->extra = linux_desc;
 
 	snprintf(path, sizeof(path), "/dev/spidev%d.%d",
@@ -169,17 +180,60 @@ int32_t linux_spi_remove(struct no_os_spi_desc *desc)
 		return -1;
 	}
 
+	no_os_free(linux_desc->xfers);
 	no_os_free(desc->extra);
 	no_os_free(desc);
 
 	return 0;
 }
 
+/**
+ * @brief Get a spi_ioc_transfer array of at least the requested size from the
+ *	  descriptor pool. The pool grows geometrically and is never shrunk.
+ * @param linux_desc - The Linux SPI descriptor.
+ * @param len - Number of needed entries.
+ * @return Pointer to the array, or NULL if the pool could not be grown.
+ */
+static struct spi_ioc_transfer *linux_spi_xfers_get(struct linux_spi_desc
+		*linux_desc, uint32_t len)
+{
+	struct spi_ioc_transfer *xfers;
+	uint32_t cnt;
+
+	if (len <= linux_desc->xfers_cnt)
+		return linux_desc->xfers;
+
+	cnt = linux_desc->xfers_cnt ? linux_desc->xfers_cnt : LINUX_SPI_STACK_XFERS;
+	while (cnt < len)
+		cnt *= 2;
+
+	xfers = no_os_calloc_tag(cnt, sizeof(*xfers), NO_OS_ALLOC_TAG_DRIVER);
+	if (!xfers)
+		return NULL;
+
+	no_os_free(linux_desc->xfers);
+	linux_desc->xfers = xfers;
+	linux_desc->xfers_cnt = cnt;
+
+	return xfers;
+}
+
+/**
+ * @brief Transfer a list of messages in a single SPI_IOC_MESSAGE ioctl.
+ *
+ * Up to LINUX_SPI_STACK_XFERS messages are sent without touching the heap,
+ * longer lists use the spi_ioc_transfer pool of the descriptor.
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
 static int32_t linux_spi_transfer(struct no_os_spi_desc *desc,
 				  struct no_os_spi_msg *msgs,
 				  uint32_t len)
 
 {
+	struct spi_ioc_transfer	stack_tr[LINUX_SPI_STACK_XFERS];
 	struct spi_ioc_transfer *tr;
 	struct linux_spi_desc	*linux_desc;
 	int			ret;
@@ -187,10 +241,15 @@ static int32_t linux_spi_transfer(struct no_os_spi_desc *desc,
 
 	linux_desc = desc->extra;
 
-	tr = (struct spi_ioc_transfer *)no_os_calloc(len, sizeof(*tr));
-	if (!tr)
-		return -ENOMEM;
+	if (len <= LINUX_SPI_STACK_XFERS) {
+		tr = stack_tr;
+	} else {
+		tr = linux_spi_xfers_get(linux_desc, len);
+		if (!tr)
+			return -ENOMEM;
+	}
 
+	memset(tr, 0, len * sizeof(*tr));
 	for (i = 0; i < len; i++) {
 		tr[i].tx_buf = (unsigned long) msgs[i].tx_buff;
 		tr[i].rx_buf = (unsigned long) msgs[i].rx_buff;
@@ -200,9 +259,6 @@ static int32_t linux_spi_transfer(struct no_os_spi_desc *desc,
 	}
 
 	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(len), tr);
-
-	no_os_free(tr);
-
 	if (ret < 0) {
 		printf("%s: Can't send spi message (%d)\n\r", __func__, errno);
 		return ret;
@@ -260,7 +260,6 @@ static int32_t pico_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 			      uint32_t bytes_number)
 {
 	struct pico_uart_desc *pico_uart;
-	int ret;
 	uint32_t i;
 
 	if (!desc || !desc->extra || !data)
@@ -272,12 +271,8 @@ static int32_t pico_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 	pico_uart = desc->extra;
 
 	if (desc->rx_fifo) {
-		for (i = 0; i < bytes_number; i++) {
-			ret = lf256fifo_read(desc->rx_fifo, &data[i]);
-			if (ret)
-				return i ? (int32_t)i : -EAGAIN;
-		}
-		return i;
+		i = lf256fifo_read_bulk(desc->rx_fifo, data, bytes_number);
+		return i ? (int32_t)i : -EAGAIN;
 	}
 
 	uart_read_blocking(pico_uart->uart_instance, data, bytes_number);
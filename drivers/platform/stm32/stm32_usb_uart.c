@@ -257,18 +257,9 @@ static int32_t stm32_usb_uart_write(struct no_os_uart_desc *desc,
 static int32_t stm32_usb_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 				   uint32_t bytes_number)
 {
-	int ret;
-	unsigned int i = 0;
 	struct stm32_usb_uart_desc *sdesc = desc->extra;
 
-	while (i < bytes_number) {
-		ret = lf256fifo_read(sdesc->fifo, &data[i]);
-		if (ret)
-			break;
-		i++;
-	}
-
-	return i;
+	return lf256fifo_read_bulk(sdesc->fifo, data, bytes_number);
 }
 
 /**
@@ -33,6 +33,7 @@
 
 #include <xil_io.h>
 #include "no_os_error.h"
+#include "no_os_util.h"
 #include "no_os_axi_io.h"
 
 /**
@@ -63,3 +64,89 @@ int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 	return 0;
 }
 
+/**
+ * @brief AXI IO Xilinx specific burst read function.
+ * @param base - Base address
+ * @param offset - Offset of the first register
+ * @param data - array where the values of the registers are stored
+ * @param count - number of consecutive registers to be read
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		data[i] = Xil_In32(base + offset + i * sizeof(uint32_t));
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Xilinx specific burst write function.
+ * @param base - Base address
+ * @param offset - Offset of the first register
+ * @param data - values to be written to the registers
+ * @param count - number of consecutive registers to be written
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_write_burst(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		Xil_Out32(base + offset + i * sizeof(uint32_t), data[i]);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Xilinx specific batch function.
+ * @param base - Base address
+ * @param ops - register operations, the read values are stored in place
+ * @param num_ops - number of operations
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_batch(uint32_t base, struct no_os_axi_io_op *ops,
+			   uint32_t num_ops)
+{
+	uint32_t reg;
+	uint32_t i;
+
+	for (i = 0; i < num_ops; i++) {
+		switch (ops[i].op) {
+		case NO_OS_AXI_IO_READ:
+			ops[i].value = Xil_In32(base + ops[i].offset);
+			break;
+		case NO_OS_AXI_IO_WRITE:
+			Xil_Out32(base + ops[i].offset, ops[i].value);
+			break;
+		case NO_OS_AXI_IO_UPDATE:
+			reg = Xil_In32(base + ops[i].offset);
+			reg &= ~ops[i].mask;
+			reg |= ops[i].value & ops[i].mask;
+			Xil_Out32(base + ops[i].offset, reg);
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Xilinx specific wait for interrupt function, not supported.
+ * @param base - Base address
+ * @param timeout_us - maximum time to wait, in us
+ * @return -ENOSYS.
+ */
+int32_t no_os_axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(timeout_us);
+
+	return -ENOSYS;
+}
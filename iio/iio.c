@@ -62,6 +62,25 @@
 #define MAX_SOCKET_TO_HANDLE	10
 #define REG_ACCESS_ATTRIBUTE	"direct_reg_access"
 #define IIOD_CONN_BUFFER_SIZE	0x1000
+/*
+ * Maximum time iio_step sleeps waiting for socket events when the network
+ * interface supports it. Bounds the latency of asynchronous triggers and
+ * of the application post step callback.
+ */
+#ifndef IIO_NET_WAIT_TIMEOUT_MS
+#define IIO_NET_WAIT_TIMEOUT_MS	10
+#endif
+/*
+ * Same, while a connection transfers a buffer: the device has no socket event
+ * to wake iio_step up, so it is stepped again after this time at most.
+ */
+#ifndef IIO_NET_DEVICE_WAIT_TIMEOUT_MS
+#define IIO_NET_DEVICE_WAIT_TIMEOUT_MS	1
+#endif
+/* Maximum number of blocks of a device buffer. See iio_set_buffers_count() */
+#ifndef IIO_MAX_BUFFERS_COUNT
+#define IIO_MAX_BUFFERS_COUNT	16
+#endif
 #define NO_TRIGGER				(uint32_t)-1
 
 #define NO_OS_STRINGIFY(x) #x
@@ -145,6 +164,8 @@ struct iio_buffer_priv {
 	bool			initalized;
 	/* Set when no_os_calloc was used to initalize cb.buf */
 	bool			allocated;
+	/* Number of blocks to allocate the next time the buffer is opened */
+	uint32_t		buffers_count;
 };
 
 /**
@@ -189,6 +210,18 @@ struct iio_trig_priv {
 	bool	triggered;
 };
 
+/* Entry of the attribute index. See iio_init_attr_index() */
+struct iio_attr_entry {
+	/* Hash of device id, attribute type, channel id and attribute name */
+	uint32_t		hash;
+	enum iio_attr_type	type;
+	struct iio_dev_priv	*dev;
+	/* NULL for device, debug and buffer attributes */
+	struct iio_channel	*ch;
+	/* NULL for an empty slot */
+	struct iio_attribute	*attr;
+};
+
 struct iio_desc {
 	struct iiod_desc	*iiod;
 	struct iiod_ops		iiod_ops;
@@ -201,15 +234,25 @@ struct iio_desc {
 	uint32_t		nb_devs;
 	struct iio_trig_priv	*trigs;
 	uint32_t		nb_trigs;
+	/* Open addressed table of all device attributes, NULL if not built */
+	struct iio_attr_entry	*attr_index;
+	/* Number of entries of attr_index - 1. The size is a power of 2 */
+	uint32_t		attr_index_mask;
 	struct no_os_uart_desc	*uart_desc;
 	int (*recv)(void *conn, uint8_t *buf, uint32_t len);
 	int (*send)(void *conn, uint8_t *buf, uint32_t len);
 	/* FIFO for socket descriptors */
 	struct no_os_circular_buffer	*conns;
+#ifdef NO_OS_ALLOC_TRACE
+	/* Allocations done from iio_init() on, for the leak report */
+	uint32_t		alloc_mark;
+#endif
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
 	struct tcp_socket_desc	*current_sock;
 	/* Instance of server socket */
 	struct tcp_socket_desc	*server;
+	/* Client socket of each iiod connection, indexed by conn_id */
+	struct tcp_socket_desc	*conn_socks[IIOD_MAX_CONNECTIONS];
 #endif
 };
 
@@ -306,14 +349,103 @@ static inline struct iio_channel *iio_get_channel(const char *channel,
 static struct iio_dev_priv *get_iio_device(struct iio_desc *desc,
 		const char *device_name)
 {
+	const char *id;
+	char *end;
 	uint32_t i;
 
-	for (i = 0; i < desc->nb_devs; i++) {
-		if (strcmp(desc->devs[i].dev_id, device_name) == 0)
-			return &desc->devs[i];
-	}
+	/* Ids are "iio:device<index>", see iio_init_devs() */
+	if (strncmp(device_name, "iio:device", sizeof("iio:device") - 1))
+		return NULL;
 
-	return NULL;
+	id = device_name + sizeof("iio:device") - 1;
+	if (!isdigit((unsigned char)id[0]))
+		return NULL;
+
+	i = strtoul(id, &end, 10);
+	/* No leading zeros, sprintf wouldn't have generated them */
+	if (*end != '\0' || (id[0] == '0' && end != id + 1))
+		return NULL;
+
+	if (i >= desc->nb_devs)
+		return NULL;
+
+	return &desc->devs[i];
+}
+
+/* FNV-1a hash of str, including its null terminator */
+static uint32_t iio_hash_str(uint32_t hash, const char *str)
+{
+	do {
+		hash ^= (uint8_t)*str;
+		hash *= 16777619;
+	} while (*str++);
+
+	return hash;
+}
+
+static uint32_t iio_attr_hash(const char *dev_id, enum iio_attr_type type,
+			      const char *channel, const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	hash = iio_hash_str(hash, dev_id);
+	hash ^= type;
+	hash *= 16777619;
+	hash = iio_hash_str(hash, channel);
+
+	return iio_hash_str(hash, name);
+}
+
+/* Check if an index entry is the attribute with the given key */
+static bool iio_attr_entry_match(struct iio_attr_entry *entry,
+				 struct iio_dev_priv *dev,
+				 enum iio_attr_type type, const char *channel,
+				 const char *name)
+{
+	char ch_id[MAX_CHN_ID];
+
+	if (entry->dev != dev || entry->type != type ||
+	    strcmp(entry->attr->name, name))
+		return false;
+
+	if (!entry->ch)
+		return channel[0] == '\0';
+
+	_print_ch_id(ch_id, entry->ch);
+
+	return !strcmp(ch_id, channel);
+}
+
+/**
+ * @brief Look an attribute up in the attribute index.
+ * @param desc - IIO descriptor.
+ * @param dev - Device of the attribute.
+ * @param attr - Attribute to look for.
+ * @return Index entry of the attribute or NULL if it isn't indexed.
+ */
+static struct iio_attr_entry *iio_attr_index_find(struct iio_desc *desc,
+		struct iio_dev_priv *dev,
+		struct iiod_attr *attr)
+{
+	struct iio_attr_entry *entry;
+	uint32_t hash, i;
+
+	if (!desc->attr_index)
+		return NULL;
+
+	hash = iio_attr_hash(dev->dev_id, attr->type, attr->channel,
+			     attr->name);
+	for (i = hash & desc->attr_index_mask;;
+	     i = (i + 1) & desc->attr_index_mask) {
+		entry = &desc->attr_index[i];
+		if (!entry->attr)
+			return NULL;
+
+		if (entry->hash == hash &&
+		    iio_attr_entry_match(entry, dev, attr->type, attr->channel,
+					 attr->name))
+			return entry;
+	}
 }
 
 /**
@@ -346,16 +478,25 @@ static int iio_set_buffers_count(struct iiod_ctx *ctx, const char *device,
 				 uint32_t buffers_count)
 {
 	struct iio_desc *desc = ctx->instance;
+	struct iio_dev_priv *dev;
 
-	if (!get_iio_device(desc, device))
+	dev = get_iio_device(desc, device);
+	if (!dev)
 		return -ENODEV;
 
-	/* Our implementation uses a circular buffer to send/receive data so
-	 * only 1 is a valid value.
-	 */
-	if (buffers_count != 1)
+	if (!dev->buffer.initalized)
 		return -EINVAL;
 
+	if (!buffers_count || buffers_count > IIO_MAX_BUFFERS_COUNT)
+		return -EINVAL;
+
+	/*
+	 * The circular buffer is split in buffers_count blocks, so the device
+	 * can fill a block while the previous ones are being sent.
+	 * Takes effect the next time the buffer is opened.
+	 */
+	dev->buffer.buffers_count = buffers_count;
+
 	return 0;
 }
 
@@ -492,6 +633,44 @@ static int iio_rd_wr_attribute(struct attr_fun_params *params,
 	}
 }
 
+/**
+ * @brief Read/write an attribute found in the attribute index.
+ * @param entry - Index entry of the attribute.
+ * @param buf - Buffer for the value.
+ * @param len - Length of buf.
+ * @param is_write - Writes the attribute if true, reads it otherwise.
+ * @return Length of chars written/read or negative value in case of error.
+ */
+static int iio_rd_wr_attr_entry(struct iio_attr_entry *entry, char *buf,
+				uint32_t len, bool is_write)
+{
+	struct iio_ch_info ch_info;
+	struct iio_ch_info *info = NULL;
+
+	if (entry->ch) {
+		ch_info.ch_out = entry->ch->ch_out;
+		ch_info.ch_num = entry->ch->channel;
+		ch_info.type = entry->ch->ch_type;
+		ch_info.differential = entry->ch->diferential;
+		ch_info.address = entry->ch->address;
+		info = &ch_info;
+	}
+
+	if (is_write) {
+		if (!entry->attr->store)
+			return -ENOENT;
+
+		return entry->attr->store(entry->dev->dev_instance, buf, len,
+					  info, entry->attr->priv);
+	}
+
+	if (!entry->attr->show)
+		return -ENOENT;
+
+	return entry->attr->show(entry->dev->dev_instance, buf, len, info,
+				 entry->attr->priv);
+}
+
 /* Read a device register. The register address to read is set on
  * in desc->active_reg_addr in the function set_demo_reg_attr
  */
@@ -782,6 +961,7 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 {
 	struct iio_dev_priv *dev;
 	struct iio_trig_priv *trig_dev;
+	struct iio_attr_entry *entry;
 	struct iio_ch_info ch_info;
 	struct iio_channel *ch = NULL;
 	struct attr_fun_params params;
@@ -799,6 +979,12 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 			return -ENOENT;
 		}
 
+		if (attr->name[0] != '\0') {
+			entry = iio_attr_index_find(ctx->instance, dev, attr);
+			if (entry)
+				return iio_rd_wr_attr_entry(entry, buf, len, 0);
+		}
+
 		if (attr->channel[0] != '\0') {
 			ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
 			ch = iio_get_channel(attr->channel, dev->dev_descriptor,
@@ -857,6 +1043,7 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 {
 	struct iio_dev_priv	*dev;
 	struct iio_trig_priv *trig_dev;
+	struct iio_attr_entry	*entry;
 	struct attr_fun_params	params;
 	struct iio_attribute	*attributes;
 	struct iio_ch_info ch_info;
@@ -875,6 +1062,12 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 			return -ENOENT;
 		}
 
+		if (attr->name[0] != '\0') {
+			entry = iio_attr_index_find(ctx->instance, dev, attr);
+			if (entry)
+				return iio_rd_wr_attr_entry(entry, buf, len, 1);
+		}
+
 		if (attr->channel[0] != '\0') {
 			ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
 			ch = iio_get_channel(attr->channel, dev->dev_descriptor,
@@ -1101,27 +1294,39 @@ int iio_process_trigger_type(struct iio_desc *desc, char *trigger_name)
 	return 0;
 }
 
-static uint32_t bytes_per_scan(struct iio_channel *channels, uint32_t mask)
+/* Compute the scan size and fill layout with the active channels, if set */
+static uint32_t bytes_per_scan(struct iio_channel *channels,
+			       const uint32_t *mask, uint32_t num_ch,
+			       struct iio_scan_elem *layout)
 {
+	struct scan_type *type;
 	uint32_t cnt, i, length, largest = 1;
 
 	cnt = 0;
-	i = 0;
-	while (mask) {
-		if ((mask & 1)) {
-			length = channels[i].scan_type->storagebits / 8;
+	for (i = 0; i < num_ch; i++) {
+		if (no_os_test_bit(i, mask)) {
+			type = channels[i].scan_type;
+			length = type->storagebits / 8;
 
 			if (length > largest)
 				largest = length;
 
 			if (cnt % length)
-				cnt += 2 * length - (cnt % length);
-			else
-				cnt += length;
-		}
+				cnt += length - (cnt % length);
+
+			if (layout) {
+				layout->ch = i;
+				layout->offset = cnt;
+				layout->bytes = length;
+				layout->realbits = type->realbits;
+				layout->shift = type->shift;
+				layout->is_signed = type->sign == 's';
+				layout->is_big_endian = type->is_big_endian;
+				layout++;
+			}
 
-		mask >>= 1;
-		++i;
+			cnt += length;
+		}
 	}
 
 	if (cnt % largest)
@@ -1135,19 +1340,22 @@ static uint32_t bytes_per_scan(struct iio_channel *channels, uint32_t mask)
  * @param ctx - IIO instance and conn instance
  * @param device - String containing device name.
  * @param sample_size - Sample size.
- * @param mask - Channels to be opened.
+ * @param mask - Channels to be opened, IIO_CH_MASK_WORDS words.
  * @return 0, negative value in case of failure.
  */
 static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
-			uint32_t samples, uint32_t mask, bool cyclic)
+			uint32_t samples, const uint32_t *mask, bool cyclic)
 {
 	struct iio_desc *desc;
 	struct iio_dev_priv *dev;
 	struct iio_trig_priv *trig;
-	uint32_t ch_mask;
+	uint32_t *active;
+	uint32_t num_ch;
+	bool enabled;
 	int32_t ret;
 	int8_t *buf;
 	uint32_t buf_size;
+	uint32_t i;
 
 	dev = get_iio_device(ctx->instance, device);
 	if (!dev)
@@ -1156,19 +1364,47 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 	if (!dev->buffer.initalized)
 		return -EINVAL;
 
-	ch_mask = 0xFFFFFFFF >> (32 - dev->dev_descriptor->num_ch);
-	mask &= ch_mask;
-	if (!mask)
+	num_ch = dev->dev_descriptor->num_ch;
+	if (num_ch > IIO_MAX_CHANNELS)
+		return -EINVAL;
+
+	/* Drop the channels the device doesn't have */
+	active = dev->buffer.public.active_bitmap;
+	enabled = false;
+	for (i = 0; i < IIO_CH_MASK_WORDS; i++) {
+		if (num_ch >= 32 * (i + 1))
+			active[i] = mask[i];
+		else if (num_ch > 32 * i)
+			active[i] = mask[i] & (NO_OS_BIT(num_ch % 32) - 1);
+		else
+			active[i] = 0;
+		enabled |= active[i] != 0;
+	}
+	if (!enabled)
 		return -ENOENT;
 
 	dev->buffer.public.cyclic_info.is_cyclic = cyclic;
 	dev->buffer.public.cyclic_info.buff_index = 0;
 
-	dev->buffer.public.active_mask = mask;
+	/* Allocated once, the layout can't have more elements than channels */
+	if (!dev->buffer.public.scan_layout) {
+		dev->buffer.public.scan_layout = no_os_calloc(num_ch,
+						 sizeof(struct iio_scan_elem));
+		if (!dev->buffer.public.scan_layout)
+			return -ENOMEM;
+	}
+
+	dev->buffer.public.nb_scan_elems = 0;
+	for (i = 0; i < IIO_CH_MASK_WORDS; i++)
+		dev->buffer.public.nb_scan_elems += no_os_hweight32(active[i]);
+
+	dev->buffer.public.active_mask = active[0];
 	dev->buffer.public.bytes_per_scan =
-		bytes_per_scan(dev->dev_descriptor->channels, mask);
+		bytes_per_scan(dev->dev_descriptor->channels, active, num_ch,
+			       dev->buffer.public.scan_layout);
 	dev->buffer.public.size = dev->buffer.public.bytes_per_scan * samples;
 	dev->buffer.public.samples = samples;
+	dev->buffer.public.nb_pending = 0;
 	if (dev->buffer.raw_buf && dev->buffer.raw_buf_len) {
 		if (dev->buffer.raw_buf_len < dev->buffer.public.size)
 			/* Need a bigger buffer or to allocate */
@@ -1182,12 +1418,17 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 			no_os_free(dev->buffer.cb.buff);
 			dev->buffer.allocated = 0;
 		}
+		/* A cyclic buffer is a single block played in a loop */
 		buf_size = dev->buffer.public.size;
-		buf = (int8_t *)no_os_calloc(dev->buffer.public.size, sizeof(*buf));
+		if (!cyclic)
+			buf_size *= dev->buffer.buffers_count;
+		buf = (int8_t *)no_os_calloc_tag(buf_size, sizeof(*buf),
+						 NO_OS_ALLOC_TAG_IIO);
 		if (!buf)
 			return -ENOMEM;
 		dev->buffer.allocated = 1;
 	}
+	dev->buffer.public.nb_blocks = buf_size / dev->buffer.public.size;
 
 	ret = no_os_cb_cfg(&dev->buffer.cb, buf, buf_size);
 	if (NO_OS_IS_ERR_VALUE(ret)) {
@@ -1199,15 +1440,18 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 		return ret;
 	}
 
-	if (dev->dev_descriptor->pre_enable) {
-		ret = dev->dev_descriptor->pre_enable(dev->dev_instance, mask);
-		if (NO_OS_IS_ERR_VALUE(ret)) {
-			if (dev->buffer.allocated) {
-				no_os_free(dev->buffer.cb.buff);
-				dev->buffer.allocated = 0;
-			}
-			return ret;
+	if (dev->dev_descriptor->pre_enable_bitmap)
+		ret = dev->dev_descriptor->pre_enable_bitmap(dev->dev_instance,
+							     active);
+	else if (dev->dev_descriptor->pre_enable)
+		ret = dev->dev_descriptor->pre_enable(dev->dev_instance,
+						      active[0]);
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		if (dev->buffer.allocated) {
+			no_os_free(dev->buffer.cb.buff);
+			dev->buffer.allocated = 0;
 		}
+		return ret;
 	}
 
 	desc = ctx->instance;
@@ -1240,12 +1484,6 @@ static int iio_close_dev(struct iiod_ctx *ctx, const char *device)
 	if (!dev->buffer.initalized)
 		return -EINVAL;
 
-	if (dev->buffer.allocated) {
-		/* Should something else be used to free internal strucutre */
-		no_os_free(dev->buffer.cb.buff);
-		dev->buffer.allocated = 0;
-	}
-
 	desc = ctx->instance;
 	if (dev->trig_idx != NO_TRIGGER) {
 		trig = &desc->trigs[dev->trig_idx];
@@ -1257,9 +1495,19 @@ static int iio_close_dev(struct iiod_ctx *ctx, const char *device)
 	}
 
 	dev->buffer.public.active_mask = 0;
+	memset(dev->buffer.public.active_bitmap, 0,
+	       sizeof(dev->buffer.public.active_bitmap));
+	dev->buffer.public.nb_scan_elems = 0;
 	if (dev->dev_descriptor->post_disable)
 		ret = dev->dev_descriptor->post_disable(dev->dev_instance);
 
+	/* Freed once the device stopped, it may still write to the buffer */
+	if (dev->buffer.allocated) {
+		/* Should something else be used to free internal strucutre */
+		no_os_free(dev->buffer.cb.buff);
+		dev->buffer.allocated = 0;
+	}
+
 	return ret;
 }
 
@@ -1267,12 +1515,24 @@ static int iio_call_submit(struct iiod_ctx *ctx, const char *device,
 			   enum iio_buffer_direction dir)
 {
 	struct iio_dev_priv *dev;
+	uint32_t size;
+	int32_t ret;
 
 	dev = get_iio_device(ctx->instance, device);
 	if (!dev || !dev->buffer.initalized)
 		return -EINVAL;
 
 	dev->buffer.public.dir = dir;
+	/*
+	 * With more than one block the device may have filled blocks ahead of
+	 * the client. Only ask for more data when none is queued.
+	 */
+	if (dir == IIO_DIRECTION_INPUT && dev->buffer.public.nb_blocks > 1) {
+		ret = no_os_cb_size(&dev->buffer.cb, &size);
+		if (!NO_OS_IS_ERR_VALUE(ret) && size >= dev->buffer.public.size)
+			return 0;
+	}
+
 	if (dev->dev_descriptor->submit && dev->trig_idx == NO_TRIGGER)
 		return dev->dev_descriptor->submit(&dev->dev_data);
 	else if ((dir == IIO_DIRECTION_INPUT && dev->dev_descriptor->read_dev
@@ -1280,7 +1540,6 @@ static int iio_call_submit(struct iiod_ctx *ctx, const char *device,
 		 || (dir == IIO_DIRECTION_OUTPUT &&
 		     dev->dev_descriptor->write_dev && dev->trig_idx == NO_TRIGGER)) {
 		/* Code used to don't break devices using read_dev */
-		int32_t ret;
 		void *buff;
 		struct iio_buffer *buffer = &dev->buffer.public;
 
@@ -1294,8 +1553,11 @@ static int iio_call_submit(struct iiod_ctx *ctx, const char *device,
 		else
 			ret = dev->dev_descriptor->write_dev(dev->dev_instance,
 							     buff, buffer->samples);
-		if (NO_OS_IS_ERR_VALUE(ret))
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			/* Give the block back, it wasn't transferred */
+			buffer->nb_pending--;
 			return ret;
+		}
 
 		return iio_buffer_block_done(buffer);
 	}
@@ -1357,6 +1619,59 @@ static int iio_read_buffer(struct iiod_ctx *ctx, const char *device, char *buf,
 }
 
 
+/**
+ * @brief Get the first contiguous region of the available data of a buffer.
+ * @param device - String containing device name.
+ * @param buf - Address where to store the start of the region.
+ * @param bytes - Number of bytes that must be available.
+ * @return Size of the region or negative value in case of error.
+ */
+static int iio_get_buffer_region(struct iiod_ctx *ctx, const char *device,
+				 char **buf, uint32_t bytes)
+{
+	struct iio_dev_priv	*dev;
+	int32_t			ret;
+	uint32_t		size;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
+
+	ret = no_os_cb_size(&dev->buffer.cb, &size);
+#ifdef IIO_IGNORE_BUFF_OVERRUN_ERR
+	if (ret != -NO_OS_EOVERRUN)
+#endif
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+	bytes = no_os_min(bytes, dev->buffer.cb.size);
+	if (!bytes || size < bytes)
+		return -EAGAIN;
+
+	ret = no_os_cb_prepare_async_read(&dev->buffer.cb, bytes, (void **)buf,
+					  &size);
+	if (ret != -NO_OS_EOVERRUN && NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return size;
+}
+
+/**
+ * @brief Release the region returned by iio_get_buffer_region().
+ * @param device - String containing device name.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_release_buffer_region(struct iiod_ctx *ctx, const char *device)
+{
+	struct iio_dev_priv *dev;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
+
+	return no_os_cb_end_async_read(&dev->buffer.cb);
+}
+
 /**
  * @brief Write chunk of data into RAM.
  * @param device - String containing device name.
@@ -1381,7 +1696,7 @@ static int iio_write_buffer(struct iiod_ctx *ctx, const char *device,
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
 
-	available = dev->buffer.public.size - size;
+	available = dev->buffer.cb.size - size;
 	bytes = no_os_min(available, bytes);
 	ret = no_os_cb_write(&dev->buffer.cb, buf, bytes);
 	if (NO_OS_IS_ERR_VALUE(ret))
@@ -1392,26 +1707,89 @@ static int iio_write_buffer(struct iiod_ctx *ctx, const char *device,
 
 int iio_buffer_get_block(struct iio_buffer *buffer, void **addr)
 {
-	uint32_t size;
+	struct no_os_cb_ptr *ptr;
+	uint32_t idx, size;
+	int ret;
 
-	if (!buffer)
+	if (!buffer || !addr)
 		return -EINVAL;
 
-	if (buffer->dir == IIO_DIRECTION_INPUT)
-		return no_os_cb_prepare_async_write(buffer->buf, buffer->size, addr, &size);
+	if (buffer->nb_pending >= buffer->nb_blocks)
+		return -EBUSY;
+
+	ret = no_os_cb_size(buffer->buf, &size);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	/*
+	 * Input blocks are filled by the device and can't overwrite unread
+	 * scans, including the ones held by iio_get_buffer_region(). Output
+	 * blocks are consumed once filled.
+	 */
+	if (buffer->dir == IIO_DIRECTION_INPUT) {
+		ptr = &buffer->buf->write;
+		if (size + (buffer->nb_pending + 1) * buffer->size >
+		    buffer->buf->size)
+			return -EAGAIN;
+	} else {
+		ptr = &buffer->buf->read;
+		if (size < (buffer->nb_pending + 1) * buffer->size)
+			return -EAGAIN;
+	}
 
-	return no_os_cb_prepare_async_read(buffer->buf, buffer->size, addr, &size);
+	/* Blocks are handed out in order, after the pending ones */
+	idx = (ptr->idx + buffer->nb_pending * buffer->size) % buffer->buf->size;
+	if (idx % buffer->size) {
+		/*
+		 * Scans were pushed or popped since the last block. Blocks
+		 * restart at the beginning of the buffer once it is drained,
+		 * the unread scans can't be split.
+		 */
+		ret = no_os_cb_size(buffer->buf, &size);
+		if (ret || size || buffer->nb_pending)
+			return buffer->dir == IIO_DIRECTION_INPUT ? -EAGAIN :
+			       -EINVAL;
+
+		buffer->buf->read.idx = 0;
+		buffer->buf->write.idx = 0;
+		idx = 0;
+	}
+	if (idx + buffer->size > buffer->buf->size)
+		return -EINVAL;
+
+	*addr = buffer->buf->buff + idx;
+	buffer->nb_pending++;
+
+	return 0;
 }
 
 int iio_buffer_block_done(struct iio_buffer *buffer)
 {
-	if (!buffer)
+	uint32_t size;
+	void *addr;
+	int ret;
+
+	if (!buffer || !buffer->nb_pending)
 		return -EINVAL;
 
-	if (buffer->dir == IIO_DIRECTION_INPUT)
-		return no_os_cb_end_async_write(buffer->buf);
+	/* Blocks complete in the order they were handed out */
+	if (buffer->dir == IIO_DIRECTION_INPUT) {
+		ret = no_os_cb_prepare_async_write(buffer->buf, buffer->size,
+						   &addr, &size);
+		if (!NO_OS_IS_ERR_VALUE(ret))
+			ret = no_os_cb_end_async_write(buffer->buf);
+	} else {
+		ret = no_os_cb_prepare_async_read(buffer->buf, buffer->size,
+						  &addr, &size);
+		if (ret == -NO_OS_EOVERRUN || !NO_OS_IS_ERR_VALUE(ret))
+			ret = no_os_cb_end_async_read(buffer->buf);
+	}
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	buffer->nb_pending--;
 
-	return no_os_cb_end_async_read(buffer->buf);
+	return 0;
 }
 
 /* Write to buffer iio_buffer.bytes_per_scan bytes from data */
@@ -1441,6 +1819,105 @@ int iio_buffer_pop_scan(struct iio_buffer *buffer, void *data)
 	return ret;
 }
 
+/*
+ * Move up to nb_scans scans through the contiguous regions of the buffer,
+ * calling func on each region or copying from/to ctx if func is NULL.
+ */
+static int iio_buffer_xfer_scans(struct iio_buffer *buffer, uint32_t nb_scans,
+				 iio_scans_cb func, void *ctx, bool is_read)
+{
+	struct no_os_circular_buffer *cb;
+	uint32_t bytes_per_scan;
+	uint32_t done = 0;
+	uint32_t size;
+	uint32_t n;
+	void *addr;
+	int ret;
+
+	if (!buffer || !buffer->buf || !buffer->bytes_per_scan ||
+	    (!func && !ctx))
+		return -EINVAL;
+
+	cb = buffer->buf;
+	bytes_per_scan = buffer->bytes_per_scan;
+	/* A scan must never be split across the end of the buffer */
+	if (cb->size % bytes_per_scan)
+		return -EINVAL;
+
+	while (done < nb_scans) {
+		n = nb_scans - done;
+		if (is_read) {
+			/* Only whole scans are read */
+			ret = no_os_cb_size(cb, &size);
+			if (NO_OS_IS_ERR_VALUE(ret) && ret != -NO_OS_EOVERRUN)
+				return ret;
+			n = no_os_min(n, size / bytes_per_scan);
+			if (!n)
+				break;
+			ret = no_os_cb_prepare_async_read(cb, n * bytes_per_scan,
+							  &addr, &size);
+		} else {
+			ret = no_os_cb_prepare_async_write(cb, n * bytes_per_scan,
+							   &addr, &size);
+		}
+		if (ret == -EAGAIN)
+			break;
+		if (NO_OS_IS_ERR_VALUE(ret) && ret != -NO_OS_EOVERRUN)
+			return ret;
+
+		n = size / bytes_per_scan;
+		if (func) {
+			ret = func(ctx, addr, n);
+		} else {
+			/* Whole scans only, ctx holds nb_scans of them */
+			if (is_read)
+				memcpy((uint8_t *)ctx + done * bytes_per_scan, addr,
+				       n * bytes_per_scan);
+			else
+				memcpy(addr, (uint8_t *)ctx + done * bytes_per_scan,
+				       n * bytes_per_scan);
+			ret = 0;
+		}
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			/* Drop the region, nothing was transferred */
+			if (is_read)
+				no_os_cb_cancel_async_read(cb);
+			else
+				no_os_cb_cancel_async_write(cb);
+			return ret;
+		}
+
+		if (is_read) {
+			ret = no_os_cb_end_async_read(cb);
+			if (buffer->cyclic_info.is_cyclic &&
+			    cb->read.idx == cb->write.idx)
+				cb->read.idx = 0;
+		} else {
+			ret = no_os_cb_end_async_write(cb);
+		}
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		done += n;
+	}
+
+	return done;
+}
+
+/* Write nb_scans scans to buffer, filled in place by fill */
+int iio_buffer_push_scans(struct iio_buffer *buffer, uint32_t nb_scans,
+			  iio_scans_cb fill, void *ctx)
+{
+	return iio_buffer_xfer_scans(buffer, nb_scans, fill, ctx, false);
+}
+
+/* Read up to nb_scans scans from buffer, consumed in place by drain */
+int iio_buffer_pop_scans(struct iio_buffer *buffer, uint32_t nb_scans,
+			 iio_scans_cb drain, void *ctx)
+{
+	return iio_buffer_xfer_scans(buffer, nb_scans, drain, ctx, true);
+}
+
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
 
 static int32_t accept_network_clients(struct iio_desc *desc)
@@ -1456,7 +1933,8 @@ static int32_t accept_network_clients(struct iio_desc *desc)
 			return ret;
 
 		data.conn = sock;
-		data.buf = no_os_calloc(1, IIOD_CONN_BUFFER_SIZE);
+		data.buf = no_os_calloc_tag(1, IIOD_CONN_BUFFER_SIZE,
+					    NO_OS_ALLOC_TAG_NETWORK);
 		data.len = IIOD_CONN_BUFFER_SIZE;
 
 		if (!data.buf) {
@@ -1465,12 +1943,19 @@ static int32_t accept_network_clients(struct iio_desc *desc)
 		}
 
 		ret = iiod_conn_add(desc->iiod, &data, &id);
+		if (ret == -EBUSY) {
+			/* Connection pool is full, refuse the client */
+			no_os_free(data.buf);
+			socket_remove(sock);
+			continue;
+		}
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto free_buf;
 
 		ret = _push_conn(desc, id);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto remove_conn;
+		desc->conn_socks[id] = sock;
 	} while (true);
 
 	return 0;
@@ -1486,6 +1971,114 @@ close_socket:
 }
 #endif
 
+/**
+ * @brief Advance the state of a connection and requeue it.
+ * @param desc - IIO descriptor
+ * @param conn_id - Id of the connection, already popped from desc->conns
+ * @return Value returned by iiod_conn_step.
+ */
+static int32_t iio_conn_step(struct iio_desc *desc, uint32_t conn_id)
+{
+	struct iiod_conn_data data;
+	int32_t ret;
+
+	ret = iiod_conn_step(desc->iiod, conn_id);
+	if (ret == -ENOTCONN) {
+#if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
+		iiod_conn_remove(desc->iiod, conn_id, &data);
+		socket_remove(data.conn);
+		no_os_free(data.buf);
+		desc->conn_socks[conn_id] = NULL;
+#endif
+	} else {
+		_push_conn(desc, conn_id);
+	}
+
+	return ret;
+}
+
+#if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
+static bool iio_sock_is_ready(struct tcp_socket_desc *sock, uint32_t *ready,
+			      uint32_t nb_ready)
+{
+	uint32_t i;
+
+	if (!sock)
+		return false;
+
+	for (i = 0; i < nb_ready; i++)
+		if (ready[i] == sock->id)
+			return true;
+
+	return false;
+}
+
+/**
+ * @brief Event driven iio step.
+ *
+ * Sleeps until the server or a client socket is ready and then steps only the
+ * connections with pending socket events. Connections that wait for the IIO
+ * device (buffer transfers, cyclic buffers) are stepped on each call and
+ * shorten the wait to IIO_NET_DEVICE_WAIT_TIMEOUT_MS while they are active.
+ * @param desc - IIO descriptor
+ * @return 0 or -EAGAIN if no error occurred, -ENOSYS if the network interface
+ * can't wait for events, negative value otherwise.
+ */
+static int32_t iio_step_events(struct iio_desc *desc)
+{
+	uint32_t ready[IIOD_MAX_CONNECTIONS + 1];
+	uint32_t nb_ready, nb_conns, conn_id, i;
+	int32_t timeout = IIO_NET_WAIT_TIMEOUT_MS;
+	int32_t ret;
+
+	nb_conns = _nb_active_conns(desc);
+	for (i = 0; i < nb_conns; i++) {
+		_pop_conn(desc, &conn_id);
+		_push_conn(desc, conn_id);
+		switch (iiod_conn_get_wait(desc->iiod, conn_id)) {
+		case IIOD_WAIT_NONE:
+			timeout = 0;
+			break;
+		case IIOD_WAIT_DEVICE:
+			timeout = no_os_min(timeout, IIO_NET_DEVICE_WAIT_TIMEOUT_MS);
+			break;
+		default:
+			break;
+		}
+	}
+
+	nb_ready = NO_OS_ARRAY_SIZE(ready);
+	ret = socket_wait(desc->server, ready, &nb_ready, timeout);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	if (iio_sock_is_ready(desc->server, ready, nb_ready)) {
+		ret = accept_network_clients(desc);
+		if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN)
+			return ret;
+	}
+
+	ret = -EAGAIN;
+	nb_conns = _nb_active_conns(desc);
+	for (i = 0; i < nb_conns; i++) {
+		_pop_conn(desc, &conn_id);
+		if (iiod_conn_get_wait(desc->iiod, conn_id) == IIOD_WAIT_CONN &&
+		    !iio_sock_is_ready(desc->conn_socks[conn_id], ready,
+				       nb_ready)) {
+			_push_conn(desc, conn_id);
+			continue;
+		}
+
+		ret = iio_conn_step(desc, conn_id);
+		if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN &&
+		    ret != -ENOTCONN)
+			return ret;
+	}
+
+	return ret;
+}
+#endif
+
 /**
  * @brief Execute an iio step
  * @param desc - IIo descriptor
@@ -1493,13 +2086,18 @@ close_socket:
  */
 int iio_step(struct iio_desc *desc)
 {
-	struct iiod_conn_data data;
 	uint32_t conn_id;
 	int32_t ret;
 
 	iio_process_async_triggers(desc);
 
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
+	if (desc->server && desc->server->net->socket_wait) {
+		ret = iio_step_events(desc);
+		if (ret != -ENOSYS)
+			return ret;
+	}
+
 	if (desc->server) {
 		ret = accept_network_clients(desc);
 		if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN)
@@ -1514,18 +2112,7 @@ int iio_step(struct iio_desc *desc)
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
 
-	ret = iiod_conn_step(desc->iiod, conn_id);
-	if (ret == -ENOTCONN) {
-#if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
-		iiod_conn_remove(desc->iiod, conn_id, &data);
-		socket_remove(data.conn);
-		no_os_free(data.buf);
-#endif
-	} else {
-		_push_conn(desc, conn_id);
-	}
-
-	return ret;
+	return iio_conn_step(desc, conn_id);
 }
 
 /**
@@ -1824,6 +2411,7 @@ static int32_t iio_init_devs(struct iio_desc *desc,
 			ldev->buffer.raw_buf = ndev->raw_buf;
 			ldev->buffer.raw_buf_len = ndev->raw_buf_len;
 			ldev->buffer.public.buf = &ldev->buffer.cb;
+			ldev->buffer.buffers_count = 1;
 			ldev->buffer.initalized = 1;
 		} else {
 			ldev->buffer.initalized = 0;
@@ -1833,6 +2421,113 @@ static int32_t iio_init_devs(struct iio_desc *desc,
 	return 0;
 }
 
+/* Add the attributes of an attribute list to the attribute index */
+static uint32_t iio_attr_index_add(struct iio_desc *desc,
+				   struct iio_dev_priv *dev,
+				   enum iio_attr_type type,
+				   struct iio_channel *ch,
+				   struct iio_attribute *attributes)
+{
+	struct iio_attr_entry *entry;
+	char ch_id[MAX_CHN_ID] = "";
+	uint32_t hash, i, n;
+
+	if (!attributes)
+		return 0;
+
+	if (ch)
+		_print_ch_id(ch_id, ch);
+
+	for (n = 0; attributes[n].name; n++) {
+		if (!desc->attr_index)
+			continue;
+
+		hash = iio_attr_hash(dev->dev_id, type, ch_id,
+				     attributes[n].name);
+		for (i = hash & desc->attr_index_mask;;
+		     i = (i + 1) & desc->attr_index_mask) {
+			entry = &desc->attr_index[i];
+			/* Keep the first one of duplicated names, like lookups */
+			if (entry->hash == hash && entry->attr &&
+			    iio_attr_entry_match(entry, dev, type, ch_id,
+						 attributes[n].name))
+				break;
+
+			if (!entry->attr) {
+				entry->hash = hash;
+				entry->type = type;
+				entry->dev = dev;
+				entry->ch = ch;
+				entry->attr = &attributes[n];
+				break;
+			}
+		}
+	}
+
+	return n;
+}
+
+/* Add all the attributes of the devices to the attribute index */
+static uint32_t iio_attr_index_add_devs(struct iio_desc *desc)
+{
+	struct iio_device *dev_desc;
+	struct iio_channel *ch;
+	uint32_t i, j, n = 0;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		dev_desc = desc->devs[i].dev_descriptor;
+		n += iio_attr_index_add(desc, &desc->devs[i],
+					IIO_ATTR_TYPE_DEVICE, NULL,
+					dev_desc->attributes);
+		n += iio_attr_index_add(desc, &desc->devs[i],
+					IIO_ATTR_TYPE_DEBUG, NULL,
+					dev_desc->debug_attributes);
+		n += iio_attr_index_add(desc, &desc->devs[i],
+					IIO_ATTR_TYPE_BUFFER, NULL,
+					dev_desc->buffer_attributes);
+		for (j = 0; j < dev_desc->num_ch; j++) {
+			ch = &dev_desc->channels[j];
+			n += iio_attr_index_add(desc, &desc->devs[i],
+						ch->ch_out ?
+						IIO_ATTR_TYPE_CH_OUT :
+						IIO_ATTR_TYPE_CH_IN,
+						ch, ch->attributes);
+		}
+	}
+
+	return n;
+}
+
+/**
+ * @brief Build the attribute index used to resolve device attributes
+ * without searching the attribute lists.
+ *
+ * The index is an optimization: if it can't be allocated, attributes are
+ * resolved by searching the lists.
+ * @param desc - IIO descriptor.
+ */
+static void iio_init_attr_index(struct iio_desc *desc)
+{
+	uint32_t n, size;
+
+	/* First pass only counts the attributes */
+	n = iio_attr_index_add_devs(desc);
+	if (!n)
+		return;
+
+	/* Keep the load factor under 3/4 */
+	size = 1;
+	while (size < n + n / 3 + 1)
+		size <<= 1;
+
+	desc->attr_index = no_os_calloc(size, sizeof(*desc->attr_index));
+	if (!desc->attr_index)
+		return;
+
+	desc->attr_index_mask = size - 1;
+	iio_attr_index_add_devs(desc);
+}
+
 /**
  * @brief Initializes IIO triggers.
  * @param desc  - IIO descriptor.
@@ -1878,14 +2573,24 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	struct iiod_ops		*ops;
 	struct iiod_init_param	iiod_param;
 	uint32_t		conn_id;
+#ifdef NO_OS_ALLOC_TRACE
+	uint32_t		alloc_mark;
+#endif
 
 	if (!desc || !init_param)
 		return -EINVAL;
 
+#ifdef NO_OS_ALLOC_TRACE
+	alloc_mark = no_os_alloc_trace_mark();
+#endif
 	ldesc = (struct iio_desc *)no_os_calloc(1, sizeof(*ldesc));
 	if (!ldesc)
 		return -ENOMEM;
 
+#ifdef NO_OS_ALLOC_TRACE
+	ldesc->alloc_mark = alloc_mark;
+#endif
+
 	ldesc->ctx_attrs = init_param->ctx_attrs;
 	ldesc->nb_ctx_attr = init_param->nb_ctx_attr;
 
@@ -1897,9 +2602,13 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	if (NO_OS_IS_ERR_VALUE(ret))
 		goto free_desc;
 
-	ret = iio_init_xml(ldesc);
-	if (NO_OS_IS_ERR_VALUE(ret))
-		goto free_trigs;
+	iio_init_attr_index(ldesc);
+
+	if (!init_param->xml) {
+		ret = iio_init_xml(ldesc);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto free_trigs;
+	}
 
 	/* device operations */
 	ops = &ldesc->iiod_ops;
@@ -1908,6 +2617,8 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->get_trigger = iio_get_trigger;
 	ops->set_trigger = iio_set_trigger;
 	ops->read_buffer = iio_read_buffer;
+	ops->get_buffer_region = iio_get_buffer_region;
+	ops->release_buffer_region = iio_release_buffer_region;
 	ops->write_buffer = iio_write_buffer;
 	ops->refill_buffer = iio_refill_buffer;
 	ops->push_buffer = iio_push_buffer;
@@ -1919,8 +2630,15 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 
 	iiod_param.instance = ldesc;
 	iiod_param.ops = ops;
-	iiod_param.xml = ldesc->xml_desc;
-	iiod_param.xml_len = ldesc->xml_size;
+	if (init_param->xml) {
+		iiod_param.xml = (char *)init_param->xml;
+		iiod_param.xml_len = init_param->xml_len;
+	} else {
+		iiod_param.xml = ldesc->xml_desc;
+		iiod_param.xml_len = ldesc->xml_size;
+	}
+	iiod_param.zxml = init_param->zxml;
+	iiod_param.zxml_len = init_param->zxml_len;
 	iiod_param.phy_type = init_param->phy_type;
 
 	ret = iiod_init(&ldesc->iiod, &iiod_param);
@@ -1996,6 +2714,7 @@ free_iiod:
 free_xml:
 	no_os_free(ldesc->xml_desc);
 free_trigs:
+	no_os_free(ldesc->attr_index);
 	no_os_free(ldesc->trigs);
 free_devs:
 	no_os_free(ldesc->devs);
@@ -2013,13 +2732,17 @@ free_desc:
 int iio_remove(struct iio_desc *desc)
 {
 	struct iiod_conn_data data;
+#ifdef NO_OS_ALLOC_TRACE
+	uint32_t alloc_mark;
+#endif
+	uint32_t i;
 	int ret;
 
 	if (!desc)
 		return -EINVAL;
 
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING) || defined(NO_OS_W5500_NETWORKING)
-	for (int i = 0; i < IIOD_MAX_CONNECTIONS; i++) {
+	for (i = 0; i < IIOD_MAX_CONNECTIONS; i++) {
 		ret = iiod_conn_remove(desc->iiod, i, &data);
 		if (!ret) {
 			no_os_free(data.buf);
@@ -2030,10 +2753,24 @@ int iio_remove(struct iio_desc *desc)
 #endif
 	no_os_cb_remove(desc->conns);
 	iiod_remove(desc->iiod);
+	for (i = 0; i < desc->nb_devs; i++)
+		no_os_free(desc->devs[i].buffer.public.scan_layout);
+	no_os_free(desc->attr_index);
 	no_os_free(desc->devs);
 	no_os_free(desc->trigs);
 	no_os_free(desc->xml_desc);
+#ifdef NO_OS_ALLOC_TRACE
+	alloc_mark = desc->alloc_mark;
+#endif
 	no_os_free(desc);
 
+#ifdef NO_OS_ALLOC_TRACE
+	/*
+	 * Blocks of the drivers and of the application initialized after
+	 * iio_init() and still in use are reported too.
+	 */
+	no_os_alloc_trace_leaks(alloc_mark);
+#endif
+
 	return 0;
 }
@@ -108,6 +108,16 @@ struct iio_init_param {
 	uint32_t nb_devs;
 	struct iio_trigger_init *trigs;
 	uint32_t nb_trigs;
+	/*
+	 * Optional context XML generated offline, for example with
+	 * tools/scripts/iio_xml_blob.py. It is used instead of generating the
+	 * XML from the descriptors at init, so it must describe them.
+	 */
+	const char *xml;
+	uint32_t xml_len;
+	/* Optional zstd compressed context XML, sent to ZPRINT requests */
+	const uint8_t *zxml;
+	uint32_t zxml_len;
 };
 
 /* Set communication ops and read/write ops. */
@@ -129,9 +139,17 @@ int iio_format_value(char *buf, uint32_t len, enum iio_val fmt,
 		     int32_t size, int32_t *vals);
 
 /* DMA buffer functions. */
-/* Get buffer addr where to write iio_buffer.size bytes */
+/*
+ * Get buffer addr where to write iio_buffer.size bytes. Up to
+ * iio_buffer.nb_blocks blocks can be pending at the same time. Blocks are
+ * aligned on iio_buffer.size in the buffer: after scans were pushed, the next
+ * block is only available once the client read them all (-EAGAIN until
+ * then). On input, -EAGAIN is also returned while the block would overwrite
+ * scans the client did not read. On output, scans popped since the last
+ * block make it fail with -EINVAL, a device should not mix both.
+ */
 int iio_buffer_get_block(struct iio_buffer *buffer, void **addr);
-/* To be called to mark last iio_buffer_read as done */
+/* To be called to mark the oldest pending block as done */
 int iio_buffer_block_done(struct iio_buffer *buffer);
 
 /* Trigger buffer functions. */
@@ -140,4 +158,26 @@ int iio_buffer_push_scan(struct iio_buffer *buffer, void *data);
 /* Read from buffer iio_buffer.bytes_per_scan bytes into data */
 int iio_buffer_pop_scan(struct iio_buffer *buffer, void *data);
 
+/* Bulk trigger buffer functions. */
+/*
+ * Called with nb_scans contiguous scans of the buffer, to be filled on push
+ * or consumed on pop. Returns 0 or a negative error code, in which case the
+ * scans are not transferred.
+ */
+typedef int (*iio_scans_cb)(void *ctx, void *scans, uint32_t nb_scans);
+/*
+ * Write nb_scans scans to buffer. Each contiguous region of the buffer is
+ * passed to fill, or copied from ctx if fill is NULL. Returns the number of
+ * scans written or a negative error code.
+ */
+int iio_buffer_push_scans(struct iio_buffer *buffer, uint32_t nb_scans,
+			  iio_scans_cb fill, void *ctx);
+/*
+ * Read up to nb_scans of the available scans from buffer. Each contiguous
+ * region of the buffer is passed to drain, or copied to ctx if drain is NULL.
+ * Returns the number of scans read or a negative error code.
+ */
+int iio_buffer_pop_scans(struct iio_buffer *buffer, uint32_t nb_scans,
+			 iio_scans_cb drain, void *ctx);
+
 #endif /* IIO_H_ */
@@ -400,6 +400,10 @@ int iio_app_init(struct iio_app_desc **app,
 	iio_init_param.nb_trigs = app_init_param.nb_trigs;
 	iio_init_param.ctx_attrs = app_init_param.ctx_attrs;
 	iio_init_param.nb_ctx_attr = app_init_param.nb_ctx_attr;
+	iio_init_param.xml = app_init_param.xml;
+	iio_init_param.xml_len = app_init_param.xml_len;
+	iio_init_param.zxml = app_init_param.zxml;
+	iio_init_param.zxml_len = app_init_param.zxml_len;
 
 	status = iio_init(&application->iio_desc, &iio_init_param);
 	if (status < 0)
@@ -124,6 +124,14 @@ struct iio_app_init_param {
 	int (*post_step_callback)(void *arg);
 	/** Function parameteres */
 	void *arg;
+	/** Optional context XML generated offline, see iio_init_param */
+	const char *xml;
+	/** Length of xml */
+	uint32_t xml_len;
+	/** Optional zstd compressed context XML, see iio_init_param */
+	const uint8_t *zxml;
+	/** Length of zxml */
+	uint32_t zxml_len;
 
 #ifdef NO_OS_LWIP_NETWORKING
 	struct lwip_network_param lwip_param;
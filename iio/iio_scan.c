@@ -0,0 +1,723 @@
+/***************************************************************************//**
+ *   @file   iio_scan.c
+ *   @brief  Implementation of the IIO scan conversion kernels.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include "iio_scan.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define IIO_SCAN_VECTOR
+typedef __m128i iio_vec;
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define IIO_SCAN_VECTOR
+typedef uint32x4_t iio_vec;
+#endif
+
+/*
+ * Number of scans converted for all the channels before moving to the next
+ * ones in iio_buffer_demux() and iio_buffer_mux(), so that the scans are
+ * still cached when the next channel is converted.
+ */
+#ifndef IIO_SCAN_CHUNK
+#define IIO_SCAN_CHUNK	256
+#endif
+
+static int iio_scan_check(const struct iio_scan_elem *elem,
+			  uint32_t bytes_per_scan)
+{
+	if (!elem || !elem->bytes || elem->bytes > 8 || !elem->realbits ||
+	    elem->realbits + elem->shift > elem->bytes * 8 ||
+	    elem->offset + elem->bytes > bytes_per_scan)
+		return -EINVAL;
+
+	return 0;
+}
+
+/* Inline, unlike no_os_get_unaligned_*(), as it is called for each sample */
+static inline uint32_t iio_scan_ld(const uint8_t *p, uint32_t bytes, bool be)
+{
+	switch (bytes) {
+	case 1:
+		return p[0];
+	case 2:
+		if (be)
+			return (uint32_t)p[0] << 8 | p[1];
+		return (uint32_t)p[1] << 8 | p[0];
+	case 3:
+		if (be)
+			return (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+		return (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+	default:
+		if (be)
+			return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+			       (uint32_t)p[2] << 8 | p[3];
+		return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 |
+		       (uint32_t)p[1] << 8 | p[0];
+	}
+}
+
+static inline void iio_scan_st(uint8_t *p, uint32_t val, uint32_t bytes,
+			       bool be)
+{
+	switch (bytes) {
+	case 1:
+		p[0] = val;
+		break;
+	case 2:
+		p[be ? 0 : 1] = val >> 8;
+		p[be ? 1 : 0] = val;
+		break;
+	case 3:
+		p[be ? 0 : 2] = val >> 16;
+		p[1] = val >> 8;
+		p[be ? 2 : 0] = val;
+		break;
+	default:
+		p[be ? 0 : 3] = val >> 24;
+		p[be ? 1 : 2] = val >> 16;
+		p[be ? 2 : 1] = val >> 8;
+		p[be ? 3 : 0] = val;
+		break;
+	}
+}
+
+/*
+ * The format is known out of the loop, so each case gets a loop without
+ * branches that the compiler reduces to a load (and byte swap) and two shifts.
+ */
+#define IIO_SCAN_EXTRACT_LOOP(bytes, be) \
+	for (; i < nb_scans; i++, p += bytes_per_scan) \
+		samples[i] = ((int32_t)(iio_scan_ld(p, bytes, be) << l) >> r) & m
+
+#define IIO_SCAN_INSERT_LOOP(bytes, be) \
+	for (; i < nb_scans; i++, p += bytes_per_scan) \
+		iio_scan_st(p, ((uint32_t)samples[i] & m) << shift, bytes, be)
+
+#define IIO_SCAN_FORMAT(bytes, be)	((bytes) | ((be) << 3))
+
+static void iio_scan_extract_scalar(const struct iio_scan_elem *elem,
+				    uint32_t bytes_per_scan,
+				    const uint8_t *scans, int32_t *samples,
+				    uint32_t i, uint32_t nb_scans)
+{
+	const uint8_t *p = scans + i * bytes_per_scan + elem->offset;
+	/* Move the sample msb to bit 31 then sign extend it down to bit 0 */
+	uint32_t l = 32 - elem->realbits - elem->shift;
+	uint32_t r = 32 - elem->realbits;
+	uint32_t m = elem->is_signed ? 0xFFFFFFFF : 0xFFFFFFFF >> r;
+
+	switch (IIO_SCAN_FORMAT(elem->bytes, elem->is_big_endian)) {
+	case IIO_SCAN_FORMAT(1, false):
+	case IIO_SCAN_FORMAT(1, true):
+		IIO_SCAN_EXTRACT_LOOP(1, false);
+		break;
+	case IIO_SCAN_FORMAT(2, false):
+		IIO_SCAN_EXTRACT_LOOP(2, false);
+		break;
+	case IIO_SCAN_FORMAT(2, true):
+		IIO_SCAN_EXTRACT_LOOP(2, true);
+		break;
+	case IIO_SCAN_FORMAT(3, false):
+		IIO_SCAN_EXTRACT_LOOP(3, false);
+		break;
+	case IIO_SCAN_FORMAT(3, true):
+		IIO_SCAN_EXTRACT_LOOP(3, true);
+		break;
+	case IIO_SCAN_FORMAT(4, false):
+		IIO_SCAN_EXTRACT_LOOP(4, false);
+		break;
+	case IIO_SCAN_FORMAT(4, true):
+		IIO_SCAN_EXTRACT_LOOP(4, true);
+		break;
+	}
+}
+
+static void iio_scan_insert_scalar(const struct iio_scan_elem *elem,
+				   uint32_t bytes_per_scan, uint8_t *scans,
+				   const int32_t *samples, uint32_t i,
+				   uint32_t nb_scans)
+{
+	uint8_t *p = scans + i * bytes_per_scan + elem->offset;
+	uint32_t m = 0xFFFFFFFF >> (32 - elem->realbits);
+	uint32_t shift = elem->shift;
+
+	switch (IIO_SCAN_FORMAT(elem->bytes, elem->is_big_endian)) {
+	case IIO_SCAN_FORMAT(1, false):
+	case IIO_SCAN_FORMAT(1, true):
+		IIO_SCAN_INSERT_LOOP(1, false);
+		break;
+	case IIO_SCAN_FORMAT(2, false):
+		IIO_SCAN_INSERT_LOOP(2, false);
+		break;
+	case IIO_SCAN_FORMAT(2, true):
+		IIO_SCAN_INSERT_LOOP(2, true);
+		break;
+	case IIO_SCAN_FORMAT(3, false):
+		IIO_SCAN_INSERT_LOOP(3, false);
+		break;
+	case IIO_SCAN_FORMAT(3, true):
+		IIO_SCAN_INSERT_LOOP(3, true);
+		break;
+	case IIO_SCAN_FORMAT(4, false):
+		IIO_SCAN_INSERT_LOOP(4, false);
+		break;
+	case IIO_SCAN_FORMAT(4, true):
+		IIO_SCAN_INSERT_LOOP(4, true);
+		break;
+	}
+}
+
+static inline uint64_t iio_scan_ld_wide(const uint8_t *p, uint32_t bytes,
+					bool be)
+{
+	uint64_t val = 0;
+	uint32_t i;
+
+	for (i = 0; i < bytes; i++)
+		val |= (uint64_t)p[be ? i : bytes - 1 - i] << (8 * (bytes - 1 - i));
+
+	return val;
+}
+
+static inline void iio_scan_st_wide(uint8_t *p, uint64_t val, uint32_t bytes,
+				    bool be)
+{
+	uint32_t i;
+
+	for (i = 0; i < bytes; i++)
+		p[be ? bytes - 1 - i : i] = val >> (8 * i);
+}
+
+/*
+ * Storage of 5 to 8 bytes, such as 64 bit timestamps, only has a scalar
+ * kernel. Samples of more than 32 bits are truncated to their 32 lsbs.
+ */
+static void iio_scan_extract_wide(const struct iio_scan_elem *elem,
+				  uint32_t bytes_per_scan,
+				  const uint8_t *scans, int32_t *samples,
+				  uint32_t nb_scans)
+{
+	const uint8_t *p = scans + elem->offset;
+	uint32_t l = 64 - elem->realbits - elem->shift;
+	uint32_t r = 64 - elem->realbits;
+	uint64_t val;
+	uint32_t i;
+
+	for (i = 0; i < nb_scans; i++, p += bytes_per_scan) {
+		val = iio_scan_ld_wide(p, elem->bytes, elem->is_big_endian) << l;
+		if (elem->is_signed)
+			samples[i] = (int64_t)val >> r;
+		else
+			samples[i] = val >> r;
+	}
+}
+
+static void iio_scan_insert_wide(const struct iio_scan_elem *elem,
+				 uint32_t bytes_per_scan, uint8_t *scans,
+				 const int32_t *samples, uint32_t nb_scans)
+{
+	uint8_t *p = scans + elem->offset;
+	uint64_t m = 0xFFFFFFFFFFFFFFFFull >> (64 - elem->realbits);
+	uint64_t val;
+	uint32_t i;
+
+	for (i = 0; i < nb_scans; i++, p += bytes_per_scan) {
+		if (elem->is_signed)
+			val = (int64_t)samples[i];
+		else
+			val = (uint32_t)samples[i];
+		iio_scan_st_wide(p, (val & m) << elem->shift, elem->bytes,
+				 elem->is_big_endian);
+	}
+}
+
+#ifdef IIO_SCAN_VECTOR
+
+#if defined(__SSE2__)
+
+static inline iio_vec iio_vec_ld(const void *p)
+{
+	return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline void iio_vec_st(void *p, iio_vec x)
+{
+	_mm_storeu_si128((__m128i *)p, x);
+}
+
+static inline iio_vec iio_vec_dup(uint32_t val)
+{
+	return _mm_set1_epi32(val);
+}
+
+static inline iio_vec iio_vec_and(iio_vec x, iio_vec y)
+{
+	return _mm_and_si128(x, y);
+}
+
+static inline iio_vec iio_vec_or(iio_vec x, iio_vec y)
+{
+	return _mm_or_si128(x, y);
+}
+
+/* x & ~y */
+static inline iio_vec iio_vec_bic(iio_vec x, iio_vec y)
+{
+	return _mm_andnot_si128(y, x);
+}
+
+static inline iio_vec iio_vec_shl(iio_vec x, uint32_t n)
+{
+	return _mm_sll_epi32(x, _mm_cvtsi32_si128(n));
+}
+
+static inline iio_vec iio_vec_sar(iio_vec x, uint32_t n)
+{
+	return _mm_sra_epi32(x, _mm_cvtsi32_si128(n));
+}
+
+static inline iio_vec iio_vec_swap16(iio_vec x)
+{
+	return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static inline iio_vec iio_vec_swap32(iio_vec x)
+{
+	x = iio_vec_swap16(x);
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+
+	return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/* Word w of the 4 scans of 8 bytes at p */
+static inline iio_vec iio_vec_ld_word8(const uint8_t *p, uint32_t w)
+{
+	__m128 x = _mm_castsi128_ps(iio_vec_ld(p));
+	__m128 y = _mm_castsi128_ps(iio_vec_ld(p + 16));
+
+	if (w)
+		return _mm_castps_si128(_mm_shuffle_ps(x, y,
+						       _MM_SHUFFLE(3, 1, 3, 1)));
+
+	return _mm_castps_si128(_mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+/* The 16 bit words of x in the upper half of 32 bit words */
+static inline void iio_vec_widen16(iio_vec x, iio_vec *lo, iio_vec *hi)
+{
+	*lo = _mm_unpacklo_epi16(_mm_setzero_si128(), x);
+	*hi = _mm_unpackhi_epi16(_mm_setzero_si128(), x);
+}
+
+/* The lower half of the 32 bit words of lo and hi */
+static inline iio_vec iio_vec_narrow16(iio_vec lo, iio_vec hi)
+{
+	/* Sign extend so that the saturating pack keeps the values */
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+
+	return _mm_packs_epi32(lo, hi);
+}
+
+#else /* __ARM_NEON */
+
+static inline iio_vec iio_vec_ld(const void *p)
+{
+	return vreinterpretq_u32_u8(vld1q_u8((const uint8_t *)p));
+}
+
+static inline void iio_vec_st(void *p, iio_vec x)
+{
+	vst1q_u8((uint8_t *)p, vreinterpretq_u8_u32(x));
+}
+
+static inline iio_vec iio_vec_dup(uint32_t val)
+{
+	return vdupq_n_u32(val);
+}
+
+static inline iio_vec iio_vec_and(iio_vec x, iio_vec y)
+{
+	return vandq_u32(x, y);
+}
+
+static inline iio_vec iio_vec_or(iio_vec x, iio_vec y)
+{
+	return vorrq_u32(x, y);
+}
+
+/* x & ~y */
+static inline iio_vec iio_vec_bic(iio_vec x, iio_vec y)
+{
+	return vbicq_u32(x, y);
+}
+
+static inline iio_vec iio_vec_shl(iio_vec x, uint32_t n)
+{
+	return vshlq_u32(x, vdupq_n_s32(n));
+}
+
+static inline iio_vec iio_vec_sar(iio_vec x, uint32_t n)
+{
+	return vreinterpretq_u32_s32(vshlq_s32(vreinterpretq_s32_u32(x),
+					       vdupq_n_s32(-(int32_t)n)));
+}
+
+static inline iio_vec iio_vec_swap16(iio_vec x)
+{
+	return vreinterpretq_u32_u8(vrev16q_u8(vreinterpretq_u8_u32(x)));
+}
+
+static inline iio_vec iio_vec_swap32(iio_vec x)
+{
+	return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(x)));
+}
+
+/* Word w of the 4 scans of 8 bytes at p */
+static inline iio_vec iio_vec_ld_word8(const uint8_t *p, uint32_t w)
+{
+	/* Byte loads, vld2q_u32() would need p to be 32 bit aligned */
+	uint32x4x2_t x = vuzpq_u32(iio_vec_ld(p), iio_vec_ld(p + 16));
+
+	return w ? x.val[1] : x.val[0];
+}
+
+/* The 16 bit words of x in the upper half of 32 bit words */
+static inline void iio_vec_widen16(iio_vec x, iio_vec *lo, iio_vec *hi)
+{
+	uint16x8_t h = vreinterpretq_u16_u32(x);
+
+	*lo = vshll_n_u16(vget_low_u16(h), 16);
+	*hi = vshll_n_u16(vget_high_u16(h), 16);
+}
+
+/* The lower half of the 32 bit words of lo and hi */
+static inline iio_vec iio_vec_narrow16(iio_vec lo, iio_vec hi)
+{
+	return vreinterpretq_u32_u16(vcombine_u16(vmovn_u32(lo),
+					      vmovn_u32(hi)));
+}
+
+#endif
+
+/* Sample bits of a word as int32_t, see iio_scan_extract_scalar() */
+static inline iio_vec iio_vec_cvt(iio_vec x, uint32_t l, uint32_t r,
+				  iio_vec m)
+{
+	return iio_vec_and(iio_vec_sar(iio_vec_shl(x, l), r), m);
+}
+
+/* Returns the number of scans converted, the rest are left to the scalar code */
+static uint32_t iio_scan_extract_vector(const struct iio_scan_elem *elem,
+					uint32_t bytes_per_scan,
+					const uint8_t *scans, int32_t *samples,
+					uint32_t nb_scans)
+{
+	uint32_t b = elem->offset % 4;
+	uint32_t w = elem->offset / 4;
+	uint32_t r = 32 - elem->realbits;
+	uint32_t i, l, pos;
+	iio_vec x, y, m;
+
+	m = iio_vec_dup(elem->is_signed ? 0xFFFFFFFF : 0xFFFFFFFF >> r);
+
+	if (bytes_per_scan == 2) {
+		if (elem->bytes != 2)
+			return 0;
+
+		/* Converted from the upper half of the words */
+		l = 32 - 16 - elem->shift - elem->realbits;
+		for (i = 0; i + 8 <= nb_scans; i += 8) {
+			x = iio_vec_ld(scans + 2 * i);
+			if (elem->is_big_endian)
+				x = iio_vec_swap16(x);
+			iio_vec_widen16(x, &x, &y);
+			iio_vec_st(samples + i, iio_vec_cvt(x, l, r, m));
+			iio_vec_st(samples + i + 4, iio_vec_cvt(y, l, r, m));
+		}
+
+		return i;
+	}
+
+	if ((bytes_per_scan != 4 && bytes_per_scan != 8) || b + elem->bytes > 4)
+		return 0;
+
+	if (elem->is_big_endian)
+		pos = 8 * (4 - b - elem->bytes) + elem->shift;
+	else
+		pos = 8 * b + elem->shift;
+	l = 32 - pos - elem->realbits;
+
+	for (i = 0; i + 4 <= nb_scans; i += 4) {
+		if (bytes_per_scan == 4)
+			x = iio_vec_ld(scans + 4 * i);
+		else
+			x = iio_vec_ld_word8(scans + 8 * i, w);
+		if (elem->is_big_endian)
+			x = iio_vec_swap32(x);
+		iio_vec_st(samples + i, iio_vec_cvt(x, l, r, m));
+	}
+
+	return i;
+}
+
+/* Returns the number of scans converted, the rest are left to the scalar code */
+static uint32_t iio_scan_insert_vector(const struct iio_scan_elem *elem,
+				       uint32_t bytes_per_scan, uint8_t *scans,
+				       const int32_t *samples,
+				       uint32_t nb_scans)
+{
+	uint32_t b = elem->offset % 4;
+	uint32_t i, pos;
+	iio_vec x, y, m, keep;
+
+	m = iio_vec_dup(0xFFFFFFFF >> (32 - elem->realbits));
+
+	if (bytes_per_scan == 2) {
+		if (elem->bytes != 2)
+			return 0;
+
+		for (i = 0; i + 8 <= nb_scans; i += 8) {
+			x = iio_vec_and(iio_vec_ld(samples + i), m);
+			y = iio_vec_and(iio_vec_ld(samples + i + 4), m);
+			x = iio_vec_narrow16(iio_vec_shl(x, elem->shift),
+					     iio_vec_shl(y, elem->shift));
+			if (elem->is_big_endian)
+				x = iio_vec_swap16(x);
+			iio_vec_st(scans + 2 * i, x);
+		}
+
+		return i;
+	}
+
+	/* Words of the scans holding other channels are merged */
+	if (bytes_per_scan != 4 || b + elem->bytes > 4)
+		return 0;
+
+	if (elem->is_big_endian)
+		pos = 8 * (4 - b - elem->bytes);
+	else
+		pos = 8 * b;
+	keep = iio_vec_dup((0xFFFFFFFF >> (32 - 8 * elem->bytes)) << pos);
+	pos += elem->shift;
+
+	for (i = 0; i + 4 <= nb_scans; i += 4) {
+		x = iio_vec_ld(scans + 4 * i);
+		if (elem->is_big_endian)
+			x = iio_vec_swap32(x);
+		y = iio_vec_shl(iio_vec_and(iio_vec_ld(samples + i), m), pos);
+		x = iio_vec_or(iio_vec_bic(x, keep), y);
+		if (elem->is_big_endian)
+			x = iio_vec_swap32(x);
+		iio_vec_st(scans + 4 * i, x);
+	}
+
+	return i;
+}
+
+#else
+
+static uint32_t iio_scan_extract_vector(const struct iio_scan_elem *elem,
+					uint32_t bytes_per_scan,
+					const uint8_t *scans, int32_t *samples,
+					uint32_t nb_scans)
+{
+	return 0;
+}
+
+static uint32_t iio_scan_insert_vector(const struct iio_scan_elem *elem,
+				       uint32_t bytes_per_scan, uint8_t *scans,
+				       const int32_t *samples,
+				       uint32_t nb_scans)
+{
+	return 0;
+}
+
+#endif /* IIO_SCAN_VECTOR */
+
+/**
+ * @brief Extract the samples of a channel from interleaved scans.
+ * @param elem - Layout of the channel in the scans.
+ * @param bytes_per_scan - Size of a scan in bytes.
+ * @param scans - Interleaved scans.
+ * @param samples - Where to store nb_scans samples.
+ * @param nb_scans - Number of scans to convert.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_scan_extract(const struct iio_scan_elem *elem, uint32_t bytes_per_scan,
+		     const void *scans, int32_t *samples, uint32_t nb_scans)
+{
+	uint32_t i;
+	int ret;
+
+	ret = iio_scan_check(elem, bytes_per_scan);
+	if (ret)
+		return ret;
+
+	if (!nb_scans)
+		return 0;
+
+	if (!scans || !samples)
+		return -EINVAL;
+
+	if (elem->bytes > 4) {
+		iio_scan_extract_wide(elem, bytes_per_scan, scans, samples,
+				      nb_scans);
+		return 0;
+	}
+
+	i = iio_scan_extract_vector(elem, bytes_per_scan, scans, samples,
+				    nb_scans);
+	iio_scan_extract_scalar(elem, bytes_per_scan, scans, samples, i,
+				nb_scans);
+
+	return 0;
+}
+
+/**
+ * @brief Insert the samples of a channel in interleaved scans.
+ *
+ * Only the bytes of the channel are written in the scans, the padding bits
+ * of the sample are cleared.
+ * @param elem - Layout of the channel in the scans.
+ * @param bytes_per_scan - Size of a scan in bytes.
+ * @param scans - Interleaved scans.
+ * @param samples - nb_scans samples to insert.
+ * @param nb_scans - Number of scans to convert.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_scan_insert(const struct iio_scan_elem *elem, uint32_t bytes_per_scan,
+		    void *scans, const int32_t *samples, uint32_t nb_scans)
+{
+	uint32_t i;
+	int ret;
+
+	ret = iio_scan_check(elem, bytes_per_scan);
+	if (ret)
+		return ret;
+
+	if (!nb_scans)
+		return 0;
+
+	if (!scans || !samples)
+		return -EINVAL;
+
+	if (elem->bytes > 4) {
+		iio_scan_insert_wide(elem, bytes_per_scan, scans, samples,
+				     nb_scans);
+		return 0;
+	}
+
+	i = iio_scan_insert_vector(elem, bytes_per_scan, scans, samples,
+				   nb_scans);
+	iio_scan_insert_scalar(elem, bytes_per_scan, scans, samples, i,
+			       nb_scans);
+
+	return 0;
+}
+
+/**
+ * @brief Extract the active channels of an opened buffer.
+ * @param buffer - Buffer, its scan_layout gives the channels.
+ * @param scans - Interleaved scans.
+ * @param samples - One array of nb_scans samples per element of scan_layout.
+ * Channels with a NULL array are skipped.
+ * @param nb_scans - Number of scans to convert.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_buffer_demux(const struct iio_buffer *buffer, const void *scans,
+		     int32_t **samples, uint32_t nb_scans)
+{
+	const uint8_t *p = scans;
+	uint32_t i, j, n;
+	int ret;
+
+	if (!buffer || !samples || !buffer->nb_scan_elems)
+		return -EINVAL;
+
+	for (i = 0; i < nb_scans; i += n) {
+		n = no_os_min(nb_scans - i, IIO_SCAN_CHUNK);
+		for (j = 0; j < buffer->nb_scan_elems; j++) {
+			if (!samples[j])
+				continue;
+
+			ret = iio_scan_extract(&buffer->scan_layout[j],
+					       buffer->bytes_per_scan,
+					       p + i * buffer->bytes_per_scan,
+					       samples[j] + i, n);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Insert the active channels of an opened buffer.
+ * @param buffer - Buffer, its scan_layout gives the channels.
+ * @param scans - Interleaved scans.
+ * @param samples - One array of nb_scans samples per element of scan_layout.
+ * Channels with a NULL array are left unchanged in the scans.
+ * @param nb_scans - Number of scans to convert.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_buffer_mux(const struct iio_buffer *buffer, void *scans,
+		   int32_t *const *samples, uint32_t nb_scans)
+{
+	uint8_t *p = scans;
+	uint32_t i, j, n;
+	int ret;
+
+	if (!buffer || !samples || !buffer->nb_scan_elems)
+		return -EINVAL;
+
+	for (i = 0; i < nb_scans; i += n) {
+		n = no_os_min(nb_scans - i, IIO_SCAN_CHUNK);
+		for (j = 0; j < buffer->nb_scan_elems; j++) {
+			if (!samples[j])
+				continue;
+
+			ret = iio_scan_insert(&buffer->scan_layout[j],
+					      buffer->bytes_per_scan,
+					      p + i * buffer->bytes_per_scan,
+					      samples[j] + i, n);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
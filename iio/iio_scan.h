@@ -0,0 +1,68 @@
+/***************************************************************************//**
+ *   @file   iio_scan.h
+ *   @brief  Conversion of samples from and to IIO scans.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef IIO_SCAN_H_
+#define IIO_SCAN_H_
+
+#include <stdint.h>
+#include "iio_types.h"
+
+/*
+ * Samples are converted to and from int32_t values: the sample is byte
+ * swapped if big endian, shifted right by its shift and its realbits are
+ * sign extended if signed or zero extended otherwise. Unsigned samples of
+ * 32 bits should be read back as uint32_t.
+ *
+ * Storage of up to 8 bytes is supported, samples of more than 32 bits (such
+ * as 64 bit timestamps) are truncated to their 32 lsbs. Vector kernels (SSE2
+ * or NEON) are used when the scan is 2, 4 or 8 bytes long and the sample
+ * doesn't cross a 32 bit word of the scan, the scalar kernels are used
+ * otherwise and for the remaining scans. Scans don't need to be aligned.
+ */
+
+/* Extract the samples of a channel from nb_scans interleaved scans */
+int iio_scan_extract(const struct iio_scan_elem *elem, uint32_t bytes_per_scan,
+		     const void *scans, int32_t *samples, uint32_t nb_scans);
+
+/* Insert the samples of a channel in nb_scans interleaved scans */
+int iio_scan_insert(const struct iio_scan_elem *elem, uint32_t bytes_per_scan,
+		    void *scans, const int32_t *samples, uint32_t nb_scans);
+
+/* Extract all the active channels of a buffer from nb_scans scans */
+int iio_buffer_demux(const struct iio_buffer *buffer, const void *scans,
+		     int32_t **samples, uint32_t nb_scans);
+
+/* Insert all the active channels of a buffer in nb_scans scans */
+int iio_buffer_mux(const struct iio_buffer *buffer, void *scans,
+		   int32_t *const *samples, uint32_t nb_scans);
+
+#endif /* IIO_SCAN_H_ */
@@ -192,18 +192,59 @@ enum iio_buffer_direction {
 	IIO_DIRECTION_OUTPUT
 };
 
+/* Maximum number of channels of a device using a buffer */
+#ifndef IIO_MAX_CHANNELS
+#define IIO_MAX_CHANNELS	256
+#endif
+/* Number of 32 bit words of a channel mask */
+#define IIO_CH_MASK_WORDS	((IIO_MAX_CHANNELS + 31) / 32)
+
+/**
+ * @struct iio_scan_elem
+ * @brief Position and format of an active channel in a scan.
+ */
+struct iio_scan_elem {
+	/** Index of the channel in iio_device.channels */
+	uint16_t	ch;
+	/** Offset of the sample from the start of the scan, in bytes */
+	uint16_t	offset;
+	/** Storage size of the sample, in bytes */
+	uint8_t		bytes;
+	/** Number of valid bits of the sample */
+	uint8_t		realbits;
+	/** Shift right by this before masking out realbits */
+	uint8_t		shift;
+	/** True if the sample is signed */
+	bool		is_signed;
+	/** True if the sample is big endian */
+	bool		is_big_endian;
+};
+
 struct iio_cyclic_buffer_info {
 	bool is_cyclic;
 	uint32_t buff_index;
 };
 
 struct iio_buffer {
-	/* Mask with active channels */
+	/* Mask with active channels among the first 32 ones */
 	uint32_t active_mask;
+	/*
+	 * Mask with all active channels. Channel n is bit n % 32 of word
+	 * n / 32. Needed by devices with more than 32 channels.
+	 */
+	uint32_t active_bitmap[IIO_CH_MASK_WORDS];
 	/* Size in bytes */
 	uint32_t size;
 	/* Number of bytes per sample * number of active channels */
 	uint32_t bytes_per_scan;
+	/*
+	 * Layout of a scan, one element per active channel in scan order.
+	 * Computed when the buffer is opened, see iio_scan.h for the kernels
+	 * converting samples from and to this layout.
+	 */
+	struct iio_scan_elem *scan_layout;
+	/* Number of elements in scan_layout */
+	uint32_t nb_scan_elems;
 	/* Number of requested samples */
 	uint32_t samples;
 	/* Buffer direction */
@@ -212,6 +253,10 @@ struct iio_buffer {
 	struct no_os_circular_buffer *buf;
 	/* Stores cyclic buffer specific information */
 	struct iio_cyclic_buffer_info cyclic_info;
+	/* Number of blocks of size bytes in buf */
+	uint32_t nb_blocks;
+	/* Blocks returned by iio_buffer_get_block() and not done yet */
+	uint32_t nb_pending;
 };
 
 struct iio_device_data {
@@ -263,6 +308,12 @@ struct iio_device {
 	/* Bufer callbacks */
 	/** Called before enabling buffer */
 	int32_t (*pre_enable)(void *dev, uint32_t mask);
+	/**
+	 * Called before enabling buffer instead of pre_enable, with the mask of
+	 * all channels as in iio_buffer.active_bitmap. Needed by devices with
+	 * more than 32 channels.
+	 */
+	int32_t (*pre_enable_bitmap)(void *dev, const uint32_t *mask);
 	/** Called after disabling buffer */
 	int32_t (*post_disable)(void *dev);
 	/** Called when buffer ready to transfer. Write/read to/from dev */
@@ -40,6 +40,7 @@
 #include "iiod.h"
 #include "iiod_private.h"
 
+#include "no_os_alloc.h"
 #include "no_os_error.h"
 #include "no_os_util.h"
 
@@ -69,7 +70,10 @@ static struct iiod_str cmds[] = {
 	[IIOD_CMD_WRITEBUF]	= IIOD_STR("WRITEBUF"),
 	[IIOD_CMD_GETTRIG]	= IIOD_STR("GETTRIG"),
 	[IIOD_CMD_SETTRIG]	= IIOD_STR("SETTRIG"),
-	[IIOD_CMD_SET]		= IIOD_STR("SET")
+	[IIOD_CMD_SET]		= IIOD_STR("SET"),
+	[IIOD_CMD_BINARY]	= IIOD_STR("BINARY"),
+	[IIOD_CMD_ZPRINT]	= IIOD_STR("ZPRINT"),
+	[IIOD_CMD_ALLOCSTATS]	= IIOD_STR("ALLOCSTATS")
 };
 static const uint32_t priority_array[] = {
 	/* Order not tested, just personal expectation. Function can
@@ -87,7 +91,10 @@ static const uint32_t priority_array[] = {
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
 	IIOD_CMD_HELP,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_BINARY,
+	IIOD_CMD_ZPRINT,
+	IIOD_CMD_ALLOCSTATS
 };
 
 static_assert(NO_OS_ARRAY_SIZE(cmds) == NO_OS_ARRAY_SIZE(priority_array),
@@ -125,6 +132,38 @@ static int32_t parse_num(const char *token, uint32_t *res, uint32_t base)
 	return 0;
 }
 
+/*
+ * Parse a channel mask sent as hex digits, 8 for each 32 channels, with the
+ * highest channels first.
+ */
+static int32_t iiod_parse_mask(const char *token, struct comand_desc *res)
+{
+	uint32_t i, len;
+	char c;
+
+	len = strlen(token);
+	if (!len || len > IIO_CH_MASK_WORDS * 8)
+		return -EINVAL;
+
+	memset(res->mask, 0, sizeof(res->mask));
+	res->mask_words = NO_OS_DIV_ROUND_UP(len, 8);
+	for (i = 0; i < len; i++) {
+		c = token[len - 1 - i];
+		if (c >= '0' && c <= '9')
+			c -= '0';
+		else if (c >= 'a' && c <= 'f')
+			c -= 'a' - 10;
+		else if (c >= 'A' && c <= 'F')
+			c -= 'A' - 10;
+		else
+			return -EINVAL;
+
+		res->mask[i / 8] |= (uint32_t)c << (4 * (i % 8));
+	}
+
+	return 0;
+}
+
 static int32_t iiod_parse_open(const char *token, struct comand_desc *res,
 			       char **ctx)
 {
@@ -141,7 +180,7 @@ static int32_t iiod_parse_open(const char *token, struct comand_desc *res,
 	if (!token)
 		return -EINVAL;
 
-	ret = parse_num(token, &res->mask, 16);
+	ret = iiod_parse_mask(token, res);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
 
@@ -240,6 +279,9 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 	case IIOD_CMD_EXIT:
 	case IIOD_CMD_PRINT:
 	case IIOD_CMD_VERSION:
+	case IIOD_CMD_BINARY:
+	case IIOD_CMD_ZPRINT:
+	case IIOD_CMD_ALLOCSTATS:
 		return 0;
 	case IIOD_CMD_TIMEOUT:
 		return parse_num(token, &res->timeout, 10);
@@ -277,8 +319,253 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 	return -EINVAL;
 }
 
+/* Return true if tag starts with the element name */
+static bool iiod_xml_is_tag(const char *tag, const char *name)
+{
+	uint32_t len = strlen(name);
+
+	return !strncmp(tag, name, len) &&
+	       (tag[len] == ' ' || tag[len] == '>' || tag[len] == '/');
+}
+
+/* Find the value of the key="value" pair of the tag [start, end) */
+static bool iiod_xml_get(const char *xml, uint32_t start, uint32_t end,
+			 const char *key, struct iiod_xml_str *val)
+{
+	uint32_t len = strlen(key);
+	uint32_t i;
+
+	for (i = start; i + len + 2 < end; i++) {
+		if (xml[i] != ' ' || strncmp(xml + i + 1, key, len) ||
+		    xml[i + len + 1] != '=' || xml[i + len + 2] != '"')
+			continue;
+
+		val->off = i + len + 3;
+		val->len = 0;
+		while (val->off + val->len < end && xml[val->off + val->len] != '"')
+			val->len++;
+
+		return true;
+	}
+
+	return false;
+}
+
+/* Copy a string referenced in the XML to a null terminated buffer */
+static int32_t iiod_xml_copy(struct iiod_desc *desc, struct iiod_xml_str *str,
+			     char *dst, uint32_t size)
+{
+	if (str->len >= size)
+		return -ENAMETOOLONG;
+
+	memcpy(dst, desc->xml + str->off, str->len);
+	dst[str->len] = '\0';
+
+	return 0;
+}
+
+/* Append entry pos to list. Entries of a list must be contiguous */
+static int32_t iiod_xml_list_add(struct iiod_xml_list *list, uint32_t pos)
+{
+	if (!list->nb)
+		list->first = pos;
+	else if (list->first + list->nb != pos)
+		return -EINVAL;
+
+	list->nb++;
+
+	return 0;
+}
+
+/*
+ * Walk the XML and count its devices, channels and attributes. If the arrays
+ * of idx are allocated they are filled too.
+ */
+static int32_t iiod_xml_index_fill(struct iiod_desc *desc,
+				   struct iiod_xml_index *idx)
+{
+	struct iiod_xml_dev *dev = NULL;
+	struct iiod_xml_chn *chn = NULL;
+	struct iiod_xml_list *list;
+	struct iiod_xml_str str;
+	const char *xml = desc->xml;
+	const char *tag, *end;
+	bool fill = idx->devs != NULL;
+	uint32_t i, kind;
+	int32_t ret;
+
+	idx->nb_devs = 0;
+	idx->nb_chns = 0;
+	idx->nb_attrs = 0;
+	for (i = 0; i < desc->xml_len; i++) {
+		if (xml[i] != '<')
+			continue;
+
+		tag = xml + i + 1;
+		end = memchr(tag, '>', desc->xml_len - i - 1);
+		if (!end)
+			return -EINVAL;
+
+		if (iiod_xml_is_tag(tag, "device")) {
+			if (fill) {
+				dev = &idx->devs[idx->nb_devs];
+				iiod_xml_get(xml, i, end - xml, "id", &dev->id);
+				iiod_xml_get(xml, i, end - xml, "name",
+					     &dev->name);
+			}
+			idx->nb_devs++;
+		} else if (iiod_xml_is_tag(tag, "/device")) {
+			dev = NULL;
+		} else if (iiod_xml_is_tag(tag, "channel")) {
+			if (fill) {
+				if (!dev)
+					return -EINVAL;
+				chn = &idx->chns[idx->nb_chns];
+				iiod_xml_get(xml, i, end - xml, "id", &chn->id);
+				chn->output = iiod_xml_get(xml, i, end - xml,
+							   "type", &str) &&
+					      !strncmp(xml + str.off, "output",
+						       str.len);
+				ret = iiod_xml_list_add(&dev->chns,
+							idx->nb_chns);
+				if (NO_OS_IS_ERR_VALUE(ret))
+					return ret;
+				/* Channel without attributes */
+				if (*(end - 1) == '/')
+					chn = NULL;
+			}
+			idx->nb_chns++;
+		} else if (iiod_xml_is_tag(tag, "/channel")) {
+			chn = NULL;
+		} else if (iiod_xml_is_tag(tag, "scan-element")) {
+			/* Format is [be|le]:[s|u]bits/storagebits[>>shift] */
+			if (fill && chn && iiod_xml_get(xml, i, end - xml,
+							"format", &str)) {
+				tag = memchr(xml + str.off, '/', str.len);
+				if (tag)
+					chn->bytes = strtoul(tag + 1, NULL,
+							     10) / 8;
+			}
+		} else if (iiod_xml_is_tag(tag, "attribute") ||
+			   iiod_xml_is_tag(tag, "debug-attribute") ||
+			   iiod_xml_is_tag(tag, "buffer-attribute")) {
+			if (fill) {
+				if (!dev)
+					return -EINVAL;
+				if (*tag == 'd')
+					kind = IIOD_XML_DBG_ATTR;
+				else if (*tag == 'b')
+					kind = IIOD_XML_BUF_ATTR;
+				else
+					kind = IIOD_XML_DEV_ATTR;
+				list = chn ? &chn->attrs : &dev->attrs[kind];
+				iiod_xml_get(xml, i, end - xml, "name",
+					     &idx->attrs[idx->nb_attrs]);
+				ret = iiod_xml_list_add(list, idx->nb_attrs);
+				if (NO_OS_IS_ERR_VALUE(ret))
+					return ret;
+			}
+			idx->nb_attrs++;
+		}
+
+		i = end - xml;
+	}
+
+	return 0;
+}
+
+static void iiod_xml_index_free(struct iiod_xml_index *idx)
+{
+	if (!idx)
+		return;
+
+	no_os_free(idx->devs);
+	no_os_free(idx->chns);
+	no_os_free(idx->attrs);
+	no_os_free(idx);
+}
+
+/* Build the XML index used by the binary protocol, once */
+static int32_t iiod_xml_index_get(struct iiod_desc *desc)
+{
+	struct iiod_xml_index *idx;
+	int32_t ret;
+
+	if (desc->xml_index)
+		return 0;
+
+	if (!desc->xml)
+		return -EINVAL;
+
+	idx = no_os_calloc(1, sizeof(*idx));
+	if (!idx)
+		return -ENOMEM;
+
+	ret = iiod_xml_index_fill(desc, idx);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		goto error;
+
+	/* The device index is sent on 8 bits */
+	if (!idx->nb_devs || idx->nb_devs > UINT8_MAX + 1) {
+		ret = -EINVAL;
+		goto error;
+	}
+
+	idx->devs = no_os_calloc(idx->nb_devs, sizeof(*idx->devs));
+	idx->chns = no_os_calloc(no_os_max(idx->nb_chns, 1),
+				 sizeof(*idx->chns));
+	idx->attrs = no_os_calloc(no_os_max(idx->nb_attrs, 1),
+				  sizeof(*idx->attrs));
+	if (!idx->devs || !idx->chns || !idx->attrs) {
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	ret = iiod_xml_index_fill(desc, idx);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		goto error;
+
+	desc->xml_index = idx;
+
+	return 0;
+error:
+	iiod_xml_index_free(idx);
+
+	return ret;
+}
+
+/*
+ * Size of a scan of the enabled channels, aligning each sample to its size.
+ * Same layout as the one used by the IIO buffers.
+ */
+static uint32_t iiod_xml_scan_size(struct iiod_xml_index *idx,
+				   struct iiod_xml_dev *dev,
+				   const uint32_t *mask)
+{
+	uint32_t i, len, size = 0, largest = 1;
+
+	for (i = 0; i < dev->chns.nb && i < IIO_MAX_CHANNELS; i++) {
+		if (!no_os_test_bit(i, mask))
+			continue;
+
+		len = idx->chns[dev->chns.first + i].bytes;
+		if (!len)
+			continue;
+
+		largest = no_os_max(largest, len);
+		if (size % len)
+			size += len - (size % len);
+		size += len;
+	}
+
+	if (size % largest)
+		size += largest - (size % largest);
+
+	return size;
+}
+
 static int dummy_open(struct iiod_ctx *ctx, const char *device,
-		      uint32_t samples, uint32_t mask, bool cyclic)
+		      uint32_t samples, const uint32_t *mask, bool cyclic)
 {
 	return -EINVAL;
 }
@@ -340,6 +627,11 @@ int32_t iiod_copy_ops(struct iiod_ops *ops, struct iiod_ops *new_ops)
 					       dummy_close);
 	ops->push_buffer = SET_DUMMY_IF_NULL(new_ops->push_buffer,
 					     dummy_close);
+	/* Zero copy reads are used only if both callbacks are provided */
+	if (new_ops->get_buffer_region && new_ops->release_buffer_region) {
+		ops->get_buffer_region = new_ops->get_buffer_region;
+		ops->release_buffer_region = new_ops->release_buffer_region;
+	}
 
 	return 0;
 }
@@ -365,6 +657,8 @@ int32_t iiod_init(struct iiod_desc **desc, struct iiod_init_param *param)
 
 	ldesc->xml = param->xml;
 	ldesc->xml_len = param->xml_len;
+	ldesc->zxml = param->zxml;
+	ldesc->zxml_len = param->zxml_len;
 	ldesc->app_instance = param->instance;
 	ldesc->phy_type = param->phy_type;
 
@@ -375,6 +669,10 @@ int32_t iiod_init(struct iiod_desc **desc, struct iiod_init_param *param)
 
 void iiod_remove(struct iiod_desc *desc)
 {
+	if (!desc)
+		return;
+
+	iiod_xml_index_free(desc->xml_index);
 	free(desc);
 }
 
@@ -387,7 +685,30 @@ static void conn_clean_state(struct iiod_conn_priv *conn)
 	conn->res.buf.buf = NULL;
 	conn->res.buf.idx = 0;
 	conn->parser_idx = 0;
-	conn->state = IIOD_READING_LINE;
+	conn->bin_buf = NULL;
+	conn->bin_left = 0;
+	conn->state = conn->binary ? IIOD_BIN_READING_CMD : IIOD_READING_LINE;
+}
+
+/* Close the buffers left open by a binary connection */
+static void iiod_bin_close_buffers(struct iiod_desc *desc,
+				   struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_bin_buffer *buf;
+	char device[MAX_DEV_ID];
+	uint32_t i;
+
+	for (i = 0; i < IIOD_BIN_MAX_BUFFERS; i++) {
+		buf = &conn->bin_bufs[i];
+		if (!buf->used || !buf->opened)
+			continue;
+
+		if (!iiod_xml_copy(desc, &desc->xml_index->devs[buf->dev].id,
+				   device, sizeof(device)))
+			desc->ops.close(&ctx, device);
+		buf->opened = false;
+	}
 }
 
 int32_t iiod_conn_add(struct iiod_desc *desc, struct iiod_conn_data *data,
@@ -428,6 +749,8 @@ int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 		return -EINVAL;
 	struct iiod_conn_priv *conn;
 	conn = &desc->conns[conn_id];
+	if (conn->binary)
+		iiod_bin_close_buffers(desc, conn);
 	data->conn = conn->conn;
 	data->len = conn->payload_buf_len;
 	data->buf = conn->payload_buf;
@@ -461,6 +784,32 @@ static int32_t call_op(struct iiod_ops *ops, struct comand_desc *data,
 	return -EINVAL;
 }
 
+/*
+ * Receive data on conn. Bytes already buffered by iiod_read_line are consumed
+ * first, the rest is read directly from the connection.
+ */
+static int32_t iiod_recv(struct iiod_desc *desc, struct iiod_conn_priv *conn,
+			 uint8_t *buf, uint32_t len)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint32_t pending;
+	int32_t ret;
+
+	pending = no_os_min(conn->rx_len - conn->rx_idx, len);
+	if (pending) {
+		memcpy(buf, conn->rx_buf + conn->rx_idx, pending);
+		conn->rx_idx += pending;
+		if (pending == len)
+			return pending;
+	}
+
+	ret = desc->ops.recv(&ctx, buf + pending, len - pending);
+	if (pending && NO_OS_IS_ERR_VALUE(ret))
+		return pending;
+
+	return ret + pending;
+}
+
 /*
  * Unload data from buf without blocking.
  * When done will return 0, if there is still data to be sent it will return
@@ -480,7 +829,7 @@ static int32_t rw_iiod_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn,
 		if (flags & IIOD_WR)
 			ret = desc->ops.send(&ctx, tmp_buf, len);
 		else
-			ret = desc->ops.recv(&ctx, tmp_buf, len);
+			ret = iiod_recv(desc, conn, tmp_buf, len);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
@@ -501,6 +850,47 @@ static int32_t rw_iiod_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn,
 	return 0;
 }
 
+/*
+ * Send *left bytes of the opened buffer straight from the device memory, in
+ * regions of at most chunk bytes. A region is released only once it was
+ * completely sent, so the device can't overwrite data still being sent.
+ */
+static int32_t iiod_send_buffer_regions(struct iiod_desc *desc,
+					struct iiod_conn_priv *conn,
+					uint32_t *left, uint32_t chunk)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	int32_t ret;
+
+	while (*left) {
+		if (conn->nb_buf.idx == conn->nb_buf.len) {
+			ret = desc->ops.get_buffer_region(&ctx,
+							  conn->cmd_data.device,
+							  &conn->nb_buf.buf,
+							  no_os_min(*left, chunk));
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+
+			conn->nb_buf.idx = 0;
+			conn->nb_buf.len = ret;
+		}
+
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+		if (ret == -EAGAIN)
+			return ret;
+
+		desc->ops.release_buffer_region(&ctx, conn->cmd_data.device);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		*left -= conn->nb_buf.len;
+		conn->nb_buf.idx = 0;
+		conn->nb_buf.len = 0;
+	}
+
+	return 0;
+}
+
 static int32_t do_read_buff_delayed(struct iiod_desc *desc,
 				    struct iiod_conn_priv *conn)
 {
@@ -540,6 +930,12 @@ static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 	 * When using the network backend wait for a whole buffer to be filled
 	 * before sending in order to reduce the ammount of network traffic.
 	 */
+	if (desc->ops.get_buffer_region)
+		return iiod_send_buffer_regions(desc, conn,
+						&conn->cmd_data.bytes_count,
+						desc->phy_type == USE_NETWORK ?
+						conn->cmd_data.bytes_count :
+						conn->payload_buf_len);
 	if (desc->phy_type == USE_NETWORK)
 		return do_read_buff_delayed(desc, conn);
 
@@ -615,6 +1011,7 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		.name = data->attr,
 		.channel = data->channel
 	};
+	uint32_t i;
 	int32_t ret;
 
 	switch (data->cmd) {
@@ -625,7 +1022,8 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	case IIOD_CMD_SETTRIG:
 	case IIOD_CMD_SET:
 		if (data->cmd == IIOD_CMD_OPEN) {
-			conn->mask = data->mask;
+			memcpy(conn->mask, data->mask, sizeof(conn->mask));
+			conn->mask_words = data->mask_words;
 			if (data->cyclic)
 				conn->is_cyclic_buffer = true;
 		}
@@ -646,6 +1044,28 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		conn->res.buf.buf = desc->xml;
 		conn->res.buf.len = desc->xml_len;
 		break;
+	case IIOD_CMD_ZPRINT:
+		conn->res.write_val = 1;
+		/* Clients fall back to PRINT if no compressed XML is available */
+		if (!desc->zxml) {
+			conn->res.val = -ENOSYS;
+			break;
+		}
+		conn->res.val = desc->zxml_len;
+		conn->res.buf.buf = (char *)desc->zxml;
+		conn->res.buf.len = desc->zxml_len;
+		break;
+	case IIOD_CMD_ALLOCSTATS:
+		/* -ENOSYS unless built with NO_OS_ALLOC_TRACE */
+		ret = no_os_alloc_trace_dump(conn->payload_buf,
+					     conn->payload_buf_len);
+		conn->res.val = ret;
+		conn->res.write_val = 1;
+		if (!NO_OS_IS_ERR_VALUE(ret)) {
+			conn->res.buf.buf = conn->payload_buf;
+			conn->res.buf.len = ret;
+		}
+		break;
 	case IIOD_CMD_VERSION:
 		conn->res.buf.buf = IIOD_VERSION;
 		conn->res.buf.len = IIOD_VERSION_LEN;
@@ -684,14 +1104,23 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 			break;
 		}
 		conn->res.val = data->bytes_count;
-		ret = snprintf(conn->buf_mask, 10, "%08"PRIx32, conn->mask);
+		/* Same number of words as the mask of OPEN */
+		for (i = 0; i < conn->mask_words; i++)
+			snprintf(conn->buf_mask + 8 * i, 9, "%08"PRIx32,
+				 conn->mask[conn->mask_words - 1 - i]);
 		conn->res.buf.buf = conn->buf_mask;
-		conn->res.buf.len = ret;
+		conn->res.buf.len = 8 * conn->mask_words;
 		break;
 	case IIOD_CMD_WRITEBUF:
 		conn->res.val = data->bytes_count;
 		conn->res.write_val = 1;
 		break;
+	case IIOD_CMD_BINARY:
+		/* Following commands are binary once the result is sent */
+		conn->res.val = iiod_xml_index_get(desc);
+		conn->res.write_val = 1;
+		conn->binary = !conn->res.val;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -702,27 +1131,38 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 static int32_t iiod_read_line(struct iiod_desc *desc,
 			      struct iiod_conn_priv *conn)
 {
-	struct iiod_ctx ctx = {
-		.instance = desc->app_instance,
-		.conn = conn->conn
-	};
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint32_t chunk;
 	int32_t ret;
-	char *ch;
+	char ch;
 
+	/*
+	 * Only the network backend returns what is available without waiting
+	 * for the whole requested length. Keep reading byte by byte for the
+	 * other ones.
+	 */
+	chunk = desc->phy_type == USE_NETWORK ? sizeof(conn->rx_buf) : 1;
 	while (conn->parser_idx < IIOD_PARSER_MAX_BUF_SIZE - 1) {
-		ch = conn->parser_buf + conn->parser_idx;
-		ret = desc->ops.recv(&ctx, (uint8_t *)ch, 1);
-		if (ret == -EAGAIN || ret == 0)
-			return -EAGAIN;
+		if (conn->rx_idx == conn->rx_len) {
+			conn->rx_idx = 0;
+			conn->rx_len = 0;
+			ret = desc->ops.recv(&ctx, (uint8_t *)conn->rx_buf,
+					     chunk);
+			if (ret == -EAGAIN || ret == 0)
+				return -EAGAIN;
 
-		if (NO_OS_IS_ERR_VALUE(ret))
-			goto end;
+			if (NO_OS_IS_ERR_VALUE(ret))
+				goto end;
 
-		if (conn->parser_idx == 0 && (*ch == '\n' || *ch == '\r'))
+			conn->rx_len = ret;
+		}
+
+		ch = conn->rx_buf[conn->rx_idx++];
+		if (conn->parser_idx == 0 && (ch == '\n' || ch == '\r'))
 			continue ;
 
-		++conn->parser_idx;
-		if (*ch == '\n') {
+		conn->parser_buf[conn->parser_idx++] = ch;
+		if (ch == '\n') {
 			conn->parser_buf[conn->parser_idx] = '\0';
 			ret = 0;
 			goto end;
@@ -735,6 +1175,720 @@ end:
 	return ret;
 }
 
+static struct iiod_bin_buffer *iiod_bin_buffer_find(struct iiod_conn_priv *conn,
+		uint8_t dev, uint16_t id)
+{
+	uint32_t i;
+
+	for (i = 0; i < IIOD_BIN_MAX_BUFFERS; i++)
+		if (conn->bin_bufs[i].used && conn->bin_bufs[i].dev == dev &&
+		    conn->bin_bufs[i].id == id)
+			return &conn->bin_bufs[i];
+
+	return NULL;
+}
+
+static struct iiod_bin_block *iiod_bin_block_find(struct iiod_conn_priv *conn,
+		struct iiod_bin_buffer *buf, uint16_t id)
+{
+	uint32_t i;
+
+	for (i = 0; i < IIOD_BIN_MAX_BLOCKS; i++)
+		if (conn->bin_blocks[i].used && conn->bin_blocks[i].buf == buf &&
+		    conn->bin_blocks[i].id == id)
+			return &conn->bin_blocks[i];
+
+	return NULL;
+}
+
+/* Decode a 64 bit little endian length. Lengths above 32 bits are rejected */
+static int32_t iiod_bin_get_len(const char *buf, uint32_t *len)
+{
+	if (no_os_get_unaligned_le32((uint8_t *)buf + 4))
+		return -EFBIG;
+
+	*len = no_os_get_unaligned_le32((uint8_t *)buf);
+
+	return 0;
+}
+
+/* Size of the fixed size argument following a binary command */
+static int32_t iiod_bin_arg_len(struct iiod_desc *desc,
+				struct iiod_bin_cmd *cmd)
+{
+	struct iiod_xml_index *idx = desc->xml_index;
+
+	switch (cmd->op) {
+	case IIOD_BIN_OP_WRITE_ATTR:
+	case IIOD_BIN_OP_WRITE_DBG_ATTR:
+	case IIOD_BIN_OP_WRITE_BUF_ATTR:
+	case IIOD_BIN_OP_WRITE_CHN_ATTR:
+	case IIOD_BIN_OP_CREATE_BLOCK:
+	case IIOD_BIN_OP_TRANSFER_BLOCK:
+	case IIOD_BIN_OP_ENQUEUE_BLOCK_CYCLIC:
+		return IIOD_BIN_ARG_SIZE;
+	case IIOD_BIN_OP_CREATE_BUFFER:
+		/* The mask size depends on the number of channels */
+		if (cmd->dev >= idx->nb_devs)
+			return -ENODEV;
+
+		return sizeof(uint32_t) *
+		       NO_OS_DIV_ROUND_UP(idx->devs[cmd->dev].chns.nb, 32);
+	default:
+		return 0;
+	}
+}
+
+/* Index of the device with the given id or name */
+static int32_t iiod_bin_find_dev(struct iiod_desc *desc, const char *name,
+				 uint32_t len)
+{
+	struct iiod_xml_index *idx = desc->xml_index;
+	struct iiod_xml_dev *dev;
+	uint32_t i;
+
+	for (i = 0; i < idx->nb_devs; i++) {
+		dev = &idx->devs[i];
+		if ((dev->id.len == len &&
+		     !strncmp(desc->xml + dev->id.off, name, len)) ||
+		    (dev->name.len == len &&
+		     !strncmp(desc->xml + dev->name.off, name, len)))
+			return i;
+	}
+
+	return -ENODEV;
+}
+
+/* Fill attr with the attribute referenced by the binary command */
+static int32_t iiod_bin_get_attr(struct iiod_desc *desc,
+				 struct iiod_conn_priv *conn,
+				 struct iiod_attr *attr)
+{
+	struct iiod_xml_index *idx = desc->xml_index;
+	struct iiod_xml_dev *dev = &idx->devs[conn->bin_cmd.dev];
+	struct comand_desc *data = &conn->cmd_data;
+	uint32_t code = conn->bin_cmd.code;
+	struct iiod_xml_list *list;
+	struct iiod_xml_chn *chn;
+	uint32_t i = code;
+	int32_t ret;
+
+	data->channel[0] = '\0';
+	switch (conn->bin_cmd.op) {
+	case IIOD_BIN_OP_READ_ATTR:
+	case IIOD_BIN_OP_WRITE_ATTR:
+		attr->type = IIO_ATTR_TYPE_DEVICE;
+		list = &dev->attrs[IIOD_XML_DEV_ATTR];
+		break;
+	case IIOD_BIN_OP_READ_DBG_ATTR:
+	case IIOD_BIN_OP_WRITE_DBG_ATTR:
+		attr->type = IIO_ATTR_TYPE_DEBUG;
+		list = &dev->attrs[IIOD_XML_DBG_ATTR];
+		break;
+	case IIOD_BIN_OP_READ_BUF_ATTR:
+	case IIOD_BIN_OP_WRITE_BUF_ATTR:
+		/* Buffer attributes are shared by all the buffers */
+		attr->type = IIO_ATTR_TYPE_BUFFER;
+		list = &dev->attrs[IIOD_XML_BUF_ATTR];
+		i = code & 0xFFFF;
+		break;
+	default:
+		if ((code >> 16) >= dev->chns.nb)
+			return -ENOENT;
+
+		chn = &idx->chns[dev->chns.first + (code >> 16)];
+		ret = iiod_xml_copy(desc, &chn->id, data->channel,
+				    sizeof(data->channel));
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		attr->type = chn->output ? IIO_ATTR_TYPE_CH_OUT :
+			     IIO_ATTR_TYPE_CH_IN;
+		list = &chn->attrs;
+		i = code & 0xFFFF;
+		break;
+	}
+
+	if (i >= list->nb)
+		return -ENOENT;
+
+	attr->name = data->attr;
+	attr->channel = data->channel;
+
+	return iiod_xml_copy(desc, &idx->attrs[list->first + i], data->attr,
+			     sizeof(data->attr));
+}
+
+/* Execute the buffer and block management commands */
+static int32_t iiod_bin_buffer_cmd(struct iiod_desc *desc,
+				   struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_xml_index *idx = desc->xml_index;
+	struct iiod_bin_cmd *cmd = &conn->bin_cmd;
+	struct iiod_xml_dev *dev = &idx->devs[cmd->dev];
+	struct iiod_bin_buffer *buf;
+	struct iiod_bin_block *block;
+	uint32_t i, mask, len, first, last;
+	int32_t ret;
+
+	if (cmd->op == IIOD_BIN_OP_CREATE_BUFFER) {
+		if (iiod_bin_buffer_find(conn, cmd->dev, cmd->code))
+			return -EBUSY;
+
+		for (i = 0; i < IIOD_BIN_MAX_BUFFERS; i++)
+			if (!conn->bin_bufs[i].used)
+				break;
+		if (i == IIOD_BIN_MAX_BUFFERS)
+			return -ENOMEM;
+
+		buf = &conn->bin_bufs[i];
+		memset(buf, 0, sizeof(*buf));
+
+		/* Channels above IIO_MAX_CHANNELS can't be enabled */
+		len = conn->nb_buf.len;
+		first = dev->chns.nb;
+		for (i = 0; i < len / 4 && i < IIO_CH_MASK_WORDS; i++) {
+			mask = no_os_get_unaligned_le32((uint8_t *)
+							conn->payload_buf + 4 * i);
+			if (dev->chns.nb <= 32 * i)
+				mask = 0;
+			else if (dev->chns.nb < 32 * (i + 1))
+				mask &= NO_OS_BIT(dev->chns.nb % 32) - 1;
+			if (mask && first == dev->chns.nb)
+				first = 32 * i + no_os_find_first_set_bit(mask);
+			buf->mask[i] = mask;
+		}
+		if (first == dev->chns.nb)
+			return -EINVAL;
+
+		/* A buffer either captures or generates samples, not both */
+		buf->output = idx->chns[dev->chns.first + first].output;
+		last = no_os_min(dev->chns.nb, IIO_MAX_CHANNELS);
+		for (i = first + 1; i < last; i++)
+			if ((buf->mask[i / 32] >> (i % 32) & 1) &&
+			    idx->chns[dev->chns.first + i].output != buf->output)
+				return -EINVAL;
+
+		buf->used = true;
+		buf->dev = cmd->dev;
+		buf->id = cmd->code;
+
+		/* Return the mask of the channels that were enabled */
+		memset(conn->payload_buf, 0, len);
+		for (i = 0; i < len / 4 && i < IIO_CH_MASK_WORDS; i++)
+			no_os_put_unaligned_le32(buf->mask[i],
+						 (uint8_t *)conn->payload_buf +
+						 4 * i);
+		conn->res.buf.buf = conn->payload_buf;
+		conn->res.buf.len = len;
+
+		return len;
+	}
+
+	switch (cmd->op) {
+	case IIOD_BIN_OP_CREATE_BLOCK:
+	case IIOD_BIN_OP_FREE_BLOCK:
+		buf = iiod_bin_buffer_find(conn, cmd->dev,
+					   (uint32_t)cmd->code >> 16);
+		break;
+	default:
+		buf = iiod_bin_buffer_find(conn, cmd->dev, cmd->code);
+		break;
+	}
+	if (!buf)
+		return -ENOENT;
+
+	switch (cmd->op) {
+	case IIOD_BIN_OP_FREE_BUFFER:
+		for (i = 0; i < IIOD_BIN_MAX_BLOCKS; i++)
+			if (conn->bin_blocks[i].buf == buf)
+				conn->bin_blocks[i].used = false;
+	/* fall through */
+	case IIOD_BIN_OP_DISABLE_BUFFER:
+		ret = 0;
+		if (buf->opened)
+			ret = desc->ops.close(&ctx, conn->cmd_data.device);
+		buf->opened = false;
+		if (cmd->op == IIOD_BIN_OP_FREE_BUFFER)
+			buf->used = false;
+
+		return ret;
+	case IIOD_BIN_OP_ENABLE_BUFFER:
+		/* Opened by the first transfer, when the block size is known */
+		return 0;
+	case IIOD_BIN_OP_CREATE_BLOCK:
+		if (iiod_bin_block_find(conn, buf, cmd->code & 0xFFFF))
+			return -EBUSY;
+
+		ret = iiod_bin_get_len(conn->payload_buf, &len);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		if (!len)
+			return -EINVAL;
+
+		for (i = 0; i < IIOD_BIN_MAX_BLOCKS; i++)
+			if (!conn->bin_blocks[i].used)
+				break;
+		if (i == IIOD_BIN_MAX_BLOCKS)
+			return -ENOMEM;
+
+		block = &conn->bin_blocks[i];
+		block->used = true;
+		block->buf = buf;
+		block->id = cmd->code & 0xFFFF;
+		block->size = len;
+
+		return 0;
+	case IIOD_BIN_OP_FREE_BLOCK:
+		block = iiod_bin_block_find(conn, buf, cmd->code & 0xFFFF);
+		if (!block)
+			return -ENOENT;
+
+		block->used = false;
+
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+/*
+ * Prepare a block transfer. Sets conn->bin_buf when data has to be moved.
+ * Returns a negative value only when the command can't be framed.
+ */
+static int32_t iiod_bin_transfer(struct iiod_desc *desc,
+				 struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_xml_index *idx = desc->xml_index;
+	struct iiod_bin_cmd *cmd = &conn->bin_cmd;
+	bool cyclic = cmd->op == IIOD_BIN_OP_ENQUEUE_BLOCK_CYCLIC;
+	struct iiod_bin_buffer *buf;
+	uint32_t i, nb, size, scan;
+	int32_t ret = 0;
+
+	/* Without the buffer direction it is unknown if data follows */
+	buf = iiod_bin_buffer_find(conn, cmd->dev, (uint32_t)cmd->code >> 16);
+	if (!buf)
+		return -ENOTCONN;
+
+	if (!iiod_bin_block_find(conn, buf, cmd->code & 0xFFFF))
+		ret = -ENOENT;
+	else if (cyclic && !buf->output)
+		ret = -EINVAL;
+	else if (buf->opened && buf->cyclic != cyclic)
+		ret = -EBUSY;
+
+	if (!ret && !buf->opened) {
+		/* Open the buffer for the largest of its blocks */
+		size = 0;
+		nb = 0;
+		for (i = 0; i < IIOD_BIN_MAX_BLOCKS; i++)
+			if (conn->bin_blocks[i].used &&
+			    conn->bin_blocks[i].buf == buf) {
+				size = no_os_max(size,
+						 conn->bin_blocks[i].size);
+				nb++;
+			}
+
+		/*
+		 * Let the device queue as many blocks as the client does. Best
+		 * effort: the transfers work with a single block too.
+		 */
+		if (!cyclic)
+			desc->ops.set_buffers_count(&ctx, conn->cmd_data.device,
+						    nb);
+
+		scan = iiod_xml_scan_size(idx, &idx->devs[buf->dev], buf->mask);
+		if (!scan || size < scan) {
+			ret = -EINVAL;
+		} else {
+			ret = desc->ops.open(&ctx, conn->cmd_data.device,
+					     size / scan, buf->mask, cyclic);
+			if (!NO_OS_IS_ERR_VALUE(ret)) {
+				buf->opened = true;
+				buf->cyclic = cyclic;
+				buf->size = size / scan * scan;
+			}
+		}
+	}
+
+	if (!ret && conn->bin_left > buf->size)
+		ret = -EINVAL;
+
+	conn->res.val = ret;
+	/* Data of output blocks follows the command, consume it anyway */
+	if (buf->output) {
+		conn->bin_buf = buf;
+
+		return 0;
+	}
+
+	if (!ret)
+		ret = desc->ops.refill_buffer(&ctx, conn->cmd_data.device);
+
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		conn->res.val = ret;
+	} else {
+		conn->res.val = conn->bin_left;
+		conn->bin_buf = buf;
+	}
+
+	return 0;
+}
+
+static int32_t iiod_bin_run_cmd(struct iiod_desc *desc,
+				struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_xml_index *idx = desc->xml_index;
+	struct iiod_bin_cmd *cmd = &conn->bin_cmd;
+	struct comand_desc *data = &conn->cmd_data;
+	struct iiod_attr attr;
+	int32_t ret;
+
+	switch (cmd->op) {
+	case IIOD_BIN_OP_PRINT:
+		conn->res.val = desc->xml_len;
+		conn->res.buf.buf = desc->xml;
+		conn->res.buf.len = desc->xml_len;
+
+		return 0;
+	case IIOD_BIN_OP_TIMEOUT:
+		conn->res.val = desc->ops.set_timeout(&ctx, cmd->code);
+
+		return 0;
+	case IIOD_BIN_OP_RETRY_DEQUEUE_BLOCK:
+		/* Blocks are dequeued by the transfer command itself */
+		conn->res.val = 0;
+
+		return 0;
+	default:
+		break;
+	}
+
+	if (cmd->dev >= idx->nb_devs) {
+		conn->res.val = -ENODEV;
+
+		return 0;
+	}
+
+	ret = iiod_xml_copy(desc, &idx->devs[cmd->dev].id, data->device,
+			    sizeof(data->device));
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		conn->res.val = ret;
+
+		return 0;
+	}
+
+	switch (cmd->op) {
+	case IIOD_BIN_OP_READ_ATTR:
+	case IIOD_BIN_OP_READ_DBG_ATTR:
+	case IIOD_BIN_OP_READ_BUF_ATTR:
+	case IIOD_BIN_OP_READ_CHN_ATTR:
+		ret = iiod_bin_get_attr(desc, conn, &attr);
+		if (!NO_OS_IS_ERR_VALUE(ret))
+			ret = desc->ops.read_attr(&ctx, data->device, &attr,
+						  conn->payload_buf,
+						  conn->payload_buf_len);
+		conn->res.val = ret;
+		if (ret > 0) {
+			conn->res.buf.buf = conn->payload_buf;
+			conn->res.buf.len = ret;
+		}
+		break;
+	case IIOD_BIN_OP_WRITE_ATTR:
+	case IIOD_BIN_OP_WRITE_DBG_ATTR:
+	case IIOD_BIN_OP_WRITE_BUF_ATTR:
+	case IIOD_BIN_OP_WRITE_CHN_ATTR:
+		ret = iiod_bin_get_attr(desc, conn, &attr);
+		if (!NO_OS_IS_ERR_VALUE(ret))
+			ret = desc->ops.write_attr(&ctx, data->device, &attr,
+						   conn->payload_buf,
+						   conn->bin_left);
+		conn->res.val = ret;
+		conn->bin_left = 0;
+		break;
+	case IIOD_BIN_OP_GETTRIG:
+		ret = desc->ops.get_trigger(&ctx, data->device,
+					    conn->payload_buf,
+					    conn->payload_buf_len);
+		if (!ret)
+			ret = -ENOENT;
+		else if (ret > 0)
+			ret = iiod_bin_find_dev(desc, conn->payload_buf, ret);
+		conn->res.val = ret;
+		break;
+	case IIOD_BIN_OP_SETTRIG:
+		data->trigger[0] = '\0';
+		if (cmd->code >= 0) {
+			ret = -ENODEV;
+			if ((uint32_t)cmd->code < idx->nb_devs)
+				ret = iiod_xml_copy(desc,
+						    &idx->devs[cmd->code].id,
+						    data->trigger,
+						    sizeof(data->trigger));
+		}
+		if (!NO_OS_IS_ERR_VALUE(ret))
+			ret = desc->ops.set_trigger(&ctx, data->device,
+						    data->trigger,
+						    strlen(data->trigger));
+		conn->res.val = no_os_min(ret, 0);
+		break;
+	case IIOD_BIN_OP_CREATE_BUFFER:
+	case IIOD_BIN_OP_FREE_BUFFER:
+	case IIOD_BIN_OP_ENABLE_BUFFER:
+	case IIOD_BIN_OP_DISABLE_BUFFER:
+	case IIOD_BIN_OP_CREATE_BLOCK:
+	case IIOD_BIN_OP_FREE_BLOCK:
+		conn->res.val = iiod_bin_buffer_cmd(desc, conn);
+		break;
+	case IIOD_BIN_OP_TRANSFER_BLOCK:
+	case IIOD_BIN_OP_ENQUEUE_BLOCK_CYCLIC:
+		return iiod_bin_transfer(desc, conn);
+	default:
+		conn->res.val = -EINVAL;
+		break;
+	}
+
+	return 0;
+}
+
+/* Set the response header of the current binary command to be sent */
+static void iiod_bin_prepare_response(struct iiod_conn_priv *conn)
+{
+	no_os_put_unaligned_le16(conn->bin_cmd.client_id, conn->bin_hdr);
+	conn->bin_hdr[2] = IIOD_BIN_OP_RESPONSE;
+	conn->bin_hdr[3] = conn->bin_cmd.dev;
+	no_os_put_unaligned_le32(conn->res.val, conn->bin_hdr + 4);
+
+	conn->nb_buf.buf = (char *)conn->bin_hdr;
+	conn->nb_buf.idx = 0;
+	conn->nb_buf.len = IIOD_BIN_CMD_SIZE;
+	conn->state = IIOD_BIN_WRITING_RESPONSE;
+}
+
+/* Send an input block, after its response header, one chunk at a time */
+static int32_t iiod_bin_read_block(struct iiod_desc *desc,
+				   struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	int32_t ret;
+
+	if (desc->ops.get_buffer_region) {
+		ret = iiod_send_buffer_regions(desc, conn, &conn->bin_left,
+					       conn->bin_left);
+		if (ret == -EAGAIN)
+			return ret;
+		/* The data was announced in the response, drop the client */
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return -ENOTCONN;
+
+		conn->state = IIOD_LINE_DONE;
+
+		return 0;
+	}
+
+	if (conn->nb_buf.idx == conn->nb_buf.len) {
+		if (!conn->bin_left) {
+			conn->state = IIOD_LINE_DONE;
+
+			return 0;
+		}
+
+		ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
+					    conn->payload_buf,
+					    no_os_min(conn->payload_buf_len,
+						      conn->bin_left));
+		if (ret == -EAGAIN)
+			return ret;
+		/* The data was announced in the response, drop the client */
+		if (ret <= 0)
+			return -ENOTCONN;
+
+		conn->nb_buf.buf = conn->payload_buf;
+		conn->nb_buf.idx = 0;
+		conn->nb_buf.len = ret;
+		conn->bin_left -= ret;
+	}
+
+	return rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+}
+
+/* Receive an output block one chunk at a time, then push it */
+static int32_t iiod_bin_write_block(struct iiod_desc *desc,
+				    struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	int32_t ret;
+
+	if (conn->bin_left) {
+		if (!conn->nb_buf.len) {
+			conn->nb_buf.buf = conn->payload_buf;
+			conn->nb_buf.idx = 0;
+			conn->nb_buf.len = no_os_min(conn->payload_buf_len,
+						     conn->bin_left);
+		}
+
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_RD);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		/* On error the data is only drained from the connection */
+		if (!NO_OS_IS_ERR_VALUE((int32_t)conn->res.val)) {
+			ret = desc->ops.write_buffer(&ctx, conn->cmd_data.device,
+						     conn->nb_buf.buf,
+						     conn->nb_buf.len);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				conn->res.val = ret;
+		}
+
+		conn->bin_left -= conn->nb_buf.len;
+		conn->nb_buf.len = 0;
+		if (conn->bin_left)
+			return 0;
+	}
+
+	if (!NO_OS_IS_ERR_VALUE((int32_t)conn->res.val)) {
+		ret = desc->ops.push_buffer(&ctx, conn->cmd_data.device);
+		conn->res.val = NO_OS_IS_ERR_VALUE(ret) ? (uint32_t)ret :
+				conn->cmd_data.bytes_count;
+	}
+
+	conn->bin_buf = NULL;
+	iiod_bin_prepare_response(conn);
+
+	return 0;
+}
+
+/*
+ * Binary protocol equivalent of iiod_run_state. Commands are processed in
+ * order and each response carries the client_id of its command, so a client
+ * can have several commands in flight on the same connection.
+ */
+static int32_t iiod_bin_run_state(struct iiod_desc *desc,
+				  struct iiod_conn_priv *conn)
+{
+	struct iiod_bin_cmd *cmd = &conn->bin_cmd;
+	uint32_t len;
+	int32_t ret;
+
+	switch (conn->state) {
+	case IIOD_BIN_READING_CMD:
+		if (!conn->nb_buf.buf) {
+			conn->nb_buf.buf = (char *)conn->bin_hdr;
+			conn->nb_buf.idx = 0;
+			conn->nb_buf.len = IIOD_BIN_CMD_SIZE;
+		}
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_RD);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		cmd->client_id = no_os_get_unaligned_le16(conn->bin_hdr);
+		cmd->op = conn->bin_hdr[2];
+		cmd->dev = conn->bin_hdr[3];
+		cmd->code = no_os_get_unaligned_le32(conn->bin_hdr + 4);
+
+		/* Unknown argument size, the stream can't be parsed anymore */
+		ret = iiod_bin_arg_len(desc, cmd);
+		if (NO_OS_IS_ERR_VALUE(ret) || ret > (int32_t)conn->payload_buf_len)
+			return -ENOTCONN;
+
+		conn->nb_buf.buf = conn->payload_buf;
+		conn->nb_buf.idx = 0;
+		conn->nb_buf.len = ret;
+		conn->state = ret ? IIOD_BIN_READING_ARG : IIOD_BIN_RUNNING_CMD;
+
+		return 0;
+	case IIOD_BIN_READING_ARG:
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_RD);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		conn->state = IIOD_BIN_RUNNING_CMD;
+		switch (cmd->op) {
+		case IIOD_BIN_OP_WRITE_ATTR:
+		case IIOD_BIN_OP_WRITE_DBG_ATTR:
+		case IIOD_BIN_OP_WRITE_BUF_ATTR:
+		case IIOD_BIN_OP_WRITE_CHN_ATTR:
+			ret = iiod_bin_get_len(conn->payload_buf, &len);
+			/* The value must fit payload_buf with a '\0' */
+			if (NO_OS_IS_ERR_VALUE(ret) ||
+			    len >= conn->payload_buf_len)
+				return -ENOTCONN;
+
+			conn->bin_left = len;
+			conn->nb_buf.idx = 0;
+			conn->nb_buf.len = len;
+			conn->state = IIOD_BIN_READING_DATA;
+			break;
+		case IIOD_BIN_OP_TRANSFER_BLOCK:
+		case IIOD_BIN_OP_ENQUEUE_BLOCK_CYCLIC:
+			ret = iiod_bin_get_len(conn->payload_buf, &len);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return -ENOTCONN;
+
+			conn->bin_left = len;
+			conn->cmd_data.bytes_count = len;
+			break;
+		default:
+			break;
+		}
+
+		return 0;
+	case IIOD_BIN_READING_DATA:
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_RD);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		conn->payload_buf[conn->bin_left] = '\0';
+		conn->state = IIOD_BIN_RUNNING_CMD;
+
+		return 0;
+	case IIOD_BIN_RUNNING_CMD:
+		ret = iiod_bin_run_cmd(desc, conn);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		if (conn->bin_buf && conn->bin_buf->output) {
+			memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+			conn->state = IIOD_BIN_RW_BLOCK;
+		} else {
+			iiod_bin_prepare_response(conn);
+		}
+
+		return 0;
+	case IIOD_BIN_WRITING_RESPONSE:
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		if (conn->res.buf.buf) {
+			ret = rw_iiod_buff(desc, conn, &conn->res.buf, IIOD_WR);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+		}
+
+		if (conn->bin_buf) {
+			/* Input block data follows the response */
+			memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+			conn->state = IIOD_BIN_RW_BLOCK;
+		} else {
+			conn->state = IIOD_LINE_DONE;
+		}
+
+		return 0;
+	case IIOD_BIN_RW_BLOCK:
+		if (conn->bin_buf->output)
+			return iiod_bin_write_block(desc, conn);
+
+		return iiod_bin_read_block(desc, conn);
+	default:
+		return -EINVAL;
+	}
+}
+
 /*
  * Function will return SUCCESS when a state was processed.
  * If a state is still in processing state, it will return -EAGAIN.
@@ -895,6 +2049,13 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 			conn->is_cyclic_buffer = false;
 		}
 		return 0;
+	case IIOD_BIN_READING_CMD:
+	case IIOD_BIN_READING_ARG:
+	case IIOD_BIN_READING_DATA:
+	case IIOD_BIN_RUNNING_CMD:
+	case IIOD_BIN_WRITING_RESPONSE:
+	case IIOD_BIN_RW_BLOCK:
+		return iiod_bin_run_state(desc, conn);
 
 	default:
 		/* Should never get here */
@@ -925,3 +2086,35 @@ int32_t iiod_conn_step(struct iiod_desc *desc, uint32_t conn_id)
 
 	return ret;
 }
+
+enum iiod_conn_wait iiod_conn_get_wait(struct iiod_desc *desc,
+				       uint32_t conn_id)
+{
+	struct iiod_conn_priv *conn;
+
+	if (!desc || conn_id >= IIOD_MAX_CONNECTIONS ||
+	    !desc->conns[conn_id].used)
+		return IIOD_WAIT_NONE;
+
+	conn = &desc->conns[conn_id];
+	/* Buffered data is not reported by the connection anymore */
+	if (conn->rx_idx < conn->rx_len)
+		return IIOD_WAIT_NONE;
+
+	switch (conn->state) {
+	case IIOD_READING_LINE:
+	case IIOD_READING_WRITE_DATA:
+	case IIOD_WRITING_CMD_RESULT:
+	case IIOD_BIN_READING_CMD:
+	case IIOD_BIN_READING_ARG:
+	case IIOD_BIN_READING_DATA:
+	case IIOD_BIN_WRITING_RESPONSE:
+		return IIOD_WAIT_CONN;
+	case IIOD_RW_BUF:
+	case IIOD_PUSH_CYCLIC_BUFFER:
+	case IIOD_BIN_RW_BLOCK:
+		return IIOD_WAIT_DEVICE;
+	default:
+		return IIOD_WAIT_NONE;
+	}
+}
@@ -40,7 +40,9 @@
 #include "iio.h"
 
 /* Maximum nomber of iiod connections to allocate simultaneously */
+#ifndef IIOD_MAX_CONNECTIONS
 #define IIOD_MAX_CONNECTIONS	10
+#endif
 #define IIOD_VERSION		"1.1.0000000"
 #define IIOD_VERSION_LEN	(sizeof(IIOD_VERSION) - 1)
 
@@ -105,9 +107,11 @@ struct iiod_ops {
 	 * (depending on the internal buffer).
 	 * All calls with the same ctx will refer to this buffer until close is
 	 * called.
+	 * mask has IIO_CH_MASK_WORDS words, channel n is bit n % 32 of word
+	 * n / 32.
 	 */
 	int (*open)(struct iiod_ctx *ctx, const char *device, uint32_t samples,
-		    uint32_t mask, bool cyclic);
+		    const uint32_t *mask, bool cyclic);
 	/* Equivalent of iio_buffer_destroy */
 	int (*close)(struct iiod_ctx *ctx, const char *device);
 
@@ -116,6 +120,17 @@ struct iiod_ops {
 			   uint32_t bytes);
 	/* Called to notify that buffer must be refiiled */
 	int (*refill_buffer)(struct iiod_ctx *ctx, const char *device);
+	/*
+	 * Optional zero copy alternative to read_buffer. Once at least bytes
+	 * are available in the opened buffer, set buf to the address of the
+	 * first contiguous region of them and return its size. The region must
+	 * stay valid until release_buffer_region is called.
+	 * Return -EAGAIN if not enough data is available yet.
+	 */
+	int (*get_buffer_region)(struct iiod_ctx *ctx, const char *device,
+				 char **buf, uint32_t bytes);
+	/* Consume the region returned by get_buffer_region */
+	int (*release_buffer_region)(struct iiod_ctx *ctx, const char *device);
 
 	/* Write data to opened buffer */
 	int (*write_buffer)(struct iiod_ctx *ctx, const char *device,
@@ -156,6 +171,16 @@ struct iiod_ops {
  */
 struct iiod_desc;
 
+/* What a connection is waiting for, see iiod_conn_get_wait() */
+enum iiod_conn_wait {
+	/* Data to be received or sent on the connection */
+	IIOD_WAIT_CONN,
+	/* The IIO device, during buffer transfers */
+	IIOD_WAIT_DEVICE,
+	/* Nothing, the connection can be stepped right away */
+	IIOD_WAIT_NONE,
+};
+
 /* Parameter to initialize iiod_desc */
 struct iiod_init_param {
 	struct iiod_ops *ops;
@@ -168,6 +193,13 @@ struct iiod_init_param {
 	char *xml;
 	/* Size of xml in bytes */
 	uint32_t xml_len;
+	/*
+	 * Optional zstd compressed xml, sent to clients using the ZPRINT
+	 * command. It should exist until iiod_remove is called
+	 */
+	const uint8_t *zxml;
+	/* Size of zxml in bytes */
+	uint32_t zxml_len;
 	/* Backend used by IIOD */
 	enum physical_link_type phy_type;
 };
@@ -188,5 +220,11 @@ int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 			 struct iiod_conn_data *data);
 /* Advance in the state machine of a connection. Will not block */
 int32_t iiod_conn_step(struct iiod_desc *desc, uint32_t conn_id);
+/*
+ * Return what the connection needs before it can make progress. Used to
+ * decide how long to wait for socket events before stepping the connection.
+ */
+enum iiod_conn_wait iiod_conn_get_wait(struct iiod_desc *desc,
+				       uint32_t conn_id);
 
 #endif //IIOD_H
@@ -39,7 +39,18 @@
 #define IIOD_WR				0x1
 #define IIOD_ENDL			0x2
 #define IIOD_RD				0x4
-#define IIOD_PARSER_MAX_BUF_SIZE	128
+/* Room for an OPEN command with a mask of IIO_MAX_CHANNELS channels */
+#define IIOD_PARSER_MAX_BUF_SIZE	(128 + (IIO_CH_MASK_WORDS - 1) * 8)
+/* Bytes received at once while looking for the end of a command line */
+#define IIOD_RX_BUF_SIZE		256
+
+/* Size of a binary protocol command or response header on the wire */
+#define IIOD_BIN_CMD_SIZE		8
+/* Fixed size argument of the binary commands (64-bit length) */
+#define IIOD_BIN_ARG_SIZE		8
+/* Maximum number of buffers and blocks created by a binary connection */
+#define IIOD_BIN_MAX_BUFFERS		4
+#define IIOD_BIN_MAX_BLOCKS		8
 
 #define IIOD_STR(cmd) {(cmd), sizeof(cmd) - 1}
 
@@ -71,7 +82,140 @@ enum iiod_cmd {
 	IIOD_CMD_WRITEBUF,
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_BINARY,
+	IIOD_CMD_ZPRINT,
+	/* Not part of the iiod protocol, dumps no_os_alloc_trace_dump() */
+	IIOD_CMD_ALLOCSTATS
+};
+
+/*
+ * Opcodes of the binary protocol, selected with the BINARY command. Layout
+ * follows the libiio v1 binary protocol: devices, channels and attributes are
+ * referenced by their position in the XML description.
+ */
+enum iiod_bin_op {
+	IIOD_BIN_OP_RESPONSE,
+	IIOD_BIN_OP_PRINT,
+	IIOD_BIN_OP_TIMEOUT,
+	IIOD_BIN_OP_READ_ATTR,
+	IIOD_BIN_OP_READ_DBG_ATTR,
+	IIOD_BIN_OP_READ_BUF_ATTR,
+	IIOD_BIN_OP_READ_CHN_ATTR,
+	IIOD_BIN_OP_WRITE_ATTR,
+	IIOD_BIN_OP_WRITE_DBG_ATTR,
+	IIOD_BIN_OP_WRITE_BUF_ATTR,
+	IIOD_BIN_OP_WRITE_CHN_ATTR,
+	IIOD_BIN_OP_GETTRIG,
+	IIOD_BIN_OP_SETTRIG,
+	IIOD_BIN_OP_CREATE_BUFFER,
+	IIOD_BIN_OP_FREE_BUFFER,
+	IIOD_BIN_OP_ENABLE_BUFFER,
+	IIOD_BIN_OP_DISABLE_BUFFER,
+	IIOD_BIN_OP_CREATE_BLOCK,
+	IIOD_BIN_OP_FREE_BLOCK,
+	IIOD_BIN_OP_TRANSFER_BLOCK,
+	IIOD_BIN_OP_ENQUEUE_BLOCK_CYCLIC,
+	IIOD_BIN_OP_RETRY_DEQUEUE_BLOCK,
+};
+
+/*
+ * Binary command and response header. Sent as IIOD_BIN_CMD_SIZE little endian
+ * bytes. A response uses IIOD_BIN_OP_RESPONSE and the client_id of the
+ * command. A positive code in the response of a command returning data
+ * (PRINT, READ_*, CREATE_BUFFER, TRANSFER_BLOCK on input buffers) is the
+ * number of data bytes that follow it.
+ *
+ * Command arguments:
+ * - READ_ATTR, READ_DBG_ATTR: code is the attribute index.
+ * - READ_BUF_ATTR: code is (buffer << 16 | attribute index).
+ * - READ_CHN_ATTR: code is (channel index << 16 | attribute index).
+ * - WRITE_*: same codes, followed by a 64 bit length and the value.
+ * - SETTRIG: code is the trigger device index, negative to remove it.
+ * - CREATE_BUFFER: code is the buffer id, followed by the channel mask as
+ *   32 bit words, one for each 32 channels of the device.
+ * - FREE/ENABLE/DISABLE_BUFFER: code is the buffer id.
+ * - CREATE_BLOCK: code is (buffer id << 16 | block id), followed by the
+ *   64 bit block size.
+ * - FREE_BLOCK: code is (buffer id << 16 | block id).
+ * - TRANSFER_BLOCK, ENQUEUE_BLOCK_CYCLIC: same code, followed by the 64 bit
+ *   number of bytes used and, for output buffers, by the block data.
+ */
+struct iiod_bin_cmd {
+	uint16_t client_id;
+	uint8_t op;
+	uint8_t dev;
+	int32_t code;
+};
+
+/* Reference to a string inside the XML */
+struct iiod_xml_str {
+	uint32_t off;
+	uint32_t len;
+};
+
+/* Range of entries in one of the iiod_xml_index arrays */
+struct iiod_xml_list {
+	uint32_t first;
+	uint32_t nb;
+};
+
+enum iiod_xml_attr_kind {
+	IIOD_XML_DEV_ATTR,
+	IIOD_XML_DBG_ATTR,
+	IIOD_XML_BUF_ATTR,
+	IIOD_XML_NB_ATTR_KINDS
+};
+
+struct iiod_xml_chn {
+	struct iiod_xml_str id;
+	bool output;
+	/* Storage size of a sample in bytes. 0 if the channel can't be buffered */
+	uint8_t bytes;
+	struct iiod_xml_list attrs;
+};
+
+struct iiod_xml_dev {
+	struct iiod_xml_str id;
+	struct iiod_xml_str name;
+	struct iiod_xml_list chns;
+	struct iiod_xml_list attrs[IIOD_XML_NB_ATTR_KINDS];
+};
+
+/* Index of the XML elements, used to resolve binary protocol references */
+struct iiod_xml_index {
+	struct iiod_xml_dev *devs;
+	uint32_t nb_devs;
+	struct iiod_xml_chn *chns;
+	uint32_t nb_chns;
+	struct iiod_xml_str *attrs;
+	uint32_t nb_attrs;
+};
+
+/* Buffer created by a binary connection */
+struct iiod_bin_buffer {
+	bool used;
+	/* Device index and buffer id chosen by the client */
+	uint8_t dev;
+	uint16_t id;
+	uint32_t mask[IIO_CH_MASK_WORDS];
+	/* True if the enabled channels are output channels */
+	bool output;
+	/* Set once the buffer was opened with iiod_ops.open */
+	bool opened;
+	/* Opened for cyclic transfers */
+	bool cyclic;
+	/* Size in bytes of the opened buffer */
+	uint32_t size;
+};
+
+/* Block created by a binary connection */
+struct iiod_bin_block {
+	bool used;
+	/* Owner buffer */
+	struct iiod_bin_buffer *buf;
+	uint16_t id;
+	uint32_t size;
 };
 
 /*
@@ -80,7 +224,9 @@ enum iiod_cmd {
  */
 struct comand_desc {
 	enum iiod_cmd cmd;
-	uint32_t mask;
+	uint32_t mask[IIO_CH_MASK_WORDS];
+	/* Number of 32 bit words of the mask sent by the client */
+	uint32_t mask_words;
 	uint32_t timeout;
 	uint32_t sample_count;
 	uint32_t bytes_count;
@@ -136,12 +282,34 @@ struct iiod_conn_priv {
 		IIOD_LINE_DONE,
 		/* Pushing  cyclic buffer until IIO device is closed  */
 		IIOD_PUSH_CYCLIC_BUFFER,
+		/* Binary protocol: reading a command header */
+		IIOD_BIN_READING_CMD,
+		/* Binary protocol: reading the fixed size argument of a command */
+		IIOD_BIN_READING_ARG,
+		/* Binary protocol: reading the value of a write command */
+		IIOD_BIN_READING_DATA,
+		/* Binary protocol: execute cmd without I/O operations */
+		IIOD_BIN_RUNNING_CMD,
+		/* Binary protocol: writing the response header and data */
+		IIOD_BIN_WRITING_RESPONSE,
+		/* Binary protocol: moving block data between conn and device */
+		IIOD_BIN_RW_BLOCK,
 	} state;
 
 	/* Buffer to store received line */
 	char parser_buf[IIOD_PARSER_MAX_BUF_SIZE];
 	/* Index in parser_buf. For nonblocking operation */
 	uint32_t parser_idx;
+	/*
+	 * Data received from the connection but not consumed yet. Filled by
+	 * iiod_read_line, bytes following the command line are used for the
+	 * next command or for the WRITE/WRITEBUF payload.
+	 */
+	char rx_buf[IIOD_RX_BUF_SIZE];
+	/* Index of the first unconsumed byte in rx_buf */
+	uint32_t rx_idx;
+	/* Number of valid bytes in rx_buf */
+	uint32_t rx_len;
 	/* Buffer to store raw data (attributes or buffer data).*/
 	char *payload_buf;
 	/* Length of payload_buf_len */
@@ -150,13 +318,29 @@ struct iiod_conn_priv {
 	struct iiod_buff nb_buf;
 
 	/* Mask of current opened buffer */
-	uint32_t mask;
+	uint32_t mask[IIO_CH_MASK_WORDS];
+	/* Number of 32 bit words of mask, as sent by the client */
+	uint32_t mask_words;
 	/* Buffer to store mask as a string */
-	char buf_mask[10];
+	char buf_mask[IIO_CH_MASK_WORDS * 8 + 1];
 	/* Context for strtok_r function */
 	char *strtok_ctx;
 	/* True if the device was open with cyclic buffer flag */
 	bool is_cyclic_buffer;
+
+	/* Set after the BINARY command, commands are then iiod_bin_cmd */
+	bool binary;
+	/* Binary command being processed */
+	struct iiod_bin_cmd bin_cmd;
+	/* Wire format of bin_cmd or of its response */
+	uint8_t bin_hdr[IIOD_BIN_CMD_SIZE];
+	/* Buffer of the block being transferred */
+	struct iiod_bin_buffer *bin_buf;
+	/* Bytes left of the block transfer or length of the written value */
+	uint32_t bin_left;
+	/* Objects created by the binary connection */
+	struct iiod_bin_buffer bin_bufs[IIOD_BIN_MAX_BUFFERS];
+	struct iiod_bin_block bin_blocks[IIOD_BIN_MAX_BLOCKS];
 };
 
 /* Private iiod information */
@@ -171,8 +355,14 @@ struct iiod_desc {
 	char *xml;
 	/* XML length in bytes */
 	uint32_t xml_len;
+	/* Address of the zstd compressed xml. NULL if not available */
+	const uint8_t *zxml;
+	/* Compressed XML length in bytes */
+	uint32_t zxml_len;
 	/* Backend used by IIOD */
 	enum physical_link_type phy_type;
+	/* XML index used by the binary protocol. Built on first negotiation */
+	struct iiod_xml_index *xml_index;
 };
 
 #endif //IIOD_PRIVATE_H
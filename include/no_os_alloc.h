@@ -35,6 +35,77 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+/*
+ * Allocator backend, selected at build time:
+ * - default: the weak functions below forward to libc, platforms
+ *   (FreeRTOS, ChibiOS) may override them.
+ * - NO_OS_ALLOC_POOL defined: size-class slabs carved from a static heap of
+ *   NO_OS_ALLOC_POOL_SIZE bytes. Blocks of up to NO_OS_ALLOC_POOL_MAX_BLOCK
+ *   bytes are recycled per class in constant time, without fragmenting the
+ *   heap. Bigger blocks, or all blocks once the heap is used up, come from
+ *   libc. The pool is shared between threads through no_os_mutex, created
+ *   by the first allocation. It is not interrupt safe, and without a mutex
+ *   implementation for the platform it must be used from a single thread.
+ *   It owns no_os_free(), so it can't be used with the FreeRTOS and ChibiOS
+ *   allocators.
+ *
+ * Independently of the backend, defining NO_OS_ALLOC_TRACE routes every
+ * allocation through a tracing layer recording, for each call site, the
+ * number of allocations and frees and the live and peak bytes, along with a
+ * histogram of the requested sizes. Each block then carries a header of up to
+ * 32 bytes and is linked in a list of live blocks, used for leak reports. The
+ * tracing layer is not interrupt safe. Without NO_OS_ALLOC_TRACE the
+ * no_os_alloc_trace_*() functions are stubs and no allocation is traced.
+ */
+
+/**
+ * @enum no_os_alloc_tag
+ * @brief Subsystem an allocation is accounted to
+ */
+enum no_os_alloc_tag {
+	NO_OS_ALLOC_TAG_DEFAULT,
+	NO_OS_ALLOC_TAG_IIO,
+	NO_OS_ALLOC_TAG_NETWORK,
+	NO_OS_ALLOC_TAG_FIFO,
+	NO_OS_ALLOC_TAG_LIST,
+	NO_OS_ALLOC_TAG_DRIVER,
+	NO_OS_ALLOC_TAG_MAX
+};
+
+/**
+ * @struct no_os_alloc_stats
+ * @brief Memory usage of a subsystem, only kept by the pool backend
+ */
+struct no_os_alloc_stats {
+	/** Bytes currently allocated, block overhead included */
+	uint32_t	in_use;
+	/** Highest value of in_use */
+	uint32_t	peak;
+	/** Number of successful allocations */
+	uint32_t	allocs;
+	/** Number of failed allocations */
+	uint32_t	fails;
+	/** Number of allocations served by libc */
+	uint32_t	fallbacks;
+};
+
+/**
+ * @struct no_os_arena
+ * @brief Bump allocator over a caller provided memory area. Allocations are
+ * not freed one by one, the whole arena is reset at once.
+ */
+struct no_os_arena {
+	/** Memory area */
+	uint8_t		*base;
+	/** Size of the memory area */
+	size_t		size;
+	/** Bytes allocated since the last reset */
+	size_t		used;
+	/** Highest value of used */
+	size_t		peak;
+};
 
 /* Allocate memory and return a pointer to it */
 void *no_os_malloc(size_t size);
@@ -46,4 +117,59 @@ void *no_os_calloc(size_t nitems, size_t size);
  * no_os_malloc */
 void no_os_free(void *ptr);
 
+/* no_os_malloc() accounted to a subsystem */
+void *no_os_malloc_tag(size_t size, enum no_os_alloc_tag tag);
+
+/* no_os_calloc() accounted to a subsystem */
+void *no_os_calloc_tag(size_t nitems, size_t size, enum no_os_alloc_tag tag);
+
+/* Get the memory usage of a subsystem */
+int no_os_alloc_get_stats(enum no_os_alloc_tag tag,
+			  struct no_os_alloc_stats *stats);
+
+/* Set up an arena over size bytes at mem */
+void no_os_arena_init(struct no_os_arena *arena, void *mem, size_t size);
+
+/* Allocate size bytes, 8 bytes aligned, from an arena */
+void *no_os_arena_alloc(struct no_os_arena *arena, size_t size);
+
+/* Free all the allocations of an arena */
+void no_os_arena_reset(struct no_os_arena *arena);
+
+/* Print the allocation statistics, as text, into buf */
+int no_os_alloc_trace_dump(char *buf, uint32_t len);
+
+/* Get a mark identifying the allocations done from now on */
+uint32_t no_os_alloc_trace_mark(void);
+
+/* Report the blocks allocated since mark that are still live */
+uint32_t no_os_alloc_trace_leaks(uint32_t mark);
+
+/*
+ * The backend files define NO_OS_ALLOC_BACKEND before including this header,
+ * to implement the functions the tracing layer forwards to.
+ */
+#if defined(NO_OS_ALLOC_TRACE) && !defined(NO_OS_ALLOC_BACKEND)
+
+void *no_os_malloc_trace(size_t size, enum no_os_alloc_tag tag,
+			 const char *file, uint32_t line);
+
+void *no_os_calloc_trace(size_t nitems, size_t size, enum no_os_alloc_tag tag,
+			 const char *file, uint32_t line);
+
+void no_os_free_trace(void *ptr);
+
+#define no_os_malloc(size) \
+	no_os_malloc_trace(size, NO_OS_ALLOC_TAG_DEFAULT, __FILE__, __LINE__)
+#define no_os_calloc(nitems, size) \
+	no_os_calloc_trace(nitems, size, NO_OS_ALLOC_TAG_DEFAULT, __FILE__, \
+			   __LINE__)
+#define no_os_malloc_tag(size, tag) \
+	no_os_malloc_trace(size, tag, __FILE__, __LINE__)
+#define no_os_calloc_tag(nitems, size, tag) \
+	no_os_calloc_trace(nitems, size, tag, __FILE__, __LINE__)
+#define no_os_free(ptr)	no_os_free_trace(ptr)
+
+#endif /* NO_OS_ALLOC_TRACE */
+
 #endif // _NO_OS_ALLOC_H_
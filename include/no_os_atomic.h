@@ -0,0 +1,82 @@
+/***************************************************************************//**
+ *   @file   no_os_atomic.h
+ *   @brief  Ordered accesses to data shared with interrupts and threads
+********************************************************************************
+ *   @copyright
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_ATOMIC_H_
+#define _NO_OS_ATOMIC_H_
+
+#include <stdint.h>
+
+/*
+ * Padding keeping the fields written by a producer and the ones written by a
+ * consumer in different cache lines. 0 on platforms without data cache.
+ */
+#ifndef NO_OS_CACHE_LINE
+#if defined(__linux__)
+#define NO_OS_CACHE_LINE	64
+#else
+#define NO_OS_CACHE_LINE	0
+#endif
+#endif
+
+/*
+ * Load and store of a 32 bit word shared between a single writer and a
+ * single reader (interrupt, thread or other core). A release store makes the
+ * memory written before it visible to the reader doing the acquire load.
+ */
+#if defined(__GNUC__)
+
+#define no_os_load_acquire(p)		__atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define no_os_store_release(p, v)	__atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+#else
+
+#include <stdatomic.h>
+
+static inline uint32_t no_os_load_acquire(uint32_t *p)
+{
+	uint32_t val = *(volatile uint32_t *)p;
+
+	atomic_thread_fence(memory_order_acquire);
+
+	return val;
+}
+
+static inline void no_os_store_release(uint32_t *p, uint32_t val)
+{
+	atomic_thread_fence(memory_order_release);
+	*(volatile uint32_t *)p = val;
+}
+
+#endif
+
+#endif // _NO_OS_ATOMIC_H_
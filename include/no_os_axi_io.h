@@ -36,10 +36,62 @@
 
 #include <stdint.h>
 
+/**
+ * @enum no_os_axi_io_op_type
+ * @brief Register operation types of a batch.
+ */
+enum no_os_axi_io_op_type {
+	/** Read the register into value */
+	NO_OS_AXI_IO_READ,
+	/** Write value to the register */
+	NO_OS_AXI_IO_WRITE,
+	/** Replace the mask bits of the register with the ones of value */
+	NO_OS_AXI_IO_UPDATE,
+};
+
+/**
+ * @struct no_os_axi_io_op
+ * @brief Single register operation of a batch.
+ */
+struct no_os_axi_io_op {
+	/** Register offset */
+	uint32_t offset;
+	/** Value to be written or location of the read value */
+	uint32_t value;
+	/** Bits affected by a NO_OS_AXI_IO_UPDATE operation */
+	uint32_t mask;
+	/** Operation type */
+	enum no_os_axi_io_op_type op;
+};
+
+#define NO_OS_AXI_IO_OP_READ(off) \
+	{ .offset = (off), .op = NO_OS_AXI_IO_READ }
+
+#define NO_OS_AXI_IO_OP_WRITE(off, val) \
+	{ .offset = (off), .value = (val), .op = NO_OS_AXI_IO_WRITE }
+
+#define NO_OS_AXI_IO_OP_UPDATE(off, msk, val) \
+	{ .offset = (off), .value = (val), .mask = (msk), .op = NO_OS_AXI_IO_UPDATE }
+
 /* AXI IO Read data */
 int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
 
 /* AXI IO Write data */
 int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
 
+/* AXI IO Read consecutive registers */
+int32_t no_os_axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count);
+
+/* AXI IO Write consecutive registers */
+int32_t no_os_axi_io_write_burst(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count);
+
+/* AXI IO Run a batch of register operations, in order */
+int32_t no_os_axi_io_batch(uint32_t base, struct no_os_axi_io_op *ops,
+			   uint32_t num_ops);
+
+/* AXI IO Wait for the interrupt of the device */
+int32_t no_os_axi_io_wait_irq(uint32_t base, uint32_t *timeout_us);
+
 #endif // _NO_OS_AXI_IO_H_
@@ -36,13 +36,51 @@
 #define _NO_OS_CIRCULAR_BUFFER_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "no_os_atomic.h"
+
+/*
+ * Builds running a NO_OS_CB_SPSC producer and consumer on different cores can
+ * define NO_OS_CB_SPSC_PADDING to keep the two pointers in separate
+ * NO_OS_CACHE_LINE sized lines. Without it a buffer costs no extra memory.
+ */
+#if defined(NO_OS_CB_SPSC_PADDING) && NO_OS_CACHE_LINE
+#define NO_OS_CB_PAD	NO_OS_CACHE_LINE
+#else
+#define NO_OS_CB_PAD	0
+#endif
+
+/**
+ * @enum no_os_cb_mode
+ * @brief Circular buffer operating mode
+ */
+enum no_os_cb_mode {
+	/**
+	 * The writer never waits for the reader: it overwrites the oldest
+	 * data and the reader gets -NO_OS_EOVERRUN. Safe for one writer and
+	 * one reader only if they don't run concurrently on different cores.
+	 */
+	NO_OS_CB_DEFAULT,
+	/**
+	 * Lock-free single producer, single consumer. The producer and the
+	 * consumer may run from an interrupt, a thread or a different core.
+	 * The writer gets -EAGAIN instead of overwriting unread data. The size
+	 * must be a power of two. The indexes are shared with the ordered
+	 * accesses of no_os_atomic.h, see NO_OS_CB_SPSC_PADDING.
+	 */
+	NO_OS_CB_SPSC,
+};
 
 /**
  * @struct no_os_cb_ptr
  * @brief Circular buffer pointer
  */
 struct no_os_cb_ptr {
-	/** Index of data in the buffer */
+	/**
+	 * Index of data in the buffer. In NO_OS_CB_SPSC mode, number of bytes
+	 * transferred since the buffer was configured, the index being
+	 * idx & (size - 1). Only updated by its side.
+	 */
 	uint32_t	idx;
 	/** Counts the number of times idx exceeds the liniar buffer */
 	uint32_t	spin_count;
@@ -61,16 +99,28 @@ struct no_os_circular_buffer {
 	uint32_t	size;
 	/** Address of the buffer */
 	int8_t		*buff;
+	/** Operating mode */
+	enum no_os_cb_mode	mode;
 	/** Write pointer */
 	struct no_os_cb_ptr	write;
+#if NO_OS_CB_PAD
+	uint8_t		write_pad[NO_OS_CB_PAD];
+#endif
 	/** Read pointer */
 	struct no_os_cb_ptr	read;
+#if NO_OS_CB_PAD
+	uint8_t		read_pad[NO_OS_CB_PAD];
+#endif
 };
 
 int32_t no_os_cb_init(struct no_os_circular_buffer **desc, uint32_t size);
+int32_t no_os_cb_init_mode(struct no_os_circular_buffer **desc, uint32_t size,
+			   enum no_os_cb_mode mode);
 /* Configure cb structure with given parameters without memory allocation */
 int32_t no_os_cb_cfg(struct no_os_circular_buffer *desc, int8_t *buf,
 		     uint32_t size);
+int32_t no_os_cb_cfg_mode(struct no_os_circular_buffer *desc, int8_t *buf,
+			  uint32_t size, enum no_os_cb_mode mode);
 int32_t no_os_cb_remove(struct no_os_circular_buffer *desc);
 int32_t no_os_cb_size(struct no_os_circular_buffer *desc, uint32_t *size);
 
@@ -84,11 +134,13 @@ int32_t no_os_cb_prepare_async_write(struct no_os_circular_buffer *desc,
 				     void **write_buff,
 				     uint32_t *raw_size_avilable);
 int32_t no_os_cb_end_async_write(struct no_os_circular_buffer *desc);
+int32_t no_os_cb_cancel_async_write(struct no_os_circular_buffer *desc);
 
 int32_t no_os_cb_prepare_async_read(struct no_os_circular_buffer *desc,
 				    uint32_t raw_size_to_read,
 				    void **read_buff,
 				    uint32_t *raw_size_avilable);
 int32_t no_os_cb_end_async_read(struct no_os_circular_buffer *desc);
+int32_t no_os_cb_cancel_async_read(struct no_os_circular_buffer *desc);
 
 #endif //_NO_OS_CIRCULAR_BUFFER_H_
@@ -0,0 +1,393 @@
+/***************************************************************************//**
+ *   @file   no_os_lf_ring.h
+ *   @brief  SPSC lock-free ring of fixed size elements.
+********************************************************************************
+ *   @copyright
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_LF_RING_H_
+#define _NO_OS_LF_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "no_os_alloc.h"
+#include "no_os_atomic.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+
+/*
+ * Lock-free ring for one producer and one consumer that may run from an
+ * interrupt, a thread or another core, e.g. a UART RX interrupt and the
+ * application. The element size and the depth (a power of two) are chosen
+ * at init.
+ *
+ * Elements are transferred one at a time, in bulk or in place: the span
+ * functions return the contiguous elements that can be accessed directly,
+ * which are then committed or released.
+ *
+ * The functions are inline since they are meant for interrupt paths.
+ * NO_OS_LF_RING_DEFINE() generates typed wrappers with the element size known
+ * at compile time, which turns the copies into plain loads and stores.
+ */
+
+/**
+ * @struct no_os_lf_ring
+ * @brief Lock-free ring descriptor
+ */
+struct no_os_lf_ring {
+	/** Storage of depth elements */
+	uint8_t		*data;
+	/** Size of an element in bytes */
+	uint32_t	elem_size;
+	/** depth - 1 */
+	uint32_t	mask;
+	/** Set if data was allocated by no_os_lf_ring_init() */
+	bool		allocated;
+	/** Number of elements written. Producer only. */
+	uint32_t	head;
+	/** Highest number of elements seen in the ring by the producer */
+	uint32_t	high_watermark;
+	/** Number of elements dropped by the producer because of a full ring */
+	uint32_t	overflows;
+#if NO_OS_CACHE_LINE
+	uint8_t		head_pad[NO_OS_CACHE_LINE];
+#endif
+	/** Number of elements read. Consumer only. */
+	uint32_t	tail;
+#if NO_OS_CACHE_LINE
+	uint8_t		tail_pad[NO_OS_CACHE_LINE];
+#endif
+};
+
+/**
+ * @brief Configure a ring using the given storage.
+ * @param ring - Ring descriptor.
+ * @param data - Storage of depth * elem_size bytes.
+ * @param elem_size - Size of an element in bytes.
+ * @param depth - Number of elements, a power of two.
+ * @return 0 in case of success, -EINVAL otherwise.
+ */
+static inline int no_os_lf_ring_cfg(struct no_os_lf_ring *ring, void *data,
+				    uint32_t elem_size, uint32_t depth)
+{
+	if (!ring || !elem_size || !depth || (depth & (depth - 1)))
+		return -EINVAL;
+
+	memset(ring, 0, sizeof(*ring));
+	ring->data = data;
+	ring->elem_size = elem_size;
+	ring->mask = depth - 1;
+
+	return 0;
+}
+
+/**
+ * @brief Allocate and configure a ring.
+ * @param ring - Where to store the ring descriptor.
+ * @param elem_size - Size of an element in bytes.
+ * @param depth - Number of elements, a power of two.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static inline int no_os_lf_ring_init(struct no_os_lf_ring **ring,
+				     uint32_t elem_size, uint32_t depth)
+{
+	struct no_os_lf_ring *r;
+	int ret;
+
+	if (!ring)
+		return -EINVAL;
+
+	r = (struct no_os_lf_ring *)no_os_calloc(1, sizeof(*r));
+	if (!r)
+		return -ENOMEM;
+
+	ret = no_os_lf_ring_cfg(r, NULL, elem_size, depth);
+	if (ret)
+		goto free_ring;
+
+	r->data = (uint8_t *)no_os_calloc(depth, elem_size);
+	if (!r->data) {
+		ret = -ENOMEM;
+		goto free_ring;
+	}
+	r->allocated = true;
+	*ring = r;
+
+	return 0;
+
+free_ring:
+	no_os_free(r);
+
+	return ret;
+}
+
+/**
+ * @brief Free a ring allocated by no_os_lf_ring_init().
+ * @param ring - Ring descriptor.
+ */
+static inline void no_os_lf_ring_remove(struct no_os_lf_ring *ring)
+{
+	if (!ring)
+		return;
+
+	if (ring->allocated)
+		no_os_free(ring->data);
+	no_os_free(ring);
+}
+
+/* Number of elements that can be read */
+static inline uint32_t no_os_lf_ring_count(struct no_os_lf_ring *ring)
+{
+	return no_os_load_acquire(&ring->head) - ring->tail;
+}
+
+/* Number of elements that can be written */
+static inline uint32_t no_os_lf_ring_space(struct no_os_lf_ring *ring)
+{
+	return ring->mask + 1 - (ring->head - no_os_load_acquire(&ring->tail));
+}
+
+/**
+ * @brief Get the contiguous free elements, to be written in place.
+ * @param ring - Ring descriptor.
+ * @param span - Where to store the address of the first free element.
+ * @return Number of contiguous free elements, 0 if the ring is full.
+ */
+static inline uint32_t no_os_lf_ring_write_span(struct no_os_lf_ring *ring,
+		void **span)
+{
+	uint32_t idx = ring->head & ring->mask;
+
+	*span = ring->data + idx * ring->elem_size;
+
+	return no_os_min(no_os_lf_ring_space(ring), ring->mask + 1 - idx);
+}
+
+/**
+ * @brief Make n elements written in place available to the consumer.
+ * @param ring - Ring descriptor.
+ * @param n - Number of elements, at most the value returned by
+ * no_os_lf_ring_write_span().
+ */
+static inline void no_os_lf_ring_write_commit(struct no_os_lf_ring *ring,
+		uint32_t n)
+{
+	uint32_t used = ring->head + n - no_os_load_acquire(&ring->tail);
+
+	/* tail may be stale, used is an upper bound */
+	if (used > ring->high_watermark)
+		ring->high_watermark = used;
+
+	no_os_store_release(&ring->head, ring->head + n);
+}
+
+/**
+ * @brief Get the contiguous elements available, to be read in place.
+ * @param ring - Ring descriptor.
+ * @param span - Where to store the address of the first element.
+ * @return Number of contiguous elements, 0 if the ring is empty.
+ */
+static inline uint32_t no_os_lf_ring_read_span(struct no_os_lf_ring *ring,
+		void **span)
+{
+	uint32_t idx = ring->tail & ring->mask;
+
+	*span = ring->data + idx * ring->elem_size;
+
+	return no_os_min(no_os_lf_ring_count(ring), ring->mask + 1 - idx);
+}
+
+/**
+ * @brief Give n elements read in place back to the producer.
+ * @param ring - Ring descriptor.
+ * @param n - Number of elements, at most the value returned by
+ * no_os_lf_ring_read_span().
+ */
+static inline void no_os_lf_ring_read_release(struct no_os_lf_ring *ring,
+		uint32_t n)
+{
+	no_os_store_release(&ring->tail, ring->tail + n);
+}
+
+/* Single element write with a size known by the caller */
+static inline int no_os_lf_ring_put(struct no_os_lf_ring *ring,
+				    const void *elem, uint32_t elem_size)
+{
+	uint32_t used = ring->head - no_os_load_acquire(&ring->tail);
+
+	if (used > ring->mask) {
+		ring->overflows++;
+		return -EAGAIN;
+	}
+
+	memcpy(ring->data + (ring->head & ring->mask) * elem_size, elem,
+	       elem_size);
+	if (used >= ring->high_watermark)
+		ring->high_watermark = used + 1;
+	no_os_store_release(&ring->head, ring->head + 1);
+
+	return 0;
+}
+
+/* Single element read with a size known by the caller */
+static inline int no_os_lf_ring_get(struct no_os_lf_ring *ring, void *elem,
+				    uint32_t elem_size)
+{
+	if (!no_os_lf_ring_count(ring))
+		return -EAGAIN;
+
+	memcpy(elem, ring->data + (ring->tail & ring->mask) * elem_size,
+	       elem_size);
+	no_os_lf_ring_read_release(ring, 1);
+
+	return 0;
+}
+
+/**
+ * @brief Write an element.
+ * @param ring - Ring descriptor.
+ * @param elem - Element to copy in the ring.
+ * @return 0 in case of success, -EAGAIN if the ring is full.
+ */
+static inline int no_os_lf_ring_write(struct no_os_lf_ring *ring,
+				      const void *elem)
+{
+	return no_os_lf_ring_put(ring, elem, ring->elem_size);
+}
+
+/**
+ * @brief Read an element.
+ * @param ring - Ring descriptor.
+ * @param elem - Where to copy the element.
+ * @return 0 in case of success, -EAGAIN if the ring is empty.
+ */
+static inline int no_os_lf_ring_read(struct no_os_lf_ring *ring, void *elem)
+{
+	return no_os_lf_ring_get(ring, elem, ring->elem_size);
+}
+
+/**
+ * @brief Write up to n elements.
+ *
+ * The elements that don't fit are not written and are counted as overflows.
+ * @param ring - Ring descriptor.
+ * @param elems - Elements to copy in the ring.
+ * @param n - Number of elements.
+ * @return Number of elements written.
+ */
+static inline uint32_t no_os_lf_ring_write_bulk(struct no_os_lf_ring *ring,
+		const void *elems, uint32_t n)
+{
+	const uint8_t *src = (const uint8_t *)elems;
+	uint32_t done, len;
+	void *span;
+
+	/* At most two spans, before and after the end of the storage */
+	for (done = 0; done < n; done += len) {
+		len = no_os_lf_ring_write_span(ring, &span);
+		len = no_os_min(len, n - done);
+		if (!len) {
+			ring->overflows += n - done;
+			break;
+		}
+
+		memcpy(span, src + done * ring->elem_size,
+		       len * ring->elem_size);
+		no_os_lf_ring_write_commit(ring, len);
+	}
+
+	return done;
+}
+
+/**
+ * @brief Read up to n elements.
+ * @param ring - Ring descriptor.
+ * @param elems - Where to copy the elements.
+ * @param n - Number of elements.
+ * @return Number of elements read.
+ */
+static inline uint32_t no_os_lf_ring_read_bulk(struct no_os_lf_ring *ring,
+		void *elems, uint32_t n)
+{
+	uint8_t *dst = (uint8_t *)elems;
+	uint32_t done, len;
+	void *span;
+
+	for (done = 0; done < n; done += len) {
+		len = no_os_lf_ring_read_span(ring, &span);
+		len = no_os_min(len, n - done);
+		if (!len)
+			break;
+
+		memcpy(dst + done * ring->elem_size, span,
+		       len * ring->elem_size);
+		no_os_lf_ring_read_release(ring, len);
+	}
+
+	return done;
+}
+
+/* Drop the elements available to the consumer. Consumer only. */
+static inline void no_os_lf_ring_flush(struct no_os_lf_ring *ring)
+{
+	no_os_store_release(&ring->tail, no_os_load_acquire(&ring->head));
+}
+
+/*
+ * Typed wrappers of a ring of type elements:
+ * name##_init(), name##_write(), name##_read(), name##_write_bulk() and
+ * name##_read_bulk().
+ */
+#define NO_OS_LF_RING_DEFINE(name, type)				\
+static inline int name##_init(struct no_os_lf_ring **ring,		\
+			      uint32_t depth)				\
+{									\
+	return no_os_lf_ring_init(ring, sizeof(type), depth);		\
+}									\
+static inline int name##_write(struct no_os_lf_ring *ring, type val)	\
+{									\
+	return no_os_lf_ring_put(ring, &val, sizeof(type));		\
+}									\
+static inline int name##_read(struct no_os_lf_ring *ring, type *val)	\
+{									\
+	return no_os_lf_ring_get(ring, val, sizeof(type));		\
+}									\
+static inline uint32_t name##_write_bulk(struct no_os_lf_ring *ring,	\
+		const type *vals, uint32_t n)				\
+{									\
+	return no_os_lf_ring_write_bulk(ring, vals, n);			\
+}									\
+static inline uint32_t name##_read_bulk(struct no_os_lf_ring *ring,	\
+					type *vals, uint32_t n)		\
+{									\
+	return no_os_lf_ring_read_bulk(ring, vals, n);			\
+}
+
+#endif // _NO_OS_LF_RING_H_
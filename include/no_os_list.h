@@ -84,6 +84,7 @@
 #ifndef _NO_OS_LIST_H_
 #define _NO_OS_LIST_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -304,4 +305,160 @@ int32_t no_os_list_get_find(struct no_os_list_desc *list_desc, void **data,
 			    void *cmp_data);
 /** @}*/
 
+/**
+ * @name Intrusive list
+ * Doubly linked list of nodes embedded in the user structures. Nothing is
+ * allocated and all the operations are done in constant time. The list head
+ * is a node linked to itself when the list is empty.
+ * @code{.c}
+ *	struct my_cb {
+ *		void (*fn)(void *ctx);
+ *		struct no_os_ilist_node node;
+ *	};
+ *	struct no_os_ilist_node cbs = NO_OS_ILIST_HEAD_INIT(cbs);
+ *	struct no_os_ilist_node *it;
+ *
+ *	no_os_ilist_add_last(&cbs, &cb->node);
+ *	no_os_ilist_for_each(it, &cbs)
+ *		no_os_ilist_entry(it, struct my_cb, node)->fn(ctx);
+ * @endcode
+ * @{
+ */
+struct no_os_ilist_node {
+	struct no_os_ilist_node	*next;
+	struct no_os_ilist_node	*prev;
+};
+
+#define NO_OS_ILIST_HEAD_INIT(name)	{ &(name), &(name) }
+
+/* Structure of type embedding node as member */
+#define no_os_ilist_entry(node, type, member) \
+	((type *)((char *)(node) - offsetof(type, member)))
+
+#define no_os_ilist_for_each(pos, head) \
+	for ((pos) = (head)->next; (pos) != (head); (pos) = (pos)->next)
+
+/* Iterate allowing the removal of pos, tmp holds the next node */
+#define no_os_ilist_for_each_safe(pos, tmp, head) \
+	for ((pos) = (head)->next, (tmp) = (pos)->next; (pos) != (head); \
+	     (pos) = (tmp), (tmp) = (pos)->next)
+
+static inline void no_os_ilist_init(struct no_os_ilist_node *head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+static inline bool no_os_ilist_empty(const struct no_os_ilist_node *head)
+{
+	return head->next == head;
+}
+
+/* Insert node after pos */
+static inline void no_os_ilist_add_after(struct no_os_ilist_node *pos,
+		struct no_os_ilist_node *node)
+{
+	node->prev = pos;
+	node->next = pos->next;
+	pos->next->prev = node;
+	pos->next = node;
+}
+
+static inline void no_os_ilist_add_first(struct no_os_ilist_node *head,
+		struct no_os_ilist_node *node)
+{
+	no_os_ilist_add_after(head, node);
+}
+
+static inline void no_os_ilist_add_last(struct no_os_ilist_node *head,
+					struct no_os_ilist_node *node)
+{
+	no_os_ilist_add_after(head->prev, node);
+}
+
+/* Unlink node. The node is left linked to itself, as an empty list */
+static inline void no_os_ilist_del(struct no_os_ilist_node *node)
+{
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	no_os_ilist_init(node);
+}
+
+/* First node of the list, NULL if empty */
+static inline struct no_os_ilist_node *no_os_ilist_first(
+	struct no_os_ilist_node *head)
+{
+	return no_os_ilist_empty(head) ? NULL : head->next;
+}
+
+/* Last node of the list, NULL if empty */
+static inline struct no_os_ilist_node *no_os_ilist_last(
+	struct no_os_ilist_node *head)
+{
+	return no_os_ilist_empty(head) ? NULL : head->prev;
+}
+/** @}*/
+
+/**
+ * @struct no_os_heap
+ * @brief Priority queue kept as a binary heap in an array of fixed capacity.
+ * Insertion and extraction of the lowest element, as ordered by the
+ * comparator, are done in O(log n).
+ */
+struct no_os_heap {
+	/** Elements, elems[0] is the lowest */
+	void		**elems;
+	/** Number of elements in the heap */
+	uint32_t	nb_elements;
+	/** Maximum number of elements */
+	uint32_t	capacity;
+	/** Function used to compare elements */
+	f_cmp		comparator;
+};
+
+/**
+ * @name Priority queue
+ * Functions return 0 on success and a negative error code otherwise.
+ * @{
+ */
+int32_t no_os_heap_init(struct no_os_heap *heap, uint32_t capacity,
+			f_cmp comparator);
+int32_t no_os_heap_remove(struct no_os_heap *heap);
+int32_t no_os_heap_push(struct no_os_heap *heap, void *data);
+int32_t no_os_heap_pop(struct no_os_heap *heap, void **data);
+int32_t no_os_heap_top(struct no_os_heap *heap, void **data);
+/** @}*/
+
+/**
+ * @struct no_os_map
+ * @brief Ordered map of uint32_t keys, kept as a sorted array of fixed
+ * capacity. Lookups are done in O(log n) with a binary search over the keys,
+ * stored apart from the values to stay in few cache lines. Insertion and
+ * deletion move the following entries.
+ */
+struct no_os_map {
+	/** Keys, in increasing order */
+	uint32_t	*keys;
+	/** Value of each key */
+	void		**values;
+	/** Number of entries in the map */
+	uint32_t	nb_elements;
+	/** Maximum number of entries */
+	uint32_t	capacity;
+};
+
+/**
+ * @name Ordered map
+ * Functions return 0 on success and a negative error code otherwise.
+ * @{
+ */
+int32_t no_os_map_init(struct no_os_map *map, uint32_t capacity);
+int32_t no_os_map_remove(struct no_os_map *map);
+int32_t no_os_map_add(struct no_os_map *map, uint32_t key, void *value);
+int32_t no_os_map_read(struct no_os_map *map, uint32_t key, void **value);
+int32_t no_os_map_get(struct no_os_map *map, uint32_t key, void **value);
+int32_t no_os_map_read_idx(struct no_os_map *map, uint32_t idx, uint32_t *key,
+			   void **value);
+/** @}*/
+
 #endif // _NO_OS_LIST_H_
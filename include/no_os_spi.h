@@ -35,6 +35,7 @@
 #define _NO_OS_SPI_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define	NO_OS_SPI_CPHA	0x01
 #define	NO_OS_SPI_CPOL	0x02
@@ -173,6 +174,22 @@ struct no_os_spibus_desc {
 	void		*extra;
 };
 
+/**
+ * @struct no_os_spi_batch
+ * @brief Messages queued between no_os_spi_batch_begin() and
+ * no_os_spi_batch_commit().
+ */
+struct no_os_spi_batch {
+	/** Queued messages */
+	struct no_os_spi_msg	*msgs;
+	/** Number of queued messages */
+	uint32_t		len;
+	/** Number of messages that fit in msgs */
+	uint32_t		size;
+	/** Set between no_os_spi_batch_begin() and no_os_spi_batch_commit() */
+	bool			active;
+};
+
 /**
  * @struct no_os_spi_desc
  * @brief Structure holding SPI descriptor.
@@ -200,6 +217,8 @@ struct no_os_spi_desc {
 	void		*extra;
 	/** Parent of the device */
 	struct no_os_spi_desc *parent;
+	/** Transaction batch, allocated by the first no_os_spi_batch_begin() */
+	struct no_os_spi_batch	*batch;
 };
 
 /**
@@ -265,6 +284,17 @@ int32_t no_os_spi_transfer_dma_async(struct no_os_spi_desc *desc,
 /* Abort SPI transfers. */
 int32_t no_os_spi_transfer_abort(struct no_os_spi_desc *desc);
 
+/* Start queueing messages instead of sending them right away. */
+int32_t no_os_spi_batch_begin(struct no_os_spi_desc *desc);
+
+/* Queue a list of messages in the current batch. */
+int32_t no_os_spi_batch_queue(struct no_os_spi_desc *desc,
+			      struct no_os_spi_msg *msgs,
+			      uint32_t len);
+
+/* Send all the queued messages in a single transfer. */
+int32_t no_os_spi_batch_commit(struct no_os_spi_desc *desc);
+
 /* Initialize SPI bus descriptor*/
 int32_t no_os_spibus_init(const struct no_os_spi_init_param *param);
 
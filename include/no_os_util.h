@@ -122,7 +122,7 @@
 /* Check if bit set */
 inline int no_os_test_bit(int pos, const volatile void * addr)
 {
-	return (((const int *)addr)[pos / 32] >> pos) & 1UL;
+	return (((const uint32_t *)addr)[pos / 32] >> (pos % 32)) & 1UL;
 }
 
 /* Find first set bit in word. */
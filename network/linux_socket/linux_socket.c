@@ -49,6 +49,57 @@
 #include <netdb.h>
 #include <string.h>
 #include <fcntl.h>
+#include <stdbool.h>
+#include <sys/epoll.h>
+
+/* Maximum number of sockets reported by one socket_wait call */
+#define LINUX_SOCKET_MAX_EVENTS	32
+
+/* Events watched on every socket. EPOLLOUT is added only after a short send */
+#define LINUX_SOCKET_EVENTS	(EPOLLIN | EPOLLRDHUP)
+
+/* epoll instance watching all the sockets opened or accepted by linux_net */
+static int linux_epoll_fd = -1;
+
+/**
+ * @brief Register a socket in the epoll instance used by socket_wait.
+ * @param sock_id - Socket id
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_socket_watch(uint32_t sock_id)
+{
+	struct epoll_event ev = {
+		.events = LINUX_SOCKET_EVENTS,
+		.data.fd = sock_id
+	};
+
+	if (linux_epoll_fd < 0) {
+		linux_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (linux_epoll_fd < 0)
+			return -errno;
+	}
+
+	if (epoll_ctl(linux_epoll_fd, EPOLL_CTL_ADD, sock_id, &ev) < 0)
+		return -errno;
+
+	return 0;
+}
+
+/**
+ * @brief Enable or disable the writable notification of a socket.
+ * @param sock_id - Socket id
+ * @param enable - Report the socket in socket_wait when it can send again
+ */
+static void linux_socket_watch_out(uint32_t sock_id, bool enable)
+{
+	struct epoll_event ev = {
+		.events = LINUX_SOCKET_EVENTS | (enable ? EPOLLOUT : 0),
+		.data.fd = sock_id
+	};
+
+	if (linux_epoll_fd >= 0)
+		epoll_ctl(linux_epoll_fd, EPOLL_CTL_MOD, sock_id, &ev);
+}
 
 /** @brief See \ref network_interface.socket_open */
 static int32_t linux_socket_open(void *desc, uint32_t *sock_id,
@@ -65,6 +116,12 @@ static int32_t linux_socket_open(void *desc, uint32_t *sock_id,
 	flags = fcntl(*sock_id, F_GETFL);
 	fcntl(*sock_id, F_SETFL, flags | O_NONBLOCK);
 
+	err = linux_socket_watch(*sock_id);
+	if (err) {
+		close(*sock_id);
+		return err;
+	}
+
 	return 0;
 }
 
@@ -124,11 +181,19 @@ static int32_t linux_socket_send(void *desc, uint32_t sock_id,
 	int32_t ret;
 
 	ret = send(sock_id, data, size, 0);
+	if (ret < 0) {
+		ret = -errno;
+		if (ret == -EAGAIN || ret == -EWOULDBLOCK)
+			linux_socket_watch_out(sock_id, true);
 
-	if (ret < 0)
-		return -errno;
+		return ret;
+	}
+
+	/* Socket buffer is full, get notified when the rest can be sent */
+	if ((uint32_t)ret < size)
+		linux_socket_watch_out(sock_id, true);
 
-	return size;
+	return ret;
 }
 
 /** @brief See \ref network_interface.socket_recv */
@@ -249,6 +314,57 @@ static int32_t linux_socket_accept(void *desc, uint32_t sock_id,
 
 	*client_socket_id = ret;
 
+	/*
+	 * Request/response traffic: don't let Nagle hold back short replies
+	 * waiting for the peer's delayed ACK.
+	 */
+	ret = 1;
+	setsockopt(*client_socket_id, IPPROTO_TCP, TCP_NODELAY, &ret,
+		   sizeof(ret));
+
+	ret = linux_socket_watch(*client_socket_id);
+	if (ret) {
+		close(*client_socket_id);
+		return ret;
+	}
+
+	return 0;
+}
+
+/** @brief See \ref network_interface.socket_wait */
+static int32_t linux_socket_wait(void *desc, uint32_t *sock_ids,
+				 uint32_t *nb_sock_ids, int32_t timeout_ms)
+{
+	struct epoll_event events[LINUX_SOCKET_MAX_EVENTS];
+	uint32_t max_events;
+	int32_t ret;
+	int32_t i;
+
+	if (linux_epoll_fd < 0)
+		return -ENODEV;
+
+	max_events = no_os_min(*nb_sock_ids, LINUX_SOCKET_MAX_EVENTS);
+	if (!max_events)
+		return -EINVAL;
+
+	ret = epoll_wait(linux_epoll_fd, events, max_events, timeout_ms);
+	if (ret < 0) {
+		*nb_sock_ids = 0;
+		/* Interrupted by a signal, let the caller run another step */
+		if (errno == EINTR)
+			return 0;
+
+		return -errno;
+	}
+
+	for (i = 0; i < ret; i++) {
+		sock_ids[i] = events[i].data.fd;
+		/* Writable notification is one shot, rearmed by a short send */
+		if (events[i].events & EPOLLOUT)
+			linux_socket_watch_out(sock_ids[i], false);
+	}
+	*nb_sock_ids = ret;
+
 	return 0;
 }
 
@@ -264,7 +380,8 @@ struct network_interface linux_net = {
 	.socket_recvfrom = (int32_t (*)(void *, uint32_t, void *, uint32_t, struct socket_address * from))linux_socket_recvfrom,
 	.socket_bind = (int32_t (*)(void *, uint32_t, uint16_t))linux_socket_bind,
 	.socket_listen = (int32_t (*)(void *, uint32_t, uint32_t))linux_socket_listen,
-	.socket_accept = (int32_t (*)(void *, uint32_t, uint32_t*))linux_socket_accept
+	.socket_accept = (int32_t (*)(void *, uint32_t, uint32_t*))linux_socket_accept,
+	.socket_wait = (int32_t (*)(void *, uint32_t *, uint32_t *, int32_t))linux_socket_wait
 };
 
 #endif
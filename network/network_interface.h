@@ -204,6 +204,25 @@ struct network_interface {
 	 */
 	int32_t (*socket_accept)(void *net, uint32_t sock_id,
 				 uint32_t *client_socket_id);
+
+	/**
+	 * @brief Wait for activity on the sockets of the interface.
+	 *
+	 * Optional. Blocks until at least one socket opened or accepted
+	 * through this interface can make progress (incoming data, a new
+	 * connection, a peer shutdown or room to send after a partial send)
+	 * or until the timeout expires.
+	 * @param net - Network interface
+	 * @param sock_ids - Address where to store the ids of the ready sockets
+	 * @param nb_sock_ids - Size of sock_ids as input. Number of ready
+	 * sockets as output.
+	 * @param timeout_ms - Maximum time to wait. -1 waits indefinitely.
+	 * @return
+	 *  - 0 : On success. nb_sock_ids is 0 if the timeout expired.
+	 *  - \ref Negative error code on failure
+	 */
+	int32_t (*socket_wait)(void *net, uint32_t *sock_ids,
+			       uint32_t *nb_sock_ids, int32_t timeout_ms);
 };
 
 #endif
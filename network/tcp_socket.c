@@ -439,3 +439,23 @@ int32_t socket_accept(struct tcp_socket_desc *desc,
 	return 0;
 }
 
+
+/** @brief See \ref network_interface.socket_wait */
+int32_t socket_wait(struct tcp_socket_desc *desc, uint32_t *sock_ids,
+		    uint32_t *nb_sock_ids, int32_t timeout_ms)
+{
+	if (!desc || !sock_ids || !nb_sock_ids)
+		return -EINVAL;
+
+#ifndef DISABLE_SECURE_SOCKET
+	/* Decrypted data may be pending in the TLS layer */
+	if (desc->secure)
+		return -ENOSYS;
+#endif
+
+	if (!desc->net->socket_wait)
+		return -ENOSYS;
+
+	return desc->net->socket_wait(desc->net->net, sock_ids, nb_sock_ids,
+				      timeout_ms);
+}
@@ -153,4 +153,8 @@ int32_t socket_listen(struct tcp_socket_desc *desc, uint32_t back_log);
 int32_t socket_accept(struct tcp_socket_desc *desc,
 		      struct tcp_socket_desc **new_client);
 
+/* Wait for activity on the sockets of the desc network interface */
+int32_t socket_wait(struct tcp_socket_desc *desc, uint32_t *sock_ids,
+		    uint32_t *nb_sock_ids, int32_t timeout_ms);
+
 #endif
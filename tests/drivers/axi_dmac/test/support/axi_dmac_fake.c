@@ -0,0 +1,357 @@
+/***************************************************************************//**
+ *   @file   axi_dmac_fake.c
+ *   @brief  Register level model of the AXI DMAC used by the tests.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include "axi_dmac.h"
+#include "axi_dmac_fake.h"
+#include "no_os_axi_io.h"
+#include "no_os_delay.h"
+
+struct axi_dmac_fake_xfer {
+	uint32_t id;
+	uint32_t src;
+	uint32_t dest;
+	uint32_t x_len;
+	uint32_t y_len;
+	uint32_t src_stride;
+	uint32_t dest_stride;
+	uint32_t sg;
+	bool sg_mode;
+};
+
+uint8_t axi_dmac_fake_mem[AXI_DMAC_FAKE_MEM_SIZE];
+uint32_t axi_dmac_fake_completed;
+uint32_t axi_dmac_fake_time_us;
+uint32_t axi_dmac_fake_wakeups;
+
+static struct axi_dmac_fake_xfer queue[AXI_DMAC_FAKE_QUEUE_DEPTH];
+static uint32_t nb_queued;
+static uint32_t regs[0x500 / 4];
+static uint32_t irq_source;
+static uint32_t next_id;
+static bool has_2d, has_sg, uio;
+static uint32_t busy_us;
+static uint32_t min_sleep_us;
+static int32_t batch_error;
+static void (*fake_isr)(void *);
+static void *fake_dev;
+static bool in_isr;
+
+void axi_dmac_fake_reset(bool hw_2d, bool hw_sg)
+{
+	memset(regs, 0, sizeof(regs));
+	regs[AXI_DMAC_REG_INTF_DESC / 4] = 0x303;
+	nb_queued = 0;
+	irq_source = 0;
+	next_id = 0;
+	busy_us = 0;
+	min_sleep_us = 0;
+	batch_error = 0;
+	has_2d = hw_2d;
+	has_sg = hw_sg;
+	uio = false;
+	fake_isr = NULL;
+	axi_dmac_fake_completed = 0;
+	axi_dmac_fake_time_us = 0;
+	axi_dmac_fake_wakeups = 0;
+}
+
+void axi_dmac_fake_set_isr(void (*isr)(void *), void *dev)
+{
+	fake_isr = isr;
+	fake_dev = dev;
+}
+
+void axi_dmac_fake_set_uio(bool enable)
+{
+	uio = enable;
+}
+
+void axi_dmac_fake_set_min_sleep(uint32_t us)
+{
+	min_sleep_us = us;
+}
+
+void axi_dmac_fake_set_batch_error(int32_t err)
+{
+	batch_error = err;
+}
+
+static uint32_t pending(void)
+{
+	return irq_source & ~regs[AXI_DMAC_REG_IRQ_MASK / 4];
+}
+
+static void raise_irq(void)
+{
+	if (!fake_isr || in_isr || !pending())
+		return;
+
+	in_isr = true;
+	fake_isr(fake_dev);
+	in_isr = false;
+}
+
+static void copy_2d(uint32_t src, uint32_t dest, uint32_t x_len,
+		    uint32_t y_len, uint32_t src_stride, uint32_t dest_stride)
+{
+	uint32_t row;
+
+	for (row = 0; row < y_len; row++)
+		memmove(&axi_dmac_fake_mem[dest + row * dest_stride],
+			&axi_dmac_fake_mem[src + row * src_stride], x_len);
+}
+
+bool axi_dmac_fake_step(void)
+{
+	struct axi_dmac_fake_xfer *xfer = &queue[0];
+	struct axi_dmac_hw_desc hw;
+	uint32_t addr;
+
+	if (!nb_queued)
+		return false;
+
+	if (xfer->sg_mode) {
+		addr = xfer->sg;
+		do {
+			memcpy(&hw, &axi_dmac_fake_mem[addr], sizeof(hw));
+			copy_2d(hw.src_addr, hw.dest_addr, hw.x_len + 1,
+				has_2d ? hw.y_len + 1 : 1, hw.src_stride,
+				hw.dest_stride);
+			addr = hw.next_sg_addr;
+		} while (!(hw.flags & AXI_DMAC_HW_FLAG_LAST));
+	} else {
+		copy_2d(xfer->src, xfer->dest, xfer->x_len, xfer->y_len,
+			xfer->src_stride, xfer->dest_stride);
+	}
+
+	regs[AXI_DMAC_REG_TRANSFER_DONE / 4] |= 1u << xfer->id;
+	irq_source |= AXI_DMAC_IRQ_EOT;
+	memmove(&queue[0], &queue[1], --nb_queued * sizeof(queue[0]));
+	if (nb_queued)
+		irq_source |= AXI_DMAC_IRQ_SOT;
+	axi_dmac_fake_completed++;
+
+	return true;
+}
+
+/* Let the time pass, completing the transfers due meanwhile */
+static void advance(uint32_t us)
+{
+	while (us--) {
+		axi_dmac_fake_time_us++;
+		if (nb_queued && ++busy_us == AXI_DMAC_FAKE_XFER_US) {
+			busy_us = 0;
+			axi_dmac_fake_step();
+			raise_irq();
+		}
+	}
+}
+
+static void submit(void)
+{
+	struct axi_dmac_fake_xfer *xfer = &queue[nb_queued++];
+
+	xfer->id = next_id;
+	xfer->src = regs[AXI_DMAC_REG_SRC_ADDRESS / 4];
+	xfer->dest = regs[AXI_DMAC_REG_DEST_ADDRESS / 4];
+	xfer->x_len = regs[AXI_DMAC_REG_X_LENGTH / 4] + 1;
+	xfer->y_len = regs[AXI_DMAC_REG_Y_LENGTH / 4] + 1;
+	xfer->src_stride = regs[AXI_DMAC_REG_SRC_STRIDE / 4];
+	xfer->dest_stride = regs[AXI_DMAC_REG_DEST_STRIDE / 4];
+	xfer->sg = regs[AXI_DMAC_REG_SG_ADDRESS / 4];
+	/* With ENABLE_SG the transfer is read from the descriptors */
+	xfer->sg_mode = regs[AXI_DMAC_REG_CTRL / 4] & AXI_DMAC_CTRL_ENABLE_SG;
+
+	/* The done bit of an ID is cleared when it is submitted again */
+	regs[AXI_DMAC_REG_TRANSFER_DONE / 4] &= ~(1u << next_id);
+	next_id = (next_id + 1) % AXI_DMAC_QUEUE_DEPTH;
+	irq_source |= AXI_DMAC_IRQ_SOT;
+}
+
+int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
+{
+	switch (offset) {
+	case AXI_DMAC_REG_IRQ_PENDING:
+		*data = pending();
+		break;
+	case AXI_DMAC_REG_TRANSFER_SUBMIT:
+		*data = nb_queued == AXI_DMAC_FAKE_QUEUE_DEPTH ?
+			AXI_DMAC_QUEUE_FULL : 0;
+		break;
+	case AXI_DMAC_REG_TRANSFER_ID:
+		*data = next_id;
+		break;
+	default:
+		*data = regs[offset / 4];
+		break;
+	}
+
+	return 0;
+}
+
+int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
+{
+	switch (offset) {
+	case AXI_DMAC_REG_IRQ_PENDING:
+		irq_source &= ~data;
+		break;
+	case AXI_DMAC_REG_IRQ_MASK:
+		regs[offset / 4] = data;
+		/* A source latched while masked fires once unmasked */
+		raise_irq();
+		break;
+	case AXI_DMAC_REG_CTRL:
+		if (!has_sg)
+			data &= ~AXI_DMAC_CTRL_ENABLE_SG;
+		regs[offset / 4] = data;
+		if (!(data & AXI_DMAC_CTRL_ENABLE))
+			nb_queued = 0;
+		break;
+	case AXI_DMAC_REG_TRANSFER_SUBMIT:
+		if ((data & AXI_DMAC_TRANSFER_SUBMIT) &&
+		    (regs[AXI_DMAC_REG_CTRL / 4] & AXI_DMAC_CTRL_ENABLE) &&
+		    nb_queued < AXI_DMAC_FAKE_QUEUE_DEPTH)
+			submit();
+		break;
+	case AXI_DMAC_REG_X_LENGTH:
+		regs[offset / 4] = data & AXI_DMAC_FAKE_MAX_LENGTH;
+		break;
+	case AXI_DMAC_REG_Y_LENGTH:
+	case AXI_DMAC_REG_SRC_STRIDE:
+	case AXI_DMAC_REG_DEST_STRIDE:
+		regs[offset / 4] = has_2d ? data : 0;
+		break;
+	case AXI_DMAC_REG_SG_ADDRESS:
+		regs[offset / 4] = has_sg ? data : 0;
+		break;
+	case AXI_DMAC_REG_FLAGS:
+		regs[offset / 4] = data & (DMA_CYCLIC | DMA_LAST);
+		break;
+	default:
+		regs[offset / 4] = data;
+		break;
+	}
+
+	return 0;
+}
+
+int32_t no_os_axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		no_os_axi_io_read(base, offset + i * 4, &data[i]);
+
+	return 0;
+}
+
+int32_t no_os_axi_io_write_burst(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		no_os_axi_io_write(base, offset + i * 4, data[i]);
+
+	return 0;
+}
+
+int32_t no_os_axi_io_batch(uint32_t base, struct no_os_axi_io_op *ops,
+			   uint32_t num_ops)
+{
+	uint32_t i, val;
+
+	if (batch_error)
+		return batch_error;
+
+	for (i = 0; i < num_ops; i++) {
+		switch (ops[i].op) {
+		case NO_OS_AXI_IO_READ:
+			no_os_axi_io_read(base, ops[i].offset, &ops[i].value);
+			break;
+		case NO_OS_AXI_IO_WRITE:
+			no_os_axi_io_write(base, ops[i].offset, ops[i].value);
+			break;
+		case NO_OS_AXI_IO_UPDATE:
+			no_os_axi_io_read(base, ops[i].offset, &val);
+			val &= ~ops[i].mask;
+			val |= ops[i].value & ops[i].mask;
+			no_os_axi_io_write(base, ops[i].offset, val);
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+int32_t no_os_axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	if (!uio)
+		return -ENOSYS;
+
+	axi_dmac_fake_wakeups++;
+	while (*timeout_us) {
+		if (pending())
+			return 0;
+		advance(1);
+		(*timeout_us)--;
+	}
+
+	return -ETIMEDOUT;
+}
+
+void no_os_udelay(uint32_t usecs)
+{
+	axi_dmac_fake_wakeups++;
+	advance(usecs > min_sleep_us ? usecs : min_sleep_us);
+}
+
+void no_os_mdelay(uint32_t msecs)
+{
+	axi_dmac_fake_wakeups++;
+	advance(msecs * 1000);
+}
+
+struct no_os_time no_os_get_time(void)
+{
+	struct no_os_time t;
+
+	t.s = axi_dmac_fake_time_us / 1000000;
+	t.us = axi_dmac_fake_time_us % 1000000;
+
+	return t;
+}
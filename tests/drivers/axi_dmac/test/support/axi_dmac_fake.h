@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ *   @file   axi_dmac_fake.h
+ *   @brief  Register level model of the AXI DMAC used by the tests.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef AXI_DMAC_FAKE_H
+#define AXI_DMAC_FAKE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Bus addresses are offsets in axi_dmac_fake_mem */
+#define AXI_DMAC_FAKE_MEM_SIZE		0x10000
+/* Transfers the core accepts before reporting its queue full */
+#define AXI_DMAC_FAKE_QUEUE_DEPTH	3
+/* Largest burst, X_LENGTH is 10 bits wide */
+#define AXI_DMAC_FAKE_MAX_LENGTH	0x3FF
+/* Time taken by each transfer */
+#define AXI_DMAC_FAKE_XFER_US		10
+
+extern uint8_t axi_dmac_fake_mem[AXI_DMAC_FAKE_MEM_SIZE];
+
+/* Transfers completed since the last reset */
+extern uint32_t axi_dmac_fake_completed;
+/* Time elapsed in no_os_udelay(), no_os_mdelay() and waits, in us */
+extern uint32_t axi_dmac_fake_time_us;
+/* Calls to no_os_udelay(), no_os_mdelay() and no_os_axi_io_wait_irq() */
+extern uint32_t axi_dmac_fake_wakeups;
+
+/* Reset the core, a memory to memory DMAC with the given features */
+void axi_dmac_fake_reset(bool hw_2d, bool hw_sg);
+
+/* Deliver the unmasked interrupts to isr(dev), NULL to poll the core */
+void axi_dmac_fake_set_isr(void (*isr)(void *), void *dev);
+
+/* Report the interrupts to no_os_axi_io_wait_irq(), like a UIO device */
+void axi_dmac_fake_set_uio(bool uio);
+
+/* Make each no_os_udelay() sleep at least us, like a system call would */
+void axi_dmac_fake_set_min_sleep(uint32_t us);
+
+/* Make no_os_axi_io_batch() fail with err, 0 to let it succeed again */
+void axi_dmac_fake_set_batch_error(int32_t err);
+
+/* Complete the transfer at the head of the queue, false if there is none */
+bool axi_dmac_fake_step(void);
+
+#endif
@@ -0,0 +1,342 @@
+/***************************************************************************//**
+ *   @file   test_axi_dmac.c
+ *   @brief  Unit tests of the AXI DMAC descriptor queue.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "axi_dmac.h"
+#include "axi_dmac_fake.h"
+#include "no_os_alloc.h"
+#include "no_os_axi_io.h"
+#include "no_os_delay.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define NB_DESCS	2
+#define NB_REQUEUES	50
+#define DESC_SIZE	64
+
+static struct axi_dmac *dmac;
+static struct axi_dmac_desc descs[NB_DESCS];
+static uint32_t nb_callbacks;
+static uint32_t nb_requeued;
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+static void dmac_setup(enum use_irq irq_option, bool hw_2d, bool hw_sg)
+{
+	struct axi_dmac_init init = {
+		.name = "test_dmac",
+		.base = 0,
+		.irq_option = irq_option,
+	};
+
+	axi_dmac_fake_reset(hw_2d, hw_sg);
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_init(&dmac, &init));
+	if (irq_option == IRQ_ENABLED)
+		axi_dmac_fake_set_isr(axi_dmac_mem_to_mem_isr, dmac);
+
+	memset(descs, 0, sizeof(descs));
+	nb_callbacks = 0;
+	nb_requeued = 0;
+}
+
+void setUp(void)
+{
+	dmac = NULL;
+}
+
+void tearDown(void)
+{
+	if (dmac)
+		axi_dmac_remove(dmac);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+static void requeue_cb(struct axi_dmac_desc *desc, void *ctx)
+{
+	nb_callbacks++;
+	if (nb_requeued == NB_REQUEUES)
+		return;
+
+	nb_requeued++;
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, desc));
+}
+
+static void queue_requeuing_descs(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < NB_DESCS; i++) {
+		descs[i].src_addr = i * DESC_SIZE;
+		descs[i].dest_addr = 0x8000 + i * DESC_SIZE;
+		descs[i].size = DESC_SIZE;
+		descs[i].callback = requeue_cb;
+		TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[i]));
+	}
+}
+
+void test_axi_dmac_queue_copies_data(void)
+{
+	struct axi_dmac_desc empty = {0};
+	uint32_t i;
+
+	dmac_setup(IRQ_DISABLED, false, false);
+	for (i = 0; i < 0x400; i++)
+		axi_dmac_fake_mem[i] = i * 7;
+
+	/* Three bursts of 0x400 bytes, the core queue is full */
+	descs[0].src_addr = 0;
+	descs[0].dest_addr = 0x4000;
+	descs[0].size = 0x400;
+	descs[1] = descs[0];
+	descs[1].dest_addr = 0x5000;
+	descs[1].size = 0xC00;
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[0]));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, axi_dmac_queue_transfer(dmac, &empty));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[1]));
+
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_wait(dmac, &descs[1], 1000));
+	TEST_ASSERT_TRUE(descs[0].done);
+	TEST_ASSERT_EQUAL_UINT32(4, axi_dmac_fake_completed);
+	TEST_ASSERT_EQUAL_MEMORY(axi_dmac_fake_mem, &axi_dmac_fake_mem[0x4000],
+				 0x400);
+	TEST_ASSERT_EQUAL_MEMORY(axi_dmac_fake_mem, &axi_dmac_fake_mem[0x5000],
+				 0x400);
+}
+
+void test_axi_dmac_wait_returns_io_errors(void)
+{
+	dmac_setup(IRQ_DISABLED, false, false);
+
+	/* Four bursts, the last one is submitted once the first is done */
+	descs[0].src_addr = 0;
+	descs[0].dest_addr = 0x4000;
+	descs[0].size = 0x400;
+	descs[1] = descs[0];
+	descs[1].dest_addr = 0x5000;
+	descs[1].size = 0xC00;
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[0]));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[1]));
+
+	/* The submission fails, without waiting for the timeout */
+	axi_dmac_fake_set_batch_error(-EIO);
+	TEST_ASSERT_EQUAL_INT(-EIO, axi_dmac_wait(dmac, &descs[1], 100000));
+	TEST_ASSERT_TRUE(axi_dmac_fake_time_us < 100000);
+	TEST_ASSERT_FALSE(descs[1].done);
+	axi_dmac_fake_set_batch_error(0);
+}
+
+void test_axi_dmac_requeue_from_callback_poll(void)
+{
+	dmac_setup(IRQ_DISABLED, false, false);
+	queue_requeuing_descs();
+
+	/*
+	 * Complete two transfers per poll, so that the ones queued again from
+	 * the callbacks reuse the IDs of the transfers done before.
+	 */
+	while (axi_dmac_fake_step()) {
+		axi_dmac_fake_step();
+		TEST_ASSERT_TRUE(axi_dmac_poll(dmac) >= 0);
+		TEST_ASSERT_EQUAL_UINT32(axi_dmac_fake_completed, nb_callbacks);
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(NB_DESCS + NB_REQUEUES, nb_callbacks);
+}
+
+void test_axi_dmac_requeue_from_callback_isr(void)
+{
+	uint32_t timeout_us = 100000;
+
+	dmac_setup(IRQ_ENABLED, false, false);
+	queue_requeuing_descs();
+
+	while (nb_callbacks < NB_DESCS + NB_REQUEUES && timeout_us)
+		axi_dmac_wait_event(dmac, &timeout_us);
+
+	TEST_ASSERT_EQUAL_UINT32(NB_DESCS + NB_REQUEUES, nb_callbacks);
+	TEST_ASSERT_EQUAL_UINT32(axi_dmac_fake_completed, nb_callbacks);
+}
+
+void test_axi_dmac_wait_event_uio(void)
+{
+	uint32_t timeout_us = 100000;
+
+	dmac_setup(IRQ_DISABLED, false, false);
+	axi_dmac_fake_set_uio(true);
+	queue_requeuing_descs();
+
+	while (nb_callbacks < NB_DESCS + NB_REQUEUES && timeout_us)
+		axi_dmac_wait_event(dmac, &timeout_us);
+
+	TEST_ASSERT_EQUAL_UINT32(NB_DESCS + NB_REQUEUES, nb_callbacks);
+	/* Woken up by the interrupts, not by polling every us */
+	TEST_ASSERT_TRUE(axi_dmac_fake_wakeups <= 2 * nb_callbacks);
+}
+
+void test_axi_dmac_wait_event_timeout_measured(void)
+{
+	uint32_t timeout_us = 1000;
+	uint32_t nb = 0;
+
+	/* No interrupt to wait for, each 1 us sleep takes 100 us */
+	dmac_setup(IRQ_DISABLED, false, false);
+	axi_dmac_fake_set_min_sleep(100);
+
+	while (axi_dmac_wait_event(dmac, &timeout_us) != -ETIMEDOUT)
+		nb++;
+
+	TEST_ASSERT_EQUAL_UINT32(10, nb);
+	TEST_ASSERT_EQUAL_UINT32(1000, axi_dmac_fake_time_us);
+}
+
+void test_axi_dmac_wait_completion_timeout_measured(void)
+{
+	/* No transfer to complete, each 10 us sleep takes 100 us */
+	dmac_setup(IRQ_ENABLED, false, false);
+	axi_dmac_fake_set_min_sleep(100);
+
+	TEST_ASSERT_EQUAL_INT(-1, axi_dmac_transfer_wait_completion(dmac, 1));
+	TEST_ASSERT_EQUAL_UINT32(1000, axi_dmac_fake_time_us);
+}
+
+static void fill_segments(struct axi_dmac_segment *segs)
+{
+	uint32_t i;
+
+	for (i = 0; i < 0x1000; i++)
+		axi_dmac_fake_mem[i] = i * 3;
+
+	/* 8 rows of 16 bytes out of 64 byte lines, then 0x500 contiguous */
+	segs[0] = (struct axi_dmac_segment) {
+		.src_addr = 0x0,
+		.dest_addr = 0x4000,
+		.x_len = 16,
+		.y_len = 8,
+		.src_stride = 64,
+		.dest_stride = 16,
+	};
+	segs[1] = (struct axi_dmac_segment) {
+		.src_addr = 0x800,
+		.dest_addr = 0x4080,
+		.x_len = 0x500,
+	};
+}
+
+static void check_segments(void)
+{
+	uint32_t row;
+
+	for (row = 0; row < 8; row++)
+		TEST_ASSERT_EQUAL_MEMORY(&axi_dmac_fake_mem[row * 64],
+					 &axi_dmac_fake_mem[0x4000 + row * 16],
+					 16);
+	TEST_ASSERT_EQUAL_MEMORY(&axi_dmac_fake_mem[0x800],
+				 &axi_dmac_fake_mem[0x4080], 0x500);
+}
+
+void test_axi_dmac_segments_registers(void)
+{
+	struct axi_dmac_segment segs[2];
+
+	dmac_setup(IRQ_DISABLED, false, false);
+	fill_segments(segs);
+
+	/* No 2D support: 8 rows, then 0x400 + 0x100 bytes */
+	TEST_ASSERT_EQUAL_UINT32(10, axi_dmac_sg_nb_descs(dmac, segs, 2));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_prep_segments(dmac, &descs[0], segs, 2,
+			      NULL));
+	TEST_ASSERT_EQUAL_UINT32(0x580, descs[0].size);
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[0]));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_wait(dmac, &descs[0], 1000));
+	TEST_ASSERT_EQUAL_UINT32(10, axi_dmac_fake_completed);
+	check_segments();
+	axi_dmac_free_segments(&descs[0]);
+}
+
+void test_axi_dmac_segments_sg(void)
+{
+	struct axi_dmac_segment segs[2];
+	struct axi_dmac_sg_mem sg_mem = {
+		.virt = (struct axi_dmac_hw_desc *)&axi_dmac_fake_mem[0x8000],
+		.phys = 0x8000,
+		.nb_descs = 2,
+	};
+
+	dmac_setup(IRQ_DISABLED, true, true);
+	TEST_ASSERT_TRUE(dmac->hw_2d);
+	TEST_ASSERT_TRUE(dmac->hw_sg);
+	fill_segments(segs);
+
+	/* One 2D descriptor, then 0x400 + 0x100 bytes */
+	TEST_ASSERT_EQUAL_UINT32(3, axi_dmac_sg_nb_descs(dmac, segs, 2));
+	TEST_ASSERT_EQUAL_INT(-ENOSPC, axi_dmac_prep_segments(dmac, &descs[0],
+			      segs, 2, &sg_mem));
+	sg_mem.nb_descs = 3;
+	sg_mem.phys = 0x8020;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, axi_dmac_prep_segments(dmac, &descs[0],
+			      segs, 2, &sg_mem));
+	sg_mem.phys = 0x8000;
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_prep_segments(dmac, &descs[0], segs, 2,
+			      &sg_mem));
+
+	/* The whole chain completes as a single transfer */
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[0]));
+	/* Register transfers wait for the chain to be done */
+	descs[1].src_addr = 0x200;
+	descs[1].dest_addr = 0x6000;
+	descs[1].size = 0x100;
+	TEST_ASSERT_EQUAL_INT(-EBUSY, axi_dmac_queue_transfer(dmac, &descs[1]));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_wait(dmac, &descs[0], 1000));
+	TEST_ASSERT_EQUAL_UINT32(1, axi_dmac_fake_completed);
+	check_segments();
+	axi_dmac_free_segments(&descs[0]);
+
+	/* Then the core is switched back to register transfers */
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_queue_transfer(dmac, &descs[1]));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_wait(dmac, &descs[1], 1000));
+	TEST_ASSERT_EQUAL_MEMORY(&axi_dmac_fake_mem[0x200],
+				 &axi_dmac_fake_mem[0x6000], 0x100);
+}
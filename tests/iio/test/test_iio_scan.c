@@ -0,0 +1,322 @@
+/***************************************************************************//**
+ *   @file   test_iio_scan.c
+ *   @brief  Unit tests of the scan conversion kernels.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iio_scan.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Enough for the vector kernels and a scalar tail */
+#define NB_SCANS	37
+#define MAX_SCAN_BYTES	16
+
+/* One more byte so that the scans can start unaligned */
+static uint8_t scan_mem[NB_SCANS * MAX_SCAN_BYTES + 1];
+static uint8_t expected_mem[NB_SCANS * MAX_SCAN_BYTES + 1];
+static int32_t samples[NB_SCANS];
+static int32_t expected[NB_SCANS];
+static uint32_t seed;
+
+static uint32_t rand_next(void)
+{
+	seed = seed * 1664525 + 1013904223;
+
+	return seed >> 8;
+}
+
+static void rand_fill(void *p, uint32_t len)
+{
+	uint8_t *b = p;
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		b[i] = rand_next();
+}
+
+/* Bit by bit model of the conversions documented in iio_scan.h */
+static int32_t ref_extract(const struct iio_scan_elem *elem, const uint8_t *p)
+{
+	uint64_t val = 0;
+	uint32_t i;
+
+	for (i = 0; i < elem->bytes; i++)
+		val = val << 8 | p[elem->is_big_endian ? i : elem->bytes - 1 - i];
+	val >>= elem->shift;
+	if (elem->realbits < 64)
+		val &= (1ull << elem->realbits) - 1;
+	if (elem->is_signed && elem->realbits < 64 &&
+	    val >> (elem->realbits - 1))
+		val |= ~0ull << elem->realbits;
+
+	return (int32_t)(uint32_t)val;
+}
+
+static void ref_insert(const struct iio_scan_elem *elem, uint8_t *p,
+		       int32_t sample)
+{
+	uint64_t val;
+	uint32_t i;
+
+	val = elem->is_signed ? (uint64_t)(int64_t)sample : (uint32_t)sample;
+	if (elem->realbits < 64)
+		val &= (1ull << elem->realbits) - 1;
+	val <<= elem->shift;
+	for (i = 0; i < elem->bytes; i++)
+		p[elem->is_big_endian ? elem->bytes - 1 - i : i] = val >> (8 * i);
+}
+
+/* Compare the kernels with the model for one layout */
+static void check_layout(const struct iio_scan_elem *elem,
+			 uint32_t bytes_per_scan, uint32_t misalign)
+{
+	uint8_t *scans = scan_mem + misalign;
+	uint8_t *ref = expected_mem + misalign;
+	uint32_t len = NB_SCANS * bytes_per_scan;
+	uint32_t i;
+
+	rand_fill(scans, len);
+	for (i = 0; i < NB_SCANS; i++)
+		expected[i] = ref_extract(elem, scans + i * bytes_per_scan +
+					  elem->offset);
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(elem, bytes_per_scan, scans,
+			      samples, NB_SCANS));
+	TEST_ASSERT_EQUAL_MEMORY(expected, samples, sizeof(expected));
+
+	rand_fill(samples, sizeof(samples));
+	memcpy(ref, scans, len);
+	for (i = 0; i < NB_SCANS; i++)
+		ref_insert(elem, ref + i * bytes_per_scan + elem->offset,
+			   samples[i]);
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_insert(elem, bytes_per_scan, scans,
+			      samples, NB_SCANS));
+	TEST_ASSERT_EQUAL_MEMORY(ref, scans, len);
+}
+
+/* All the layouts of a scan size, vector and scalar kernels included */
+static void check_layouts(uint32_t bytes_per_scan, uint32_t misalign)
+{
+	struct iio_scan_elem elem = { 0 };
+	uint32_t bytes, flags;
+
+	for (bytes = 1; bytes <= 8 && bytes <= bytes_per_scan; bytes++) {
+		elem.bytes = bytes;
+		for (elem.offset = 0; elem.offset + bytes <= bytes_per_scan;
+		     elem.offset++) {
+			for (elem.realbits = 1; elem.realbits <= bytes * 8;
+			     elem.realbits += 7) {
+				for (elem.shift = 0;
+				     elem.realbits + elem.shift <= bytes * 8;
+				     elem.shift += 5) {
+					for (flags = 0; flags < 4; flags++) {
+						elem.is_signed = flags & 1;
+						elem.is_big_endian = flags & 2;
+						check_layout(&elem, bytes_per_scan,
+							     misalign);
+					}
+				}
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	seed = 1;
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iio_scan_check_rejects_bad_layouts(void)
+{
+	struct iio_scan_elem elem = {
+		.offset = 0, .bytes = 2, .realbits = 12, .shift = 4,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(&elem, 2, scan_mem, samples,
+			      1));
+	elem.shift = 5;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_scan_extract(&elem, 2, scan_mem,
+			      samples, 1));
+	elem.shift = 0;
+	elem.offset = 1;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_scan_insert(&elem, 2, scan_mem,
+			      samples, 1));
+	elem.offset = 0;
+	elem.bytes = 9;
+	elem.realbits = 64;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_scan_extract(&elem, 16, scan_mem,
+			      samples, 1));
+	elem.bytes = 2;
+	elem.realbits = 12;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_scan_extract(&elem, 2, NULL, samples,
+			      1));
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(&elem, 2, NULL, samples, 0));
+}
+
+void test_iio_scan_extract_known_values(void)
+{
+	/* 12 bit signed sample shifted by 4 in 16 bits, little endian */
+	struct iio_scan_elem elem = {
+		.offset = 2, .bytes = 2, .realbits = 12, .shift = 4,
+		.is_signed = true,
+	};
+	uint8_t scans[] = {
+		0x00, 0x00, 0xF0, 0xFF,
+		0x00, 0x00, 0xF0, 0x7F,
+		0x00, 0x00, 0x0F, 0x80,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(&elem, 4, scans, samples, 3));
+	TEST_ASSERT_EQUAL_INT(-1, samples[0]);
+	TEST_ASSERT_EQUAL_INT(2047, samples[1]);
+	TEST_ASSERT_EQUAL_INT(-2048, samples[2]);
+
+	elem.is_signed = false;
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(&elem, 4, scans, samples, 3));
+	TEST_ASSERT_EQUAL_INT(4095, samples[0]);
+	TEST_ASSERT_EQUAL_INT(0x800, samples[2]);
+}
+
+void test_iio_scan_64bit_storage(void)
+{
+	/* Timestamp, the 32 lsbs are kept */
+	struct iio_scan_elem ts = {
+		.offset = 8, .bytes = 8, .realbits = 64, .is_signed = true,
+	};
+	/* 40 bit big endian sample shifted by 8 */
+	struct iio_scan_elem be = {
+		.offset = 0, .bytes = 8, .realbits = 40, .shift = 8,
+		.is_signed = true, .is_big_endian = true,
+	};
+	uint8_t scans[16] = {
+		0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0x00,
+		0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+	};
+	uint8_t out[16];
+
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(&ts, 16, scans, samples, 1));
+	TEST_ASSERT_EQUAL_HEX32(0x55667788, samples[0]);
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_extract(&be, 16, scans, samples, 1));
+	TEST_ASSERT_EQUAL_INT(-2, samples[0]);
+
+	/* The bits above 32 are sign extended and the padding is cleared */
+	memset(out, 0xAA, sizeof(out));
+	TEST_ASSERT_EQUAL_INT(0, iio_scan_insert(&be, 16, out, samples, 1));
+	TEST_ASSERT_EQUAL_MEMORY(scans, out, 8);
+	TEST_ASSERT_EQUAL_UINT8(0xAA, out[8]);
+}
+
+void test_iio_scan_kernels_2_byte_scans(void)
+{
+	check_layouts(2, 0);
+	check_layouts(2, 1);
+}
+
+void test_iio_scan_kernels_4_byte_scans(void)
+{
+	check_layouts(4, 0);
+	check_layouts(4, 1);
+	check_layouts(4, 3);
+}
+
+void test_iio_scan_kernels_8_byte_scans(void)
+{
+	check_layouts(8, 0);
+	check_layouts(8, 2);
+}
+
+void test_iio_scan_kernels_odd_scans(void)
+{
+	check_layouts(3, 1);
+	check_layouts(6, 0);
+	check_layouts(12, 3);
+}
+
+void test_iio_buffer_demux_mux(void)
+{
+	struct iio_scan_elem layout[] = {
+		{ .ch = 0, .offset = 0, .bytes = 2, .realbits = 16,
+		  .is_signed = true },
+		{ .ch = 1, .offset = 2, .bytes = 2, .realbits = 14, .shift = 2 },
+		{ .ch = 2, .offset = 8, .bytes = 8, .realbits = 64 },
+	};
+	struct iio_buffer buffer = {
+		.bytes_per_scan = 16,
+		.scan_layout = layout,
+		.nb_scan_elems = NO_OS_ARRAY_SIZE(layout),
+	};
+	static int32_t ch0[NB_SCANS], ch1[NB_SCANS], ch2[NB_SCANS];
+	int32_t *chans[] = { ch0, ch1, ch2 };
+	int32_t *skip[] = { ch0, NULL, ch2 };
+	uint32_t i;
+
+	rand_fill(scan_mem, sizeof(scan_mem));
+	memcpy(expected_mem, scan_mem, sizeof(scan_mem));
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_demux(&buffer, scan_mem + 1, chans,
+			      NB_SCANS));
+	for (i = 0; i < NB_SCANS; i++) {
+		TEST_ASSERT_EQUAL_INT32(ref_extract(&layout[0],
+						    scan_mem + 1 + 16 * i), ch0[i]);
+		TEST_ASSERT_EQUAL_INT32(ref_extract(&layout[1],
+						    scan_mem + 3 + 16 * i), ch1[i]);
+		TEST_ASSERT_EQUAL_INT32(ref_extract(&layout[2],
+						    scan_mem + 9 + 16 * i), ch2[i]);
+	}
+
+	/* The padding of the samples is cleared, NULL channels are kept */
+	for (i = 0; i < NB_SCANS; i++) {
+		ref_insert(&layout[0], expected_mem + 1 + 16 * i, ch0[i]);
+		ref_insert(&layout[2], expected_mem + 9 + 16 * i, ch2[i]);
+	}
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_mux(&buffer, scan_mem + 1, skip,
+			      NB_SCANS));
+	TEST_ASSERT_EQUAL_MEMORY(expected_mem, scan_mem, sizeof(scan_mem));
+}
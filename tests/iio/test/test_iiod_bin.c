@@ -0,0 +1,448 @@
+/***************************************************************************//**
+ *   @file   test_iiod_bin.c
+ *   @brief  Unit tests of the IIOD binary protocol.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iiod.h"
+#include "iiod_private.h"
+#include "no_os_alloc.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Input channels of the "wide" device, more than fit in one mask word */
+#define WIDE_CHANNELS	40
+/* Index of the "adc" device: two input channels and one output channel */
+#define ADC_DEV		1
+
+/*
+ * Command header as laid out by libiio v1 (struct iiod_command in
+ * iiod-responder.h). The client sends it as is, in host byte order.
+ */
+struct libiio_command {
+	uint16_t client_id;
+	uint8_t op;
+	uint8_t dev;
+	int32_t code;
+};
+
+/* libiio v1 opcodes (enum iiod_opcode) used by a capture session */
+enum libiio_opcode {
+	LIBIIO_OP_RESPONSE = 0,
+	LIBIIO_OP_PRINT = 1,
+	LIBIIO_OP_READ_ATTR = 3,
+	LIBIIO_OP_CREATE_BUFFER = 13,
+	LIBIIO_OP_FREE_BUFFER = 14,
+	LIBIIO_OP_ENABLE_BUFFER = 15,
+	LIBIIO_OP_DISABLE_BUFFER = 16,
+	LIBIIO_OP_CREATE_BLOCK = 17,
+	LIBIIO_OP_FREE_BLOCK = 18,
+	LIBIIO_OP_TRANSFER_BLOCK = 19,
+};
+
+static char xml[8192];
+static char payload[512];
+
+/* Bytes sent by the client and not read by the server yet */
+static uint8_t rx[1024];
+static uint32_t rx_len, rx_idx;
+/* Bytes sent by the server and not checked by the test yet */
+static uint8_t tx[sizeof(xml) + 1024];
+static uint32_t tx_len, tx_idx;
+
+static struct iiod_desc *iiod;
+static uint32_t conn_id;
+
+/* Buffer callbacks seen by the application */
+static uint32_t open_samples, open_mask, nb_close;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static int test_send(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
+{
+	len = no_os_min(len, sizeof(tx) - tx_len);
+	memcpy(tx + tx_len, buf, len);
+	tx_len += len;
+
+	return len;
+}
+
+static int test_recv(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
+{
+	len = no_os_min(len, rx_len - rx_idx);
+	if (!len)
+		return -EAGAIN;
+
+	memcpy(buf, rx + rx_idx, len);
+	rx_idx += len;
+
+	return len;
+}
+
+static int test_open(struct iiod_ctx *ctx, const char *device,
+		     uint32_t samples, const uint32_t *mask, bool cyclic)
+{
+	open_samples = samples;
+	open_mask = mask[0];
+
+	return 0;
+}
+
+static int test_close(struct iiod_ctx *ctx, const char *device)
+{
+	nb_close++;
+
+	return 0;
+}
+
+static int test_refill(struct iiod_ctx *ctx, const char *device)
+{
+	return 0;
+}
+
+/* Samples are a byte counter */
+static int test_read_buffer(struct iiod_ctx *ctx, const char *device,
+			    char *buf, uint32_t bytes)
+{
+	uint32_t i;
+
+	for (i = 0; i < bytes; i++)
+		buf[i] = i;
+
+	return bytes;
+}
+
+static int test_read_attr(struct iiod_ctx *ctx, const char *device,
+			  struct iiod_attr *attr, char *buf, uint32_t len)
+{
+	if (strcmp(device, "iio:device1") ||
+	    attr->type != IIO_ATTR_TYPE_DEVICE ||
+	    strcmp(attr->name, "sampling_frequency"))
+		return -ENOENT;
+
+	return snprintf(buf, len, "1000");
+}
+
+static struct iiod_ops test_ops = {
+	.send = test_send,
+	.recv = test_recv,
+	.open = test_open,
+	.close = test_close,
+	.refill_buffer = test_refill,
+	.read_buffer = test_read_buffer,
+	.read_attr = test_read_attr,
+};
+
+static void xml_add(const char *str)
+{
+	strncat(xml, str, sizeof(xml) - strlen(xml) - 1);
+}
+
+/*
+ * Device 0: WIDE_CHANNELS input channels of 16 bits.
+ * Device 1: two 16 bit input channels, one output channel and an attribute.
+ */
+static void xml_build(void)
+{
+	char chn[160];
+	uint32_t i;
+
+	xml[0] = '\0';
+	xml_add("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+		"<context name=\"xml\"><device id=\"iio:device0\" "
+		"name=\"wide\">");
+	for (i = 0; i < WIDE_CHANNELS; i++) {
+		snprintf(chn, sizeof(chn), "<channel id=\"voltage%u\" "
+			 "type=\"input\"><scan-element index=\"%u\" "
+			 "format=\"le:s16/16&gt;&gt;0\" /></channel>",
+			 (unsigned int)i, (unsigned int)i);
+		xml_add(chn);
+	}
+	xml_add("</device><device id=\"iio:device1\" name=\"adc\">"
+		"<channel id=\"voltage0\" type=\"input\"><scan-element "
+		"index=\"0\" format=\"le:s16/16&gt;&gt;0\" /></channel>"
+		"<channel id=\"voltage1\" type=\"input\"><scan-element "
+		"index=\"1\" format=\"le:s16/16&gt;&gt;0\" /></channel>"
+		"<channel id=\"altvoltage0\" type=\"output\"><scan-element "
+		"index=\"2\" format=\"le:s16/16&gt;&gt;0\" /></channel>"
+		"<attribute name=\"sampling_frequency\" />"
+		"</device></context>");
+}
+
+/* Queue bytes sent by the client */
+static void client_send(const void *data, uint32_t len)
+{
+	TEST_ASSERT_TRUE(rx_len + len <= sizeof(rx));
+	memcpy(rx + rx_len, data, len);
+	rx_len += len;
+}
+
+/* Queue a binary command header, as little endian bytes */
+static void client_cmd(uint16_t client_id, uint8_t op, uint8_t dev,
+		       int32_t code)
+{
+	uint8_t hdr[IIOD_BIN_CMD_SIZE];
+
+	no_os_put_unaligned_le16(client_id, hdr);
+	hdr[2] = op;
+	hdr[3] = dev;
+	no_os_put_unaligned_le32(code, hdr + 4);
+	client_send(hdr, sizeof(hdr));
+}
+
+/* Queue a command the way a libiio v1 client frames it */
+static void libiio_cmd(uint16_t client_id, uint8_t op, uint8_t dev,
+		       int32_t code)
+{
+	struct libiio_command cmd = {
+		.client_id = client_id,
+		.op = op,
+		.dev = dev,
+		.code = code,
+	};
+
+	client_send(&cmd, sizeof(cmd));
+}
+
+/* 64 bit argument of a libiio v1 command, in host byte order */
+static void libiio_arg(uint64_t arg)
+{
+	client_send(&arg, sizeof(arg));
+}
+
+/* Step the connection until the client data is consumed and replied to */
+static void server_run(void)
+{
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < 100; i++) {
+		ret = iiod_conn_step(iiod, conn_id);
+		if (ret == -EAGAIN && rx_idx == rx_len)
+			break;
+		TEST_ASSERT_TRUE(ret == -EAGAIN || !NO_OS_IS_ERR_VALUE(ret));
+	}
+}
+
+/* Check the next response header */
+static void client_response(uint16_t client_id, int32_t code)
+{
+	uint8_t *hdr = tx + tx_idx;
+
+	TEST_ASSERT_TRUE(tx_len - tx_idx >= IIOD_BIN_CMD_SIZE);
+	tx_idx += IIOD_BIN_CMD_SIZE;
+	TEST_ASSERT_EQUAL_UINT32(client_id, no_os_get_unaligned_le16(hdr));
+	TEST_ASSERT_EQUAL_UINT32(IIOD_BIN_OP_RESPONSE, hdr[2]);
+	TEST_ASSERT_EQUAL_INT32(code, (int32_t)no_os_get_unaligned_le32(hdr + 4));
+}
+
+/* Read the data following a response */
+static void client_data(void *data, uint32_t len)
+{
+	TEST_ASSERT_TRUE(tx_len - tx_idx >= len);
+	memcpy(data, tx + tx_idx, len);
+	tx_idx += len;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct iiod_init_param param = { .ops = &test_ops };
+	struct iiod_conn_data data = { .buf = payload, .len = sizeof(payload) };
+
+	rx_len = rx_idx = tx_len = tx_idx = 0;
+	open_samples = open_mask = nb_close = 0;
+	xml_build();
+	param.xml = xml;
+	param.xml_len = strlen(xml);
+	TEST_ASSERT_EQUAL_INT(0, iiod_init(&iiod, &param));
+	TEST_ASSERT_EQUAL_INT(0, iiod_conn_add(iiod, &data, &conn_id));
+
+	/* Negotiate the binary protocol */
+	client_send("BINARY\r\n", 8);
+	server_run();
+	TEST_ASSERT_EQUAL_UINT32(2, tx_len);
+	TEST_ASSERT_EQUAL_MEMORY("0\n", tx, 2);
+	tx_idx = tx_len;
+}
+
+void tearDown(void)
+{
+	struct iiod_conn_data data;
+
+	iiod_conn_remove(iiod, conn_id, &data);
+	iiod_remove(iiod);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iiod_bin_create_buffer_clips_mask(void)
+{
+	uint8_t mask[8];
+
+	/* Bits above the last channel of the device are dropped */
+	client_cmd(1, IIOD_BIN_OP_CREATE_BUFFER, 0, 0);
+	memset(mask, 0xFF, sizeof(mask));
+	client_send(mask, sizeof(mask));
+	server_run();
+	client_response(1, sizeof(mask));
+	client_data(mask, sizeof(mask));
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, no_os_get_unaligned_le32(mask));
+	TEST_ASSERT_EQUAL_HEX32(NO_OS_BIT(WIDE_CHANNELS % 32) - 1,
+				no_os_get_unaligned_le32(mask + 4));
+	client_cmd(2, IIOD_BIN_OP_FREE_BUFFER, 0, 0);
+	server_run();
+	client_response(2, 0);
+
+	/* A mask without any channel of the device is rejected */
+	client_cmd(3, IIOD_BIN_OP_CREATE_BUFFER, 0, 0);
+	no_os_put_unaligned_le32(0, mask);
+	no_os_put_unaligned_le32(~(NO_OS_BIT(WIDE_CHANNELS % 32) - 1),
+				 mask + 4);
+	client_send(mask, sizeof(mask));
+	server_run();
+	client_response(3, -EINVAL);
+	TEST_ASSERT_EQUAL_UINT32(tx_len, tx_idx);
+}
+
+void test_iiod_bin_create_buffer_rejects_mixed_directions(void)
+{
+	uint8_t mask[4];
+
+	/* An input and an output channel */
+	client_cmd(1, IIOD_BIN_OP_CREATE_BUFFER, ADC_DEV, 0);
+	no_os_put_unaligned_le32(NO_OS_BIT(0) | NO_OS_BIT(2), mask);
+	client_send(mask, sizeof(mask));
+	server_run();
+	client_response(1, -EINVAL);
+
+	/* The buffer id was not taken */
+	client_cmd(2, IIOD_BIN_OP_CREATE_BUFFER, ADC_DEV, 0);
+	no_os_put_unaligned_le32(NO_OS_BIT(2), mask);
+	client_send(mask, sizeof(mask));
+	server_run();
+	client_response(2, sizeof(mask));
+	client_data(mask, sizeof(mask));
+	TEST_ASSERT_EQUAL_HEX32(NO_OS_BIT(2), no_os_get_unaligned_le32(mask));
+	TEST_ASSERT_EQUAL_UINT32(tx_len, tx_idx);
+}
+
+/*
+ * Replay the commands a libiio v1 client sends to capture one block:
+ * iio_create_context, iio_device_create_buffer, iio_buffer_create_block,
+ * iio_buffer_enable, iio_block_enqueue/dequeue and the matching destroys.
+ * The frames are built from the libiio v1 structures and opcodes, not from
+ * the ones of this server.
+ */
+void test_iiod_bin_libiio_session(void)
+{
+	char data[64], attr[8];
+	uint32_t mask, i;
+
+	TEST_ASSERT_EQUAL_UINT32(IIOD_BIN_CMD_SIZE,
+				 sizeof(struct libiio_command));
+	TEST_ASSERT_EQUAL_UINT32(LIBIIO_OP_RESPONSE, IIOD_BIN_OP_RESPONSE);
+
+	/* The context XML */
+	libiio_cmd(1, LIBIIO_OP_PRINT, 0, 0);
+	server_run();
+	client_response(1, strlen(xml));
+	TEST_ASSERT_EQUAL_MEMORY(xml, tx + tx_idx, strlen(xml));
+	tx_idx += strlen(xml);
+
+	/* Device attribute 0 of the "adc" device */
+	libiio_cmd(2, LIBIIO_OP_READ_ATTR, ADC_DEV, 0);
+	server_run();
+	client_response(2, 4);
+	client_data(attr, 4);
+	TEST_ASSERT_EQUAL_MEMORY("1000", attr, 4);
+
+	/* Buffer 0 with both input channels */
+	libiio_cmd(3, LIBIIO_OP_CREATE_BUFFER, ADC_DEV, 0);
+	mask = 0x3;
+	client_send(&mask, sizeof(mask));
+	server_run();
+	client_response(3, sizeof(mask));
+	client_data(&mask, sizeof(mask));
+	TEST_ASSERT_EQUAL_HEX32(0x3, mask);
+
+	/* Block 0 of buffer 0 */
+	libiio_cmd(4, LIBIIO_OP_CREATE_BLOCK, ADC_DEV, 0 << 16 | 0);
+	libiio_arg(sizeof(data));
+	server_run();
+	client_response(4, 0);
+
+	libiio_cmd(5, LIBIIO_OP_ENABLE_BUFFER, ADC_DEV, 0);
+	server_run();
+	client_response(5, 0);
+
+	/* Input data follows the response */
+	libiio_cmd(6, LIBIIO_OP_TRANSFER_BLOCK, ADC_DEV, 0 << 16 | 0);
+	libiio_arg(sizeof(data));
+	server_run();
+	TEST_ASSERT_EQUAL_UINT32(sizeof(data) / 4, open_samples);
+	TEST_ASSERT_EQUAL_HEX32(0x3, open_mask);
+	client_response(6, sizeof(data));
+	client_data(data, sizeof(data));
+	for (i = 0; i < sizeof(data); i++)
+		TEST_ASSERT_EQUAL_HEX8(i, data[i]);
+
+	libiio_cmd(7, LIBIIO_OP_DISABLE_BUFFER, ADC_DEV, 0);
+	server_run();
+	client_response(7, 0);
+	TEST_ASSERT_EQUAL_UINT32(1, nb_close);
+
+	libiio_cmd(8, LIBIIO_OP_FREE_BLOCK, ADC_DEV, 0 << 16 | 0);
+	server_run();
+	client_response(8, 0);
+
+	libiio_cmd(9, LIBIIO_OP_FREE_BUFFER, ADC_DEV, 0);
+	server_run();
+	client_response(9, 0);
+	TEST_ASSERT_EQUAL_UINT32(tx_len, tx_idx);
+}
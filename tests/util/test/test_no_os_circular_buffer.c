@@ -0,0 +1,407 @@
+/***************************************************************************//**
+ *   @file   test_no_os_circular_buffer.c
+ *   @brief  Unit tests of the circular buffer SPSC mode.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_alloc.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define CB_SIZE		64
+
+static struct no_os_circular_buffer cb;
+static int8_t cb_mem[CB_SIZE];
+static uint8_t in[4 * CB_SIZE];
+static uint8_t out[4 * CB_SIZE];
+
+/* Threaded tests: bytes passed from a producer to a consumer thread */
+#define STRESS_CB_SIZE	1024
+#define STRESS_BYTES	(4 * 1024 * 1024)
+#define BENCH_CB_SIZE	16384
+#define BENCH_CHUNK	1024
+#define BENCH_BYTES	(64 * 1024 * 1024)
+
+struct spsc_thread {
+	struct no_os_circular_buffer	*cb;
+	uint32_t			nb_bytes;
+	uint32_t			chunk;
+	bool				async;
+	uint32_t			errors;
+};
+
+static int8_t stress_mem[BENCH_CB_SIZE];
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Chunk sizes from a small LCG, the same sequence on both sides */
+static uint32_t spsc_next_chunk(uint32_t *seed, uint32_t max)
+{
+	*seed = *seed * 1103515245 + 12345;
+
+	return (*seed >> 16) % max + 1;
+}
+
+static void *spsc_producer(void *arg)
+{
+	struct spsc_thread *t = arg;
+	uint32_t seed = 1, pos = 0, len, avail, i;
+	uint8_t chunk[STRESS_CB_SIZE];
+	uint8_t *buff;
+
+	while (pos < t->nb_bytes) {
+		len = t->chunk ? t->chunk : spsc_next_chunk(&seed, 300);
+		len = no_os_min(len, t->nb_bytes - pos);
+
+		if (t->async) {
+			if (no_os_cb_prepare_async_write(t->cb, len,
+							 (void **)&buff,
+							 &avail)) {
+				sched_yield();
+				continue;
+			}
+			for (i = 0; i < avail; i++)
+				buff[i] = (uint8_t)(pos + i);
+			no_os_cb_end_async_write(t->cb);
+			pos += avail;
+			continue;
+		}
+
+		for (i = 0; i < len; i++)
+			chunk[i] = (uint8_t)(pos + i);
+		while (no_os_cb_write(t->cb, chunk, len) == -EAGAIN)
+			sched_yield();
+		pos += len;
+	}
+
+	return NULL;
+}
+
+static void *spsc_consumer(void *arg)
+{
+	struct spsc_thread *t = arg;
+	uint32_t seed = 7, pos = 0, len, avail, i;
+	uint8_t chunk[STRESS_CB_SIZE];
+	uint8_t *buff;
+
+	while (pos < t->nb_bytes) {
+		len = t->chunk ? t->chunk : spsc_next_chunk(&seed, 300);
+		len = no_os_min(len, t->nb_bytes - pos);
+
+		if (t->async) {
+			if (no_os_cb_prepare_async_read(t->cb, len,
+							(void **)&buff,
+							&avail)) {
+				sched_yield();
+				continue;
+			}
+			for (i = 0; i < avail; i++)
+				if (buff[i] != (uint8_t)(pos + i))
+					t->errors++;
+			no_os_cb_end_async_read(t->cb);
+			pos += avail;
+			continue;
+		}
+
+		while (no_os_cb_read(t->cb, chunk, len) == -EAGAIN)
+			sched_yield();
+		if (t->chunk)
+			/* Throughput run, only check the chunk boundaries */
+			t->errors += chunk[0] != (uint8_t)pos ||
+				     chunk[len - 1] != (uint8_t)(pos + len - 1);
+		else
+			for (i = 0; i < len; i++)
+				if (chunk[i] != (uint8_t)(pos + i))
+					t->errors++;
+		pos += len;
+	}
+
+	return NULL;
+}
+
+/* Run a producer and a consumer thread on desc and check the data received */
+static void spsc_run(struct no_os_circular_buffer *desc, uint32_t nb_bytes,
+		     uint32_t chunk, bool async)
+{
+	struct spsc_thread prod = {
+		.cb = desc, .nb_bytes = nb_bytes, .chunk = chunk, .async = async
+	};
+	struct spsc_thread cons = prod;
+	pthread_t tp, tc;
+
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&tc, NULL, spsc_consumer,
+					       &cons));
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&tp, NULL, spsc_producer,
+					       &prod));
+	pthread_join(tp, NULL);
+	pthread_join(tc, NULL);
+
+	TEST_ASSERT_EQUAL_UINT32(0, cons.errors);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = i;
+	memset(out, 0, sizeof(out));
+	memset(cb_mem, 0, sizeof(cb_mem));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg_mode(&cb, cb_mem, CB_SIZE,
+			      NO_OS_CB_SPSC));
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_no_os_cb_spsc_needs_power_of_two(void)
+{
+	struct no_os_circular_buffer *desc;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_cfg_mode(&cb, cb_mem, 48,
+			      NO_OS_CB_SPSC));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_cfg_mode(&cb, cb_mem, 0,
+			      NO_OS_CB_SPSC));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg_mode(&cb, cb_mem, 48,
+			      NO_OS_CB_DEFAULT));
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_init_mode(&desc, 100,
+			      NO_OS_CB_SPSC));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_init_mode(&desc, 128, NO_OS_CB_SPSC));
+	TEST_ASSERT_EQUAL_INT(NO_OS_CB_SPSC, desc->mode);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_remove(desc));
+}
+
+void test_no_os_cb_spsc_write_read_wrap(void)
+{
+	uint32_t size, i;
+
+	/* Chunks of odd sizes, wrapping around the end of the buffer */
+	for (i = 0; i < 10; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in, 37));
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in + 37, 11));
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+		TEST_ASSERT_EQUAL_UINT32(48, size);
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&cb, out, 48));
+		TEST_ASSERT_EQUAL_MEMORY(in, out, 48);
+	}
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+	TEST_ASSERT_EQUAL_UINT32(480, cb.write.idx);
+	TEST_ASSERT_EQUAL_UINT32(480, cb.read.idx);
+}
+
+void test_no_os_cb_spsc_full_and_empty(void)
+{
+	uint32_t size;
+
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_read(&cb, out, 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in, CB_SIZE));
+
+	/* All or nothing, unread data is never overwritten */
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_write(&cb, in + CB_SIZE, 1));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_read(&cb, out, CB_SIZE + 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(CB_SIZE, size);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&cb, out, CB_SIZE));
+	TEST_ASSERT_EQUAL_MEMORY(in, out, CB_SIZE);
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_read(&cb, out, 1));
+}
+
+void test_no_os_cb_spsc_async_spans(void)
+{
+	uint32_t avail;
+	void *buff;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in, 48));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&cb, out, 40));
+
+	/* A span stops at the end of the buffer */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_write(&cb, 32, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_UINT32(16, avail);
+	TEST_ASSERT_EQUAL_PTR(cb_mem + 48, buff);
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_prepare_async_write(&cb, 32,
+			      &buff, &avail));
+	memcpy(buff, in + 48, avail);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_write(&cb));
+
+	/* Then restarts at its beginning, up to the unread data */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_write(&cb, 64, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_UINT32(40, avail);
+	TEST_ASSERT_EQUAL_PTR(cb_mem, buff);
+	memcpy(buff, in + 64, avail);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_write(&cb));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_prepare_async_write(&cb, 1,
+			      &buff, &avail));
+	TEST_ASSERT_EQUAL_UINT32(0, avail);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_read(&cb, 64, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_UINT32(24, avail);
+	TEST_ASSERT_EQUAL_MEMORY(in + 40, buff, avail);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_read(&cb));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&cb, out, 40));
+	TEST_ASSERT_EQUAL_MEMORY(in + 64, out, 40);
+
+	/* Ending a transaction that was not started */
+	TEST_ASSERT_EQUAL_INT(-1, no_os_cb_end_async_read(&cb));
+}
+
+void test_no_os_cb_async_cancel(void)
+{
+	struct no_os_circular_buffer plain;
+	uint32_t size, avail;
+	void *buff;
+
+	/* A cancelled write publishes nothing and can be prepared again */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_write(&cb, 16, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cancel_async_write(&cb));
+	TEST_ASSERT_EQUAL_INT(-1, no_os_cb_cancel_async_write(&cb));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_write(&cb, 16, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_PTR(cb_mem, buff);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_write(&cb));
+
+	/* A cancelled read consumes nothing */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_read(&cb, 8, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cancel_async_read(&cb));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(16, size);
+
+	/* Same in the default mode */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg(&plain, cb_mem, 48));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&plain, in, 8));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_read(&plain, 8, &buff,
+			      &avail));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cancel_async_read(&plain));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&plain, out, 8));
+	TEST_ASSERT_EQUAL_MEMORY(in, out, 8);
+}
+
+void test_no_os_cb_spsc_index_overflow(void)
+{
+	uint32_t size, i;
+
+	/* The free running indexes wrap around UINT32_MAX */
+	cb.write.idx = UINT32_MAX - 20;
+	cb.read.idx = UINT32_MAX - 20;
+
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in, 50));
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+		TEST_ASSERT_EQUAL_UINT32(50, size);
+		TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_write(&cb, in, 15));
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&cb, out, 50));
+		TEST_ASSERT_EQUAL_MEMORY(in, out, 50);
+	}
+}
+
+void test_no_os_cb_default_mode_overwrites(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg(&cb, cb_mem, CB_SIZE));
+	TEST_ASSERT_EQUAL_INT(NO_OS_CB_DEFAULT, cb.mode);
+
+	/* The writer never waits, the reader sees the overrun */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in, CB_SIZE));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&cb, in + CB_SIZE, 16));
+	TEST_ASSERT_EQUAL_INT(-NO_OS_EOVERRUN, no_os_cb_read(&cb, out, 16));
+}
+
+void test_no_os_cb_spsc_threads(void)
+{
+	uint32_t size;
+
+	/* Copy API on both sides, random chunk sizes */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg_mode(&cb, stress_mem,
+			      STRESS_CB_SIZE, NO_OS_CB_SPSC));
+	spsc_run(&cb, STRESS_BYTES, 0, false);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+
+	/* In-place spans on both sides */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg_mode(&cb, stress_mem,
+			      STRESS_CB_SIZE, NO_OS_CB_SPSC));
+	spsc_run(&cb, STRESS_BYTES, 0, true);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+}
+
+void test_no_os_cb_spsc_throughput(void)
+{
+	struct timespec start, end;
+	char msg[80];
+	double sec;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg_mode(&cb, stress_mem,
+			      BENCH_CB_SIZE, NO_OS_CB_SPSC));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	spsc_run(&cb, BENCH_BYTES, BENCH_CHUNK, false);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	sec = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	snprintf(msg, sizeof(msg), "SPSC %u byte chunks: %.0f MB/s",
+		 BENCH_CHUNK, BENCH_BYTES / sec / 1e6);
+	TEST_MESSAGE(msg);
+}
@@ -0,0 +1,251 @@
+/***************************************************************************//**
+ *   @file   test_no_os_lf_ring.c
+ *   @brief  Unit tests of the lock-free ring and lf256fifo.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_lf_ring.h"
+#include "no_os_lf256fifo.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define RING_DEPTH	8
+
+struct sample {
+	uint32_t id;
+	uint16_t value;
+	uint8_t channel;
+};
+
+NO_OS_LF_RING_DEFINE(u16_ring, uint16_t)
+
+static struct no_os_lf_ring ring;
+static struct sample ring_mem[RING_DEPTH];
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_cfg(&ring, ring_mem,
+			      sizeof(struct sample), RING_DEPTH));
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_no_os_lf_ring_cfg_checks_depth(void)
+{
+	struct no_os_lf_ring *r;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_cfg(&ring, ring_mem,
+			      sizeof(struct sample), 6));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_cfg(&ring, ring_mem, 0,
+			      RING_DEPTH));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_init(&r, 4, 0));
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&r, 4, 16));
+	TEST_ASSERT_TRUE(r->allocated);
+	TEST_ASSERT_EQUAL_UINT32(16, no_os_lf_ring_space(r));
+	no_os_lf_ring_remove(r);
+}
+
+void test_no_os_lf_ring_single_elements(void)
+{
+	struct sample s = {0}, r;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_lf_ring_read(&ring, &r));
+	for (i = 0; i < RING_DEPTH; i++) {
+		s.id = i;
+		s.value = i * 100;
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write(&ring, &s));
+	}
+
+	/* Full, the element is dropped and counted */
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_lf_ring_write(&ring, &s));
+	TEST_ASSERT_EQUAL_UINT32(1, ring.overflows);
+	TEST_ASSERT_EQUAL_UINT32(RING_DEPTH, ring.high_watermark);
+	TEST_ASSERT_EQUAL_UINT32(RING_DEPTH, no_os_lf_ring_count(&ring));
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_lf_ring_space(&ring));
+
+	for (i = 0; i < RING_DEPTH; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_read(&ring, &r));
+		TEST_ASSERT_EQUAL_UINT32(i, r.id);
+		TEST_ASSERT_EQUAL_UINT16(i * 100, r.value);
+	}
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_lf_ring_read(&ring, &r));
+}
+
+void test_no_os_lf_ring_bulk_wrap(void)
+{
+	struct sample in[RING_DEPTH + 2], out[RING_DEPTH + 2];
+	uint32_t i, j;
+
+	memset(in, 0, sizeof(in));
+	for (i = 0; i < NO_OS_ARRAY_SIZE(in); i++) {
+		in[i].id = i;
+		in[i].value = i ^ 0x5A5A;
+		in[i].channel = i % 4;
+	}
+
+	/* Bulk accesses of 5 elements split in two spans every other time */
+	for (j = 0; j < 10; j++) {
+		TEST_ASSERT_EQUAL_UINT32(5, no_os_lf_ring_write_bulk(&ring, in, 5));
+		memset(out, 0, sizeof(out));
+		TEST_ASSERT_EQUAL_UINT32(5, no_os_lf_ring_read_bulk(&ring, out,
+					 RING_DEPTH));
+		TEST_ASSERT_EQUAL_MEMORY(in, out, 5 * sizeof(in[0]));
+	}
+
+	/* Only the elements that fit are written */
+	TEST_ASSERT_EQUAL_UINT32(RING_DEPTH,
+				 no_os_lf_ring_write_bulk(&ring, in,
+						 NO_OS_ARRAY_SIZE(in)));
+	TEST_ASSERT_EQUAL_UINT32(2, ring.overflows);
+	TEST_ASSERT_EQUAL_UINT32(RING_DEPTH,
+				 no_os_lf_ring_read_bulk(&ring, out,
+						 NO_OS_ARRAY_SIZE(out)));
+	TEST_ASSERT_EQUAL_MEMORY(in, out, RING_DEPTH * sizeof(in[0]));
+}
+
+void test_no_os_lf_ring_spans(void)
+{
+	struct sample s = {0};
+	void *span;
+	uint32_t i;
+
+	for (i = 0; i < 6; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write(&ring, &s));
+	TEST_ASSERT_EQUAL_UINT32(6, no_os_lf_ring_read_span(&ring, &span));
+	TEST_ASSERT_EQUAL_PTR(ring_mem, span);
+	no_os_lf_ring_read_release(&ring, 6);
+
+	/* The free space wraps, the first span stops at the end */
+	TEST_ASSERT_EQUAL_UINT32(2, no_os_lf_ring_write_span(&ring, &span));
+	TEST_ASSERT_EQUAL_PTR(&ring_mem[6], span);
+	((struct sample *)span)[0].id = 6;
+	((struct sample *)span)[1].id = 7;
+	no_os_lf_ring_write_commit(&ring, 2);
+	TEST_ASSERT_EQUAL_UINT32(RING_DEPTH - 2,
+				 no_os_lf_ring_write_span(&ring, &span));
+	TEST_ASSERT_EQUAL_PTR(ring_mem, span);
+	((struct sample *)span)[0].id = 8;
+	no_os_lf_ring_write_commit(&ring, 1);
+
+	TEST_ASSERT_EQUAL_UINT32(3, no_os_lf_ring_count(&ring));
+	TEST_ASSERT_EQUAL_UINT32(2, no_os_lf_ring_read_span(&ring, &span));
+	TEST_ASSERT_EQUAL_UINT32(7, ((struct sample *)span)[1].id);
+	no_os_lf_ring_read_release(&ring, 2);
+	TEST_ASSERT_EQUAL_UINT32(1, no_os_lf_ring_read_span(&ring, &span));
+	TEST_ASSERT_EQUAL_UINT32(8, ((struct sample *)span)[0].id);
+
+	no_os_lf_ring_flush(&ring);
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_lf_ring_count(&ring));
+}
+
+void test_no_os_lf_ring_counter_overflow(void)
+{
+	struct sample s = {0}, r;
+	uint32_t i;
+
+	/* head and tail run freely and wrap around UINT32_MAX */
+	ring.head = UINT32_MAX - 3;
+	ring.tail = UINT32_MAX - 3;
+	for (i = 0; i < 3 * RING_DEPTH; i++) {
+		s.id = i;
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write(&ring, &s));
+		TEST_ASSERT_EQUAL_UINT32(1, no_os_lf_ring_count(&ring));
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_read(&ring, &r));
+		TEST_ASSERT_EQUAL_UINT32(i, r.id);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, ring.overflows);
+}
+
+void test_no_os_lf_ring_typed(void)
+{
+	struct no_os_lf_ring *r;
+	uint16_t vals[3] = {1, 2, 3}, out[4], v;
+
+	TEST_ASSERT_EQUAL_INT(0, u16_ring_init(&r, 4));
+	TEST_ASSERT_EQUAL_INT(0, u16_ring_write(r, 0xBEEF));
+	TEST_ASSERT_EQUAL_UINT32(3, u16_ring_write_bulk(r, vals, 3));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, u16_ring_write(r, 4));
+	TEST_ASSERT_EQUAL_INT(0, u16_ring_read(r, &v));
+	TEST_ASSERT_EQUAL_HEX16(0xBEEF, v);
+	TEST_ASSERT_EQUAL_UINT32(3, u16_ring_read_bulk(r, out, 4));
+	TEST_ASSERT_EQUAL_UINT16_ARRAY(vals, out, 3);
+	no_os_lf_ring_remove(r);
+}
+
+void test_lf256fifo(void)
+{
+	struct lf256fifo *fifo;
+	uint8_t out[300];
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, lf256fifo_init(NULL));
+	TEST_ASSERT_EQUAL_INT(0, lf256fifo_init(&fifo));
+	TEST_ASSERT_TRUE(lf256fifo_is_empty(fifo));
+
+	/* It holds 256 bytes */
+	for (i = 0; i < 256; i++)
+		TEST_ASSERT_EQUAL_INT(0, lf256fifo_write(fifo, i));
+	TEST_ASSERT_TRUE(lf256fifo_is_full(fifo));
+	TEST_ASSERT_EQUAL_INT(-1, lf256fifo_write(fifo, 0));
+
+	TEST_ASSERT_EQUAL_INT(0, lf256fifo_read(fifo, out));
+	TEST_ASSERT_EQUAL_UINT8(0, out[0]);
+	TEST_ASSERT_EQUAL_UINT32(255, lf256fifo_read_bulk(fifo, out,
+				 sizeof(out)));
+	for (i = 0; i < 255; i++)
+		TEST_ASSERT_EQUAL_UINT8(i + 1, out[i]);
+	TEST_ASSERT_TRUE(lf256fifo_is_empty(fifo));
+
+	TEST_ASSERT_EQUAL_INT(0, lf256fifo_write(fifo, 42));
+	lf256fifo_flush(fifo);
+	TEST_ASSERT_TRUE(lf256fifo_is_empty(fifo));
+	lf256fifo_remove(fifo);
+}
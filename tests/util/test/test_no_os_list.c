@@ -0,0 +1,252 @@
+/***************************************************************************//**
+ *   @file   test_no_os_list.c
+ *   @brief  Unit tests of the intrusive list, the heap and the map.
+********************************************************************************
+ * Copyright 2025(c) Analog Devices, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES, INC. “AS IS” AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ANALOG DEVICES, INC. BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_list.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+struct item {
+	int32_t value;
+	struct no_os_ilist_node node;
+};
+
+static struct item items[5];
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < NO_OS_ARRAY_SIZE(items); i++) {
+		items[i].value = i;
+		no_os_ilist_init(&items[i].node);
+	}
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+static int32_t cmp_values(void *data1, void *data2)
+{
+	int32_t a = *(int32_t *)data1;
+	int32_t b = *(int32_t *)data2;
+
+	return (a > b) - (a < b);
+}
+
+/* Check the values of the list, in both directions */
+static void check_ilist(struct no_os_ilist_node *head, const int32_t *values,
+			uint32_t nb)
+{
+	struct no_os_ilist_node *pos;
+	uint32_t i = 0;
+
+	no_os_ilist_for_each(pos, head) {
+		TEST_ASSERT_TRUE(i < nb);
+		TEST_ASSERT_EQUAL_INT32(values[i],
+					no_os_ilist_entry(pos, struct item,
+							node)->value);
+		i++;
+	}
+	TEST_ASSERT_EQUAL_UINT32(nb, i);
+
+	for (pos = head->prev; pos != head; pos = pos->prev)
+		TEST_ASSERT_EQUAL_INT32(values[--i],
+					no_os_ilist_entry(pos, struct item,
+							node)->value);
+}
+
+void test_no_os_ilist(void)
+{
+	struct no_os_ilist_node head = NO_OS_ILIST_HEAD_INIT(head);
+	struct no_os_ilist_node *pos, *tmp;
+	const int32_t order[] = {2, 0, 1, 4};
+	const int32_t without_1[] = {2, 0, 4};
+
+	TEST_ASSERT_TRUE(no_os_ilist_empty(&head));
+	TEST_ASSERT_NULL(no_os_ilist_first(&head));
+	TEST_ASSERT_NULL(no_os_ilist_last(&head));
+
+	no_os_ilist_add_last(&head, &items[0].node);
+	no_os_ilist_add_last(&head, &items[1].node);
+	no_os_ilist_add_first(&head, &items[2].node);
+	no_os_ilist_add_after(&items[1].node, &items[4].node);
+	check_ilist(&head, order, NO_OS_ARRAY_SIZE(order));
+	TEST_ASSERT_EQUAL_PTR(&items[2].node, no_os_ilist_first(&head));
+	TEST_ASSERT_EQUAL_PTR(&items[4].node, no_os_ilist_last(&head));
+
+	/* Nodes can be removed while iterating */
+	no_os_ilist_for_each_safe(pos, tmp, &head)
+		if (no_os_ilist_entry(pos, struct item, node)->value == 1)
+			no_os_ilist_del(pos);
+	check_ilist(&head, without_1, NO_OS_ARRAY_SIZE(without_1));
+	TEST_ASSERT_TRUE(no_os_ilist_empty(&items[1].node));
+
+	no_os_ilist_for_each_safe(pos, tmp, &head)
+		no_os_ilist_del(pos);
+	TEST_ASSERT_TRUE(no_os_ilist_empty(&head));
+}
+
+void test_no_os_heap_order(void)
+{
+	struct no_os_heap heap;
+	int32_t values[64];
+	int32_t *top, prev;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_heap_init(&heap, 0, cmp_values));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_init(&heap, NO_OS_ARRAY_SIZE(values),
+			      cmp_values));
+
+	srand(1);
+	for (i = 0; i < NO_OS_ARRAY_SIZE(values); i++) {
+		/* Duplicates included */
+		values[i] = rand() % 50 - 25;
+		TEST_ASSERT_EQUAL_INT(0, no_os_heap_push(&heap, &values[i]));
+	}
+	TEST_ASSERT_EQUAL_INT(-ENOSPC, no_os_heap_push(&heap, &values[0]));
+
+	prev = -26;
+	for (i = 0; i < NO_OS_ARRAY_SIZE(values); i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_heap_top(&heap, (void **)&top));
+		TEST_ASSERT_EQUAL_INT(0, no_os_heap_pop(&heap, (void **)&top));
+		TEST_ASSERT_TRUE(*top >= prev);
+		prev = *top;
+	}
+	TEST_ASSERT_EQUAL_INT(-ENOENT, no_os_heap_pop(&heap, (void **)&top));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_remove(&heap));
+}
+
+void test_no_os_heap_interleaved(void)
+{
+	struct no_os_heap heap;
+	int32_t *top;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_init(&heap, 4, cmp_values));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_push(&heap, &items[3].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_push(&heap, &items[1].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_pop(&heap, (void **)&top));
+	TEST_ASSERT_EQUAL_PTR(&items[1].value, top);
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_push(&heap, &items[4].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_push(&heap, &items[0].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_pop(&heap, (void **)&top));
+	TEST_ASSERT_EQUAL_PTR(&items[0].value, top);
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_pop(&heap, (void **)&top));
+	TEST_ASSERT_EQUAL_PTR(&items[3].value, top);
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_pop(&heap, (void **)&top));
+	TEST_ASSERT_EQUAL_PTR(&items[4].value, top);
+	TEST_ASSERT_EQUAL_INT(0, no_os_heap_remove(&heap));
+}
+
+void test_no_os_map(void)
+{
+	const uint32_t keys[] = {40, 10, 30, 20, 50};
+	struct no_os_map map;
+	uint32_t key, i;
+	void *value;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_map_init(&map, 0));
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_init(&map, 4));
+	for (i = 0; i < 4; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_map_add(&map, keys[i], &items[i]));
+	TEST_ASSERT_EQUAL_INT(-ENOSPC, no_os_map_add(&map, keys[4], &items[4]));
+
+	/* An existing key gets a new value, even when full */
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_add(&map, 30, &items[4]));
+	TEST_ASSERT_EQUAL_UINT32(4, map.nb_elements);
+
+	/* Entries are kept in increasing key order */
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_map_read_idx(&map, i, &key,
+				      &value));
+		TEST_ASSERT_EQUAL_UINT32(10 * (i + 1), key);
+	}
+	TEST_ASSERT_EQUAL_INT(-ENOENT, no_os_map_read_idx(&map, 4, &key,
+			      &value));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_read(&map, 30, &value));
+	TEST_ASSERT_EQUAL_PTR(&items[4], value);
+	TEST_ASSERT_EQUAL_INT(-ENOENT, no_os_map_read(&map, 35, &value));
+	TEST_ASSERT_EQUAL_INT(-ENOENT, no_os_map_read(&map, 0, &value));
+	TEST_ASSERT_EQUAL_INT(-ENOENT, no_os_map_read(&map, 60, &value));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_get(&map, 10, &value));
+	TEST_ASSERT_EQUAL_PTR(&items[1], value);
+	TEST_ASSERT_EQUAL_INT(-ENOENT, no_os_map_get(&map, 10, &value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_add(&map, 50, &items[4]));
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_read_idx(&map, 0, &key, NULL));
+	TEST_ASSERT_EQUAL_UINT32(20, key);
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_read_idx(&map, 3, &key, NULL));
+	TEST_ASSERT_EQUAL_UINT32(50, key);
+	TEST_ASSERT_EQUAL_INT(0, no_os_map_remove(&map));
+}
+
+void test_no_os_list_priority(void)
+{
+	struct no_os_list_desc *list;
+	uint32_t size;
+	void *data;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_init(&list, NO_OS_LIST_PRIORITY_LIST,
+			      cmp_values));
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_add_find(list, &items[3].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_add_find(list, &items[0].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_add_find(list, &items[2].value));
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_get_size(list, &size));
+	TEST_ASSERT_EQUAL_UINT32(3, size);
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_get_first(list, &data));
+	TEST_ASSERT_EQUAL_PTR(&items[0].value, data);
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_read_find(list, &data,
+			      &items[3].value));
+	TEST_ASSERT_EQUAL_PTR(&items[3].value, data);
+	TEST_ASSERT_EQUAL_INT(0, no_os_list_remove(list));
+}
@@ -1,6 +1,7 @@
 SRCS += $(NO-OS)/iio/iio.c
 SRCS += $(NO-OS)/iio/iiod.c
 SRCS += $(NO-OS)/iio/iio_trigger.c
+SRCS += $(NO-OS)/iio/iio_scan.c
 SRCS += $(NO-OS)/iio/iio_app/iio_app.c
 
 NO_OS_INC_DIRS += $(NO-OS)/iio \
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+#
+# Generate a C header holding the IIO context XML of a no-OS application, to
+# be linked as a const blob through the xml/zxml fields of iio_init_param or
+# iio_app_init_param. The XML is read with the PRINT command from a running
+# application (network or serial backend) or from a file, and is compressed
+# with zstd for clients using the ZPRINT command.
+#
+# The XML must describe the same devices as the application it is linked
+# into: regenerate the header whenever the IIO descriptors change.
+#
+# Examples:
+#   iio_xml_blob.py --uri ip:192.168.2.1 -o src/iio_xml_blob.h
+#   iio_xml_blob.py --uri serial:/dev/ttyUSB0,115200 -o src/iio_xml_blob.h
+#   iio_xml_blob.py --xml context.xml -o src/iio_xml_blob.h
+
+import argparse
+import shutil
+import socket
+import subprocess
+import sys
+
+IIOD_PORT = 30431
+
+def read_line(read):
+    line = b''
+    while not line.endswith(b'\n'):
+        c = read(1)
+        if not c:
+            sys.exit('Connection closed')
+        line += c
+    return line
+
+def read_exact(read, n):
+    data = b''
+    while len(data) < n:
+        chunk = read(n - len(data))
+        if not chunk:
+            sys.exit('Connection closed')
+        data += chunk
+    return data
+
+def print_xml(read, write):
+    write(b'PRINT\r\n')
+    n = int(read_line(read))
+    if n < 0:
+        sys.exit('PRINT failed: %d' % n)
+    xml = read_exact(read, n)
+    # Trailing new line
+    read_line(read)
+    return xml
+
+def xml_from_uri(uri):
+    if uri.startswith('ip:'):
+        host, _, port = uri[3:].partition(':')
+        sock = socket.create_connection((host, int(port or IIOD_PORT)))
+        return print_xml(sock.recv, sock.sendall)
+    if uri.startswith('serial:'):
+        import serial
+        dev, _, baud = uri[7:].partition(',')
+        port = serial.Serial(dev, int(baud or 115200), timeout=10)
+        return print_xml(port.read, port.write)
+    sys.exit('Unknown uri: ' + uri)
+
+def zstd_compress(data, level):
+    try:
+        import zstandard
+        return zstandard.ZstdCompressor(level=level).compress(data)
+    except ImportError:
+        pass
+    if not shutil.which('zstd'):
+        sys.exit('zstd not found, install it or use --no-compress')
+    return subprocess.run(['zstd', '-q', '-c', '-%d' % level], input=data,
+                          stdout=subprocess.PIPE, check=True).stdout
+
+def c_array(ctype, name, data):
+    out = 'static const %s %s[%d] = {\n' % (ctype, name, len(data))
+    for i in range(0, len(data), 12):
+        out += '\t' + ', '.join('0x%02x' % b for b in data[i:i + 12]) + ',\n'
+    return out + '};\n'
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate a C header with the IIO context XML')
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument('--uri', help='ip:<host>[:port] or serial:<dev>[,baud]')
+    src.add_argument('--xml', help='File holding the context XML')
+    parser.add_argument('-o', '--output', required=True, help='Header to generate')
+    parser.add_argument('--level', type=int, default=19, help='zstd level')
+    parser.add_argument('--no-compress', action='store_true',
+                        help='Only generate the plain XML blob')
+    args = parser.parse_args()
+
+    if args.xml:
+        with open(args.xml, 'rb') as f:
+            xml = f.read().rstrip(b'\0\r\n')
+    else:
+        xml = xml_from_uri(args.uri)
+
+    out = '/* Generated by tools/scripts/iio_xml_blob.py, do not edit */\n\n'
+    out += '#ifndef IIO_XML_BLOB_H\n#define IIO_XML_BLOB_H\n\n'
+    out += '#include <stdint.h>\n\n'
+    out += c_array('char', 'iio_xml_blob', xml)
+    if not args.no_compress:
+        zxml = zstd_compress(xml, args.level)
+        out += '\n' + c_array('uint8_t', 'iio_zxml_blob', zxml)
+        print('XML: %d bytes, compressed: %d bytes' % (len(xml), len(zxml)))
+    out += '\n#endif\n'
+
+    with open(args.output, 'w') as f:
+        f.write(out)
+
+if __name__ == '__main__':
+    main()
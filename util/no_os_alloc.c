@@ -31,7 +31,224 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 
+#include <inttypes.h>
+#include <string.h>
+#define NO_OS_ALLOC_BACKEND
 #include "no_os_alloc.h"
+#include "no_os_error.h"
+#include "no_os_mutex.h"
+#include "no_os_print_log.h"
+#include "no_os_util.h"
+
+#ifdef NO_OS_ALLOC_POOL
+
+#ifndef NO_OS_ALLOC_POOL_SIZE
+#define NO_OS_ALLOC_POOL_SIZE		(64 * 1024)
+#endif
+
+/* Power of two payload sizes of the biggest and smallest classes */
+#ifndef NO_OS_ALLOC_POOL_MAX_BLOCK
+#define NO_OS_ALLOC_POOL_MAX_BLOCK	4096
+#endif
+#define NO_OS_ALLOC_POOL_MIN_BLOCK	16
+
+/* Class of the blocks allocated by libc */
+#define NO_OS_ALLOC_POOL_LIBC		0xFF
+
+/* Header in front of each block, aligns the payload like malloc() does */
+union no_os_alloc_hdr {
+	struct {
+		/* Size of the block, header included */
+		uint32_t	size;
+		uint8_t		cls;
+		uint8_t		tag;
+	} info;
+	long double	align;
+	void		*ptr;
+};
+
+static union no_os_alloc_hdr
+	pool_heap[NO_OS_ALLOC_POOL_SIZE / sizeof(union no_os_alloc_hdr)];
+/* Bytes of pool_heap already carved into blocks */
+static uint32_t pool_used;
+/* Free blocks of each class (at most 32), linked through their payload */
+static union no_os_alloc_hdr *pool_free[32];
+static struct no_os_alloc_stats pool_stats[NO_OS_ALLOC_TAG_MAX];
+/*
+ * Serializes the threads using the pool. Created by the first allocation,
+ * which must be done before other threads allocate.
+ */
+static void *pool_mutex;
+
+static void no_os_pool_lock(void)
+{
+	if (!pool_mutex)
+		no_os_mutex_init(&pool_mutex);
+	no_os_mutex_lock(pool_mutex);
+}
+
+static void no_os_pool_unlock(void)
+{
+	no_os_mutex_unlock(pool_mutex);
+}
+
+static void *no_os_pool_alloc(size_t size, enum no_os_alloc_tag tag)
+{
+	struct no_os_alloc_stats *stats;
+	union no_os_alloc_hdr *hdr = NULL;
+	uint32_t block, cls = 0;
+
+	if ((uint32_t)tag >= NO_OS_ALLOC_TAG_MAX)
+		tag = NO_OS_ALLOC_TAG_DEFAULT;
+	stats = &pool_stats[tag];
+
+	no_os_pool_lock();
+	if (size <= NO_OS_ALLOC_POOL_MAX_BLOCK) {
+		while (size > ((size_t)NO_OS_ALLOC_POOL_MIN_BLOCK << cls))
+			cls++;
+
+		block = sizeof(*hdr) + (NO_OS_ALLOC_POOL_MIN_BLOCK << cls);
+		hdr = pool_free[cls];
+		if (hdr) {
+			pool_free[cls] = (union no_os_alloc_hdr *)hdr[1].ptr;
+		} else if (pool_used + block <= sizeof(pool_heap)) {
+			hdr = (union no_os_alloc_hdr *)((uint8_t *)pool_heap +
+							pool_used);
+			pool_used += block;
+		}
+	}
+
+	if (!hdr) {
+		if (size <= UINT32_MAX - sizeof(*hdr)) {
+			block = sizeof(*hdr) + size;
+			hdr = malloc(block);
+		}
+		if (!hdr) {
+			stats->fails++;
+			no_os_pool_unlock();
+			return NULL;
+		}
+		cls = NO_OS_ALLOC_POOL_LIBC;
+		stats->fallbacks++;
+	}
+
+	hdr->info.size = block;
+	hdr->info.cls = cls;
+	hdr->info.tag = tag;
+
+	stats->allocs++;
+	stats->in_use += block;
+	if (stats->in_use > stats->peak)
+		stats->peak = stats->in_use;
+	no_os_pool_unlock();
+
+	return hdr + 1;
+}
+
+/**
+ * @brief Allocate memory accounted to a subsystem.
+ * @param size - Size of the memory block, in bytes.
+ * @param tag - Subsystem using the memory.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+__attribute__((weak)) void *no_os_malloc_tag(size_t size,
+		enum no_os_alloc_tag tag)
+{
+	return no_os_pool_alloc(size, tag);
+}
+
+/**
+ * @brief Allocate memory accounted to a subsystem and set it to 0.
+ * @param nitems - Number of elements to be allocated.
+ * @param size - Size of elements.
+ * @param tag - Subsystem using the memory.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+__attribute__((weak)) void *no_os_calloc_tag(size_t nitems, size_t size,
+		enum no_os_alloc_tag tag)
+{
+	void *ptr;
+
+	if (size && nitems > SIZE_MAX / size)
+		return NULL;
+
+	ptr = no_os_pool_alloc(nitems * size, tag);
+	if (ptr)
+		memset(ptr, 0, nitems * size);
+
+	return ptr;
+}
+
+/**
+ * @brief Allocate memory and return a pointer to it.
+ * @param size - Size of the memory block, in bytes.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+__attribute__((weak)) void *no_os_malloc(size_t size)
+{
+	return no_os_malloc_tag(size, NO_OS_ALLOC_TAG_DEFAULT);
+}
+
+/**
+ * @brief Allocate memory and return a pointer to it, set memory to 0.
+ * @param nitems - Number of elements to be allocated.
+ * @param size - Size of elements.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+__attribute__((weak)) void *no_os_calloc(size_t nitems, size_t size)
+{
+	return no_os_calloc_tag(nitems, size, NO_OS_ALLOC_TAG_DEFAULT);
+}
+
+/**
+ * @brief Deallocate memory previously allocated by a call to no_os_calloc
+ * 		  or no_os_malloc.
+ * @param ptr - Pointer to a memory block previously allocated by a call
+ * 		  to no_os_calloc or no_os_malloc.
+ * @return None.
+ */
+__attribute__((weak)) void no_os_free(void *ptr)
+{
+	union no_os_alloc_hdr *hdr;
+
+	if (!ptr)
+		return;
+
+	hdr = (union no_os_alloc_hdr *)ptr - 1;
+	no_os_pool_lock();
+	pool_stats[hdr->info.tag].in_use -= hdr->info.size;
+
+	if (hdr->info.cls == NO_OS_ALLOC_POOL_LIBC) {
+		no_os_pool_unlock();
+		free(hdr);
+		return;
+	}
+
+	hdr[1].ptr = pool_free[hdr->info.cls];
+	pool_free[hdr->info.cls] = hdr;
+	no_os_pool_unlock();
+}
+
+/**
+ * @brief Get the memory usage of a subsystem.
+ * @param tag - Subsystem.
+ * @param stats - Where to store the usage.
+ * @return 0 in case of success, -EINVAL for an unknown subsystem.
+ */
+int no_os_alloc_get_stats(enum no_os_alloc_tag tag,
+			  struct no_os_alloc_stats *stats)
+{
+	if ((uint32_t)tag >= NO_OS_ALLOC_TAG_MAX || !stats)
+		return -EINVAL;
+
+	no_os_pool_lock();
+	*stats = pool_stats[tag];
+	no_os_pool_unlock();
+
+	return 0;
+}
+
+#else
 
 /**
  * @brief Allocate memory and return a pointer to it.
@@ -65,3 +282,425 @@ __attribute__((weak)) void no_os_free(void *ptr)
 {
 	free(ptr);
 }
+
+/**
+ * @brief Allocate memory accounted to a subsystem. Without the pool backend
+ * the subsystem is ignored.
+ * @param size - Size of the memory block, in bytes.
+ * @param tag - Subsystem using the memory.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+__attribute__((weak)) void *no_os_malloc_tag(size_t size,
+		enum no_os_alloc_tag tag)
+{
+	return no_os_malloc(size);
+}
+
+/**
+ * @brief Allocate memory accounted to a subsystem and set it to 0. Without
+ * the pool backend the subsystem is ignored.
+ * @param nitems - Number of elements to be allocated.
+ * @param size - Size of elements.
+ * @param tag - Subsystem using the memory.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+__attribute__((weak)) void *no_os_calloc_tag(size_t nitems, size_t size,
+		enum no_os_alloc_tag tag)
+{
+	return no_os_calloc(nitems, size);
+}
+
+/**
+ * @brief Get the memory usage of a subsystem.
+ * @param tag - Subsystem.
+ * @param stats - Where to store the usage.
+ * @return -ENOSYS, usage is only kept by the pool backend.
+ */
+int no_os_alloc_get_stats(enum no_os_alloc_tag tag,
+			  struct no_os_alloc_stats *stats)
+{
+	return -ENOSYS;
+}
+
+#endif /* NO_OS_ALLOC_POOL */
+
+/**
+ * @brief Set up an arena.
+ * @param arena - Arena descriptor.
+ * @param mem - Memory area used by the arena.
+ * @param size - Size of the memory area.
+ * @return None.
+ */
+void no_os_arena_init(struct no_os_arena *arena, void *mem, size_t size)
+{
+	arena->base = mem;
+	arena->size = size;
+	arena->used = 0;
+	arena->peak = 0;
+}
+
+/**
+ * @brief Allocate memory from an arena, in constant time.
+ * @param arena - Arena descriptor.
+ * @param size - Size of the memory block, in bytes.
+ * @return Pointer to 8 bytes aligned memory, or NULL if the arena is full.
+ */
+void *no_os_arena_alloc(struct no_os_arena *arena, size_t size)
+{
+	uintptr_t addr = (uintptr_t)arena->base + arena->used;
+	size_t pad = (8 - (addr % 8)) % 8;
+
+	if (size > arena->size - arena->used ||
+	    pad > arena->size - arena->used - size)
+		return NULL;
+
+	arena->used += pad + size;
+	if (arena->used > arena->peak)
+		arena->peak = arena->used;
+
+	return (void *)(addr + pad);
+}
+
+/**
+ * @brief Free all the memory allocated from an arena.
+ * @param arena - Arena descriptor.
+ * @return None.
+ */
+void no_os_arena_reset(struct no_os_arena *arena)
+{
+	arena->used = 0;
+}
+
+#ifdef NO_OS_ALLOC_TRACE
+
+/* Number of call sites recorded, the last entry accounts for the others */
+#ifndef NO_OS_ALLOC_TRACE_SITES
+#define NO_OS_ALLOC_TRACE_SITES		64
+#endif
+
+/* Histogram buckets: up to 16 bytes, up to 32 bytes, ..., bigger than 64KiB */
+#define NO_OS_ALLOC_TRACE_HIST		14
+
+/* Marks the live blocks allocated by the tracing layer */
+#define NO_OS_ALLOC_TRACE_MAGIC		0xA110CA7E
+
+/* Header in front of each traced block */
+union no_os_alloc_trace_hdr {
+	struct {
+		union no_os_alloc_trace_hdr	*prev;
+		union no_os_alloc_trace_hdr	*next;
+		/* Requested size */
+		uint32_t			size;
+		/* Allocation number, see no_os_alloc_trace_mark() */
+		uint32_t			seq;
+		uint32_t			site;
+		uint32_t			magic;
+	} info;
+	long double	align;
+};
+
+struct no_os_alloc_site {
+	/* NULL for an unused entry */
+	const char	*file;
+	uint32_t	line;
+	uint32_t	allocs;
+	uint32_t	frees;
+	uint32_t	live;
+	uint32_t	peak;
+};
+
+static struct no_os_alloc_site trace_sites[NO_OS_ALLOC_TRACE_SITES];
+static uint32_t trace_hist[NO_OS_ALLOC_TRACE_HIST];
+static union no_os_alloc_trace_hdr *trace_live;
+static struct {
+	uint32_t	allocs;
+	uint32_t	frees;
+	uint32_t	fails;
+	/* Frees of blocks not allocated by the tracing layer, or freed twice */
+	uint32_t	bad_frees;
+	uint32_t	live;
+	uint32_t	peak;
+	uint32_t	seq;
+} trace;
+
+/* Find or add the entry of a call site, in an open addressed table */
+static uint32_t no_os_alloc_trace_site(const char *file, uint32_t line)
+{
+	const uint32_t nb = NO_OS_ALLOC_TRACE_SITES - 1;
+	struct no_os_alloc_site *site;
+	uint32_t i, idx;
+
+	idx = ((uint32_t)(uintptr_t)file ^ (line * 2654435761u)) % nb;
+	for (i = 0; i < nb; i++) {
+		site = &trace_sites[idx];
+		if (!site->file) {
+			site->file = file;
+			site->line = line;
+			return idx;
+		}
+		if (site->file == file && site->line == line)
+			return idx;
+		idx = (idx + 1) % nb;
+	}
+
+	return nb;
+}
+
+static void *no_os_alloc_trace(size_t nitems, size_t size,
+			       enum no_os_alloc_tag tag, bool zero,
+			       const char *file, uint32_t line)
+{
+	union no_os_alloc_trace_hdr *hdr = NULL;
+	struct no_os_alloc_site *site;
+	uint32_t bucket = 0;
+
+	if (size && nitems > SIZE_MAX / size) {
+		trace.fails++;
+		return NULL;
+	}
+
+	size *= nitems;
+	if (size <= UINT32_MAX - sizeof(*hdr)) {
+		if (zero)
+			hdr = no_os_calloc_tag(1, sizeof(*hdr) + size, tag);
+		else
+			hdr = no_os_malloc_tag(sizeof(*hdr) + size, tag);
+	}
+	if (!hdr) {
+		trace.fails++;
+		return NULL;
+	}
+
+	hdr->info.size = size;
+	hdr->info.seq = trace.seq++;
+	hdr->info.site = no_os_alloc_trace_site(file, line);
+	hdr->info.magic = NO_OS_ALLOC_TRACE_MAGIC;
+	hdr->info.prev = NULL;
+	hdr->info.next = trace_live;
+	if (trace_live)
+		trace_live->info.prev = hdr;
+	trace_live = hdr;
+
+	site = &trace_sites[hdr->info.site];
+	site->allocs++;
+	site->live += size;
+	site->peak = no_os_max(site->peak, site->live);
+
+	while (bucket < NO_OS_ALLOC_TRACE_HIST - 1 && size > (16u << bucket))
+		bucket++;
+	trace_hist[bucket]++;
+
+	trace.allocs++;
+	trace.live += size;
+	trace.peak = no_os_max(trace.peak, trace.live);
+
+	return hdr + 1;
+}
+
+/**
+ * @brief Traced no_os_malloc_tag(), called through the no_os_malloc() and
+ * no_os_malloc_tag() macros when NO_OS_ALLOC_TRACE is defined.
+ * @param size - Size of the memory block, in bytes.
+ * @param tag - Subsystem using the memory.
+ * @param file - File of the call site.
+ * @param line - Line of the call site.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+void *no_os_malloc_trace(size_t size, enum no_os_alloc_tag tag,
+			 const char *file, uint32_t line)
+{
+	return no_os_alloc_trace(1, size, tag, false, file, line);
+}
+
+/**
+ * @brief Traced no_os_calloc_tag(), called through the no_os_calloc() and
+ * no_os_calloc_tag() macros when NO_OS_ALLOC_TRACE is defined.
+ * @param nitems - Number of elements to be allocated.
+ * @param size - Size of elements.
+ * @param tag - Subsystem using the memory.
+ * @param file - File of the call site.
+ * @param line - Line of the call site.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+void *no_os_calloc_trace(size_t nitems, size_t size, enum no_os_alloc_tag tag,
+			 const char *file, uint32_t line)
+{
+	return no_os_alloc_trace(nitems, size, tag, true, file, line);
+}
+
+/**
+ * @brief Traced no_os_free(). Blocks not allocated by the tracing layer, or
+ * already freed, are reported and not freed.
+ * @param ptr - Pointer to a memory block allocated by the tracing layer.
+ * @return None.
+ */
+void no_os_free_trace(void *ptr)
+{
+	union no_os_alloc_trace_hdr *hdr;
+	struct no_os_alloc_site *site;
+
+	if (!ptr)
+		return;
+
+	hdr = (union no_os_alloc_trace_hdr *)ptr - 1;
+	if (hdr->info.magic != NO_OS_ALLOC_TRACE_MAGIC) {
+		trace.bad_frees++;
+		pr_warning("no_os_free: bad block %p\n", ptr);
+		return;
+	}
+
+	hdr->info.magic = 0;
+	if (hdr->info.prev)
+		hdr->info.prev->info.next = hdr->info.next;
+	else
+		trace_live = hdr->info.next;
+	if (hdr->info.next)
+		hdr->info.next->info.prev = hdr->info.prev;
+
+	site = &trace_sites[hdr->info.site];
+	site->frees++;
+	site->live -= hdr->info.size;
+
+	trace.frees++;
+	trace.live -= hdr->info.size;
+
+	no_os_free(hdr);
+}
+
+/* File name of a call site, without the directories */
+static const char *no_os_alloc_trace_file(const char *file)
+{
+	const char *name;
+
+	if (!file)
+		return "other";
+
+	name = strrchr(file, '/');
+
+	return name ? name + 1 : file;
+}
+
+/**
+ * @brief Print the allocation statistics, as text, into a buffer: the totals,
+ * the histogram of the requested sizes and, for each call site, the number of
+ * allocations and frees and the live and peak bytes.
+ * @param buf - Destination buffer.
+ * @param len - Size of buf. The text is truncated to fit.
+ * @return Length of the text, or negative error code.
+ */
+int no_os_alloc_trace_dump(char *buf, uint32_t len)
+{
+	struct no_os_alloc_site *site;
+	int32_t n = len;
+	int32_t i = 0;
+	uint32_t j;
+
+	if (!buf || !len)
+		return -EINVAL;
+
+	i += snprintf(buf + i, no_os_max(n - i, 0),
+		      "allocs %"PRIu32" frees %"PRIu32" fails %"PRIu32
+		      " bad_frees %"PRIu32" live %"PRIu32" peak %"PRIu32"\n",
+		      trace.allocs, trace.frees, trace.fails, trace.bad_frees,
+		      trace.live, trace.peak);
+
+	i += snprintf(buf + i, no_os_max(n - i, 0), "sizes");
+	for (j = 0; j < NO_OS_ALLOC_TRACE_HIST; j++) {
+		if (!trace_hist[j])
+			continue;
+		if (j == NO_OS_ALLOC_TRACE_HIST - 1)
+			i += snprintf(buf + i, no_os_max(n - i, 0),
+				      " >%u:%"PRIu32, 16u << (j - 1),
+				      trace_hist[j]);
+		else
+			i += snprintf(buf + i, no_os_max(n - i, 0),
+				      " <=%u:%"PRIu32, 16u << j, trace_hist[j]);
+	}
+	i += snprintf(buf + i, no_os_max(n - i, 0), "\n");
+
+	for (j = 0; j < NO_OS_ALLOC_TRACE_SITES; j++) {
+		site = &trace_sites[j];
+		if (!site->allocs)
+			continue;
+		i += snprintf(buf + i, no_os_max(n - i, 0),
+			      "%s:%"PRIu32" allocs %"PRIu32" frees %"PRIu32
+			      " live %"PRIu32" peak %"PRIu32"\n",
+			      no_os_alloc_trace_file(site->file), site->line,
+			      site->allocs, site->frees, site->live,
+			      site->peak);
+	}
+
+	return no_os_min(i, n - 1);
+}
+
+/**
+ * @brief Get a mark identifying the allocations done from now on, for
+ * no_os_alloc_trace_leaks().
+ * @return The mark.
+ */
+uint32_t no_os_alloc_trace_mark(void)
+{
+	return trace.seq;
+}
+
+/**
+ * @brief Report the blocks allocated since a mark that are still live, with
+ * the call site they were allocated from. Typically called at the end of a
+ * remove function, with a mark taken at the beginning of the matching init,
+ * as iio_remove() does. Blocks allocated by other subsystems since the mark,
+ * and still in use, are reported too.
+ * @param mark - Value returned by no_os_alloc_trace_mark().
+ * @return Number of leaked blocks.
+ */
+uint32_t no_os_alloc_trace_leaks(uint32_t mark)
+{
+	union no_os_alloc_trace_hdr *hdr;
+	struct no_os_alloc_site *site;
+	uint32_t nb = 0;
+
+	for (hdr = trace_live; hdr; hdr = hdr->info.next) {
+		if (hdr->info.seq < mark)
+			continue;
+		site = &trace_sites[hdr->info.site];
+		pr_warning("leak: %"PRIu32" bytes allocated at %s:%"PRIu32"\n",
+			   hdr->info.size, no_os_alloc_trace_file(site->file),
+			   site->line);
+		nb++;
+	}
+
+	return nb;
+}
+
+#else
+
+/**
+ * @brief Print the allocation statistics, as text, into a buffer.
+ * @param buf - Destination buffer.
+ * @param len - Size of buf.
+ * @return -ENOSYS, statistics are only kept with NO_OS_ALLOC_TRACE.
+ */
+int no_os_alloc_trace_dump(char *buf, uint32_t len)
+{
+	return -ENOSYS;
+}
+
+/**
+ * @brief Get a mark identifying the allocations done from now on.
+ * @return 0, allocations are only traced with NO_OS_ALLOC_TRACE.
+ */
+uint32_t no_os_alloc_trace_mark(void)
+{
+	return 0;
+}
+
+/**
+ * @brief Report the blocks allocated since a mark that are still live.
+ * @param mark - Value returned by no_os_alloc_trace_mark().
+ * @return 0, allocations are only traced with NO_OS_ALLOC_TRACE.
+ */
+uint32_t no_os_alloc_trace_leaks(uint32_t mark)
+{
+	return 0;
+}
+
+#endif /* NO_OS_ALLOC_TRACE */
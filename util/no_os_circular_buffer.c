@@ -39,38 +39,64 @@
 #include "no_os_error.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
+#include "no_os_atomic.h"
 
-int32_t no_os_cb_cfg(struct no_os_circular_buffer *desc, int8_t *buff,
-		     uint32_t size)
+/**
+ * @brief Configure a circular buffer using the given memory.
+ * @param desc - Circular buffer reference
+ * @param buff - Memory used by the buffer
+ * @param size - Size of buff
+ * @param mode - Operating mode. NO_OS_CB_SPSC needs a power of two size.
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Wrong parameters used
+ */
+int32_t no_os_cb_cfg_mode(struct no_os_circular_buffer *desc, int8_t *buff,
+			  uint32_t size, enum no_os_cb_mode mode)
 {
 	if (!desc)
 		return -EINVAL;
 
+	if (mode == NO_OS_CB_SPSC && (!size || (size & (size - 1))))
+		return -EINVAL;
+
 	memset(desc, 0, sizeof(*desc));
 	desc->size = size;
 	desc->buff = buff;
+	desc->mode = mode;
 
 	return 0;
 }
 
+int32_t no_os_cb_cfg(struct no_os_circular_buffer *desc, int8_t *buff,
+		     uint32_t size)
+{
+	return no_os_cb_cfg_mode(desc, buff, size, NO_OS_CB_DEFAULT);
+}
+
 /**
  * @brief Create circular buffer structure.
  *
- * @note Circular buffer implementation is thread safe for one write
- * and one reader.
+ * @note In NO_OS_CB_DEFAULT mode the circular buffer implementation is
+ * thread safe for one writer and one reader that don't run concurrently on
+ * different cores. In NO_OS_CB_SPSC mode the writer and the reader may run
+ * concurrently from any context.
  * If multiple writer or multiple readers access the circular buffer then
  * function that updates the structure should be called inside a critical
  * critical section.
  *
  * @param desc - Where to store the circular buffer reference
  * @param buff_size - Buffer size
+ * @param mode - Operating mode. NO_OS_CB_SPSC needs a power of two size.
  * @return
  *  - 0 : On success
  *  - -1 : Otherwise
  */
-int32_t no_os_cb_init(struct no_os_circular_buffer **desc, uint32_t buff_size)
+int32_t no_os_cb_init_mode(struct no_os_circular_buffer **desc,
+			   uint32_t buff_size, enum no_os_cb_mode mode)
 {
 	struct no_os_circular_buffer	*ldesc;
+	int32_t				ret;
 
 	if (!desc || !buff_size)
 		return -EINVAL;
@@ -79,18 +105,36 @@ int32_t no_os_cb_init(struct no_os_circular_buffer **desc, uint32_t buff_size)
 	if (!ldesc)
 		return -ENOMEM;
 
-	*desc = ldesc;
+	ret = no_os_cb_cfg_mode(ldesc, NULL, buff_size, mode);
+	if (ret) {
+		no_os_free(ldesc);
+		return ret;
+	}
 
-	ldesc->size = buff_size;
 	ldesc->buff = no_os_calloc(1, buff_size);
 	if (!ldesc->buff) {
 		no_os_free(ldesc);
 		return -ENOMEM;
 	}
 
+	*desc = ldesc;
+
 	return 0;
 }
 
+/**
+ * @brief Create circular buffer structure in NO_OS_CB_DEFAULT mode.
+ * @param desc - Where to store the circular buffer reference
+ * @param buff_size - Buffer size
+ * @return
+ *  - 0 : On success
+ *  - -1 : Otherwise
+ */
+int32_t no_os_cb_init(struct no_os_circular_buffer **desc, uint32_t buff_size)
+{
+	return no_os_cb_init_mode(desc, buff_size, NO_OS_CB_DEFAULT);
+}
+
 /**
  * @brief Free the resources allocated for the circular buffer structure.
  * @param desc - Circular buffer reference
@@ -126,6 +170,12 @@ int32_t no_os_cb_size(struct no_os_circular_buffer *desc, uint32_t *size)
 	if (!desc || !size)
 		return -EINVAL;
 
+	if (desc->mode == NO_OS_CB_SPSC) {
+		*size = no_os_load_acquire(&desc->write.idx) -
+			no_os_load_acquire(&desc->read.idx);
+		return 0;
+	}
+
 	if (desc->write.spin_count > desc->read.spin_count)
 		nb_spins = desc->write.spin_count - desc->read.spin_count;
 	else
@@ -146,6 +196,45 @@ int32_t no_os_cb_size(struct no_os_circular_buffer *desc, uint32_t *size)
 	return 0;
 }
 
+/* Bytes the reader can read or the writer can write in NO_OS_CB_SPSC mode */
+static uint32_t no_os_cb_spsc_available(struct no_os_circular_buffer *desc,
+					bool is_read)
+{
+	if (is_read)
+		return no_os_load_acquire(&desc->write.idx) - desc->read.idx;
+
+	return desc->size - (desc->write.idx -
+			     no_os_load_acquire(&desc->read.idx));
+}
+
+static int32_t no_os_cb_spsc_prepare_async(struct no_os_circular_buffer *desc,
+		uint32_t requested_size,
+		void **buff,
+		uint32_t *raw_size_available,
+		bool is_read)
+{
+	struct no_os_cb_ptr	*ptr;
+	uint32_t		idx;
+
+	ptr = is_read ? &desc->read : &desc->write;
+	if (ptr->async_started)
+		return -EBUSY;
+
+	idx = ptr->idx & (desc->size - 1);
+	requested_size = no_os_min(requested_size,
+				   no_os_cb_spsc_available(desc, is_read));
+	ptr->async_size = no_os_min(requested_size, desc->size - idx);
+
+	*raw_size_available = ptr->async_size;
+	if (!ptr->async_size)
+		return -EAGAIN;
+
+	*buff = (void *)(desc->buff + idx);
+	ptr->async_started = true;
+
+	return 0;
+}
+
 /*
  * Functionality described at no_os_cb_prepare_async_write/read having the is_read
  * parameter to specifiy if it is a read or write operation.
@@ -164,6 +253,10 @@ static int32_t no_os_cb_prepare_async_operation(struct no_os_circular_buffer
 	if (!desc || !buff || !raw_size_available)
 		return -EINVAL;
 
+	if (desc->mode == NO_OS_CB_SPSC)
+		return no_os_cb_spsc_prepare_async(desc, requested_size, buff,
+						   raw_size_available, is_read);
+
 	ret = 0;
 	/* Select if read or write index will be updated */
 	ptr = is_read ? &desc->read : &desc->write;
@@ -225,6 +318,15 @@ static int32_t no_os_cb_end_async_operation(struct no_os_circular_buffer *desc,
 	if (!ptr->async_started)
 		return -1;
 
+	if (desc->mode == NO_OS_CB_SPSC) {
+		/* Publish the data, each side only writes its index */
+		no_os_store_release(&ptr->idx, ptr->idx + ptr->async_size);
+		ptr->async_size = 0;
+		ptr->async_started = false;
+
+		return 0;
+	}
+
 	/* Update pointer value */
 	new_val = ptr->idx + ptr->async_size;
 	if (new_val >= desc->size) {
@@ -238,6 +340,31 @@ static int32_t no_os_cb_end_async_operation(struct no_os_circular_buffer *desc,
 	return 0;
 }
 
+/*
+ * Functionality described at no_os_cb_cancel_async_write/read having the
+ * is_read parameter to specifiy if it is a read or write operation.
+ */
+static int32_t no_os_cb_cancel_async_operation(struct no_os_circular_buffer
+		*desc, bool is_read)
+{
+	struct no_os_cb_ptr	*ptr;
+
+	if (!desc)
+		return -EINVAL;
+
+	ptr = is_read ? &desc->read : &desc->write;
+
+	/* Transaction not started */
+	if (!ptr->async_started)
+		return -1;
+
+	/* The index is left as is, the other side never saw the region */
+	ptr->async_size = 0;
+	ptr->async_started = false;
+
+	return 0;
+}
+
 /*
  * Functionality described at cb_write/read having the is_read
  * parameter to specifiy if it is a read or write operation.
@@ -255,6 +382,33 @@ static int32_t no_os_cb_operation(struct no_os_circular_buffer *desc,
 	if (!desc || !data || !size)
 		return -EINVAL;
 
+	if (desc->mode == NO_OS_CB_SPSC) {
+		/* Nothing is copied if the whole size can't be */
+		if (no_os_cb_spsc_available(desc, is_read) < size)
+			return -EAGAIN;
+
+		/* At most two copies, before and after the end of the buffer */
+		for (i = 0; i < size; i += available_size) {
+			ret = no_os_cb_spsc_prepare_async(desc, size - i,
+							  (void **)&buff,
+							  &available_size,
+							  is_read);
+			if (ret)
+				return ret;
+
+			if (is_read)
+				memcpy((uint8_t *)data + i, buff,
+				       available_size);
+			else
+				memcpy(buff, (uint8_t *)data + i,
+				       available_size);
+
+			no_os_cb_end_async_operation(desc, is_read);
+		}
+
+		return 0;
+	}
+
 	sticky_overrun = 0;
 	i = 0;
 	while (i < size) {
@@ -300,6 +454,7 @@ static int32_t no_os_cb_operation(struct no_os_circular_buffer *desc,
  *  - 0   - No errors
  *  - -EINVAL   - Wrong parameters used
  *  - -EBUSY    - Asynchronous transaction already started
+ *  - -EAGAIN   - Buffer full, only in NO_OS_CB_SPSC mode
  */
 int32_t no_os_cb_prepare_async_write(struct no_os_circular_buffer *desc,
 				     uint32_t size_to_write,
@@ -358,6 +513,29 @@ int32_t no_os_cb_end_async_read(struct no_os_circular_buffer *desc)
 }
 /** @} */
 
+/**
+ * \defgroup cancel_async_group Cancel Asynchronous functions
+ * @brief Cancel an asynchronous transaction, without consuming or producing
+ * any data: the region returned by the prepare function is dropped.
+ *
+ * @param desc - Circular buffer reference
+ * @return
+ *  - 0   - No errors
+ *  - -1   - Asynchronous transaction not started
+ *  - -EINVAL        - Wrong parameters used
+ * @{
+ */
+int32_t no_os_cb_cancel_async_write(struct no_os_circular_buffer *desc)
+{
+	return no_os_cb_cancel_async_operation(desc, 0);
+}
+
+int32_t no_os_cb_cancel_async_read(struct no_os_circular_buffer *desc)
+{
+	return no_os_cb_cancel_async_operation(desc, 1);
+}
+/** @} */
+
 /**
  * @brief Write data to the buffer (Blocking).
  * @param desc - Circular buffer reference
@@ -366,6 +544,7 @@ int32_t no_os_cb_end_async_read(struct no_os_circular_buffer *desc)
  * @return
  *  - 0 - No errors
  *  - -EINVAL      - Wrong parameters used
+ *  - -EAGAIN      - Not enough room in NO_OS_CB_SPSC mode, nothing written
  */
 int32_t no_os_cb_write(struct no_os_circular_buffer *desc, const void *data,
 		       uint32_t size)
@@ -382,6 +561,7 @@ int32_t no_os_cb_write(struct no_os_circular_buffer *desc, const void *data,
  *  - 0   - No errors
  *  - -EINVAL   - Wrong parameters used
  *  - -NO_OS_EOVERRUN - An overrun occurred and some data have been overwritten
+ *  - -EAGAIN   - Not enough data in NO_OS_CB_SPSC mode, nothing read
  */
 int32_t no_os_cb_read(struct no_os_circular_buffer *desc, void *data,
 		      uint32_t size)
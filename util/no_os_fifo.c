@@ -45,13 +45,14 @@
  */
 static struct no_os_fifo_element * fifo_new_element(char *buff, uint32_t len)
 {
-	struct no_os_fifo_element *q = no_os_calloc(1,
-				       sizeof(struct no_os_fifo_element));
+	struct no_os_fifo_element *q = no_os_calloc_tag(1,
+				       sizeof(struct no_os_fifo_element),
+				       NO_OS_ALLOC_TAG_FIFO);
 	if (!q)
 		return NULL;
 
 	q->len = len;
-	q->data = no_os_calloc(1, len);
+	q->data = no_os_calloc_tag(1, len, NO_OS_ALLOC_TAG_FIFO);
 	if (!(q->data)) {
 		no_os_free(q);
 		return NULL;
@@ -33,16 +33,22 @@
 *******************************************************************************/
 #include <errno.h>
 #include "no_os_lf256fifo.h"
+#include "no_os_lf_ring.h"
 #include "no_os_alloc.h"
 
+#define LF256FIFO_DEPTH	256
+
+NO_OS_LF_RING_DEFINE(lf256fifo_ring, uint8_t)
+
 /**
  * @struct lf256fifo
  * @brief Structure holding the fifo element parameters.
  */
 struct lf256fifo {
-	uint8_t * data; // pointer to memory area where the buffer will be allocated
-	uint8_t ffilled; // the index where the data starts
-	uint8_t fempty; // the index where empty/non-used area starts
+	/** Ring of LF256FIFO_DEPTH bytes */
+	struct no_os_lf_ring ring;
+	/** Storage of the ring */
+	uint8_t data[LF256FIFO_DEPTH];
 };
 
 /**
@@ -52,17 +58,20 @@ struct lf256fifo {
  */
 int lf256fifo_init(struct lf256fifo **fifo)
 {
+	struct lf256fifo *b;
+	int ret;
+
 	if (fifo == NULL)
 		return -EINVAL;
 
-	struct lf256fifo *b = no_os_calloc(1, sizeof(struct lf256fifo));
+	b = no_os_calloc(1, sizeof(struct lf256fifo));
 	if (b == NULL)
 		return -ENOMEM;
 
-	b->data = no_os_calloc(1, 256);
-	if (b->data == NULL) {
+	ret = no_os_lf_ring_cfg(&b->ring, b->data, 1, LF256FIFO_DEPTH);
+	if (ret) {
 		no_os_free(b);
-		return -ENOMEM;
+		return ret;
 	}
 
 	*fifo = b;
@@ -77,8 +86,7 @@ int lf256fifo_init(struct lf256fifo **fifo)
  */
 bool lf256fifo_is_full(struct lf256fifo *fifo)
 {
-	return (fifo->fempty + 1) ==
-	       fifo->ffilled; // intended overflow at 256 (data size is 256)
+	return !no_os_lf_ring_space(&fifo->ring);
 }
 
 /**
@@ -88,7 +96,7 @@ bool lf256fifo_is_full(struct lf256fifo *fifo)
 */
 bool lf256fifo_is_empty(struct lf256fifo *fifo)
 {
-	return fifo->fempty == fifo->ffilled;
+	return !no_os_lf_ring_count(&fifo->ring);
 }
 
 /**
@@ -99,12 +107,9 @@ bool lf256fifo_is_empty(struct lf256fifo *fifo)
 */
 int lf256fifo_read(struct lf256fifo * fifo, uint8_t *c)
 {
-	if (lf256fifo_is_empty(fifo))
+	if (lf256fifo_ring_read(&fifo->ring, c))
 		return -1; // buffer empty
 
-	*c = fifo->data[fifo->ffilled];
-	fifo->ffilled++; // intended overflow at 256 (data size is 256)
-
 	return 0;
 }
 
@@ -116,15 +121,25 @@ int lf256fifo_read(struct lf256fifo * fifo, uint8_t *c)
 */
 int lf256fifo_write(struct lf256fifo *fifo, uint8_t c)
 {
-	if (lf256fifo_is_full(fifo))
+	if (lf256fifo_ring_write(&fifo->ring, c))
 		return -1; // buffer full
 
-	fifo->data[fifo->fempty] = c;
-	fifo->fempty++; // intended overflow at 256 (data size is 256)
-
 	return 0; // return success
 }
 
+/**
+* @brief Read up to len chars from fifo.
+* @param fifo - pointer to fifo descriptor.
+* @param buf - pointer to memory where the chars are read.
+* @param len - maximum number of chars to read.
+* @return number of chars read.
+*/
+uint32_t lf256fifo_read_bulk(struct lf256fifo *fifo, uint8_t *buf,
+			     uint32_t len)
+{
+	return lf256fifo_ring_read_bulk(&fifo->ring, buf, len);
+}
+
 /**
 * @brief Flush the fifo.
 * @param fifo - pointer to fifo descriptor.
@@ -132,7 +147,7 @@ int lf256fifo_write(struct lf256fifo *fifo, uint8_t c)
 */
 void lf256fifo_flush(struct lf256fifo *fifo)
 {
-	fifo->ffilled = fifo->fempty;
+	no_os_lf_ring_flush(&fifo->ring);
 }
 
 /**
@@ -142,7 +157,5 @@ void lf256fifo_flush(struct lf256fifo *fifo)
 */
 void lf256fifo_remove(struct lf256fifo *fifo)
 {
-	if (fifo && fifo->data)
-		no_os_free(fifo->data);
+	no_os_free(fifo);
 }
-
@@ -35,6 +35,7 @@
 #include "no_os_error.h"
 #include "no_os_alloc.h"
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @struct no_os_list_elem
@@ -98,7 +99,8 @@ static inline struct no_os_list_elem *create_element(void *data,
 {
 	struct no_os_list_elem *elem;
 
-	elem = (struct no_os_list_elem *)no_os_calloc(1, sizeof(*elem));
+	elem = (struct no_os_list_elem *)no_os_calloc_tag(1, sizeof(*elem),
+							 NO_OS_ALLOC_TAG_LIST);
 	if (!elem)
 		return NULL;
 	elem->data = data;
@@ -869,3 +871,314 @@ int32_t no_os_iterator_insert(struct no_os_iterator *iter, void *data,
 
 	return 0;
 }
+
+/**
+ * @brief Allocate the storage of a priority queue.
+ * @param heap - Heap descriptor.
+ * @param capacity - Maximum number of elements.
+ * @param comparator - Used to order the elements. If NULL, the elements are
+ * ordered by address.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_heap_init(struct no_os_heap *heap, uint32_t capacity,
+			f_cmp comparator)
+{
+	if (!heap || !capacity)
+		return -EINVAL;
+
+	heap->elems = (void **)no_os_calloc_tag(capacity, sizeof(*heap->elems),
+						NO_OS_ALLOC_TAG_LIST);
+	if (!heap->elems)
+		return -ENOMEM;
+
+	heap->nb_elements = 0;
+	heap->capacity = capacity;
+	heap->comparator = comparator ? comparator : no_os_default_comparator;
+
+	return 0;
+}
+
+/**
+ * @brief Free the storage of a priority queue.
+ * @param heap - Heap descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_heap_remove(struct no_os_heap *heap)
+{
+	if (!heap)
+		return -EINVAL;
+
+	no_os_free(heap->elems);
+	heap->elems = NULL;
+	heap->nb_elements = 0;
+	heap->capacity = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Insert an element in a priority queue.
+ * @param heap - Heap descriptor.
+ * @param data - Element to insert.
+ * @return 0 in case of success, -ENOSPC if the heap is full.
+ */
+int32_t no_os_heap_push(struct no_os_heap *heap, void *data)
+{
+	uint32_t i, parent;
+
+	if (!heap || !heap->elems)
+		return -EINVAL;
+
+	if (heap->nb_elements == heap->capacity)
+		return -ENOSPC;
+
+	/* Move the parents bigger than data down, then store data */
+	i = heap->nb_elements++;
+	while (i) {
+		parent = (i - 1) / 2;
+		if (heap->comparator(heap->elems[parent], data) <= 0)
+			break;
+		heap->elems[i] = heap->elems[parent];
+		i = parent;
+	}
+	heap->elems[i] = data;
+
+	return 0;
+}
+
+/**
+ * @brief Read the lowest element of a priority queue.
+ * @param heap - Heap descriptor.
+ * @param data - Lowest element.
+ * @return 0 in case of success, -ENOENT if the heap is empty.
+ */
+int32_t no_os_heap_top(struct no_os_heap *heap, void **data)
+{
+	if (!heap || !data)
+		return -EINVAL;
+
+	if (!heap->nb_elements)
+		return -ENOENT;
+
+	*data = heap->elems[0];
+
+	return 0;
+}
+
+/**
+ * @brief Read and remove the lowest element of a priority queue.
+ * @param heap - Heap descriptor.
+ * @param data - Lowest element.
+ * @return 0 in case of success, -ENOENT if the heap is empty.
+ */
+int32_t no_os_heap_pop(struct no_os_heap *heap, void **data)
+{
+	uint32_t i = 0, child;
+	void *last;
+	int32_t ret;
+
+	ret = no_os_heap_top(heap, data);
+	if (ret)
+		return ret;
+
+	/* Move the lowest children of the hole up, until last fits in it */
+	last = heap->elems[--heap->nb_elements];
+	while (1) {
+		child = 2 * i + 1;
+		if (child >= heap->nb_elements)
+			break;
+		if (child + 1 < heap->nb_elements &&
+		    heap->comparator(heap->elems[child + 1],
+				     heap->elems[child]) < 0)
+			child++;
+		if (heap->comparator(last, heap->elems[child]) <= 0)
+			break;
+		heap->elems[i] = heap->elems[child];
+		i = child;
+	}
+	heap->elems[i] = last;
+
+	return 0;
+}
+
+/**
+ * @brief Allocate the storage of an ordered map.
+ * @param map - Map descriptor.
+ * @param capacity - Maximum number of entries.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_map_init(struct no_os_map *map, uint32_t capacity)
+{
+	if (!map || !capacity)
+		return -EINVAL;
+
+	map->keys = (uint32_t *)no_os_calloc_tag(capacity, sizeof(*map->keys),
+						 NO_OS_ALLOC_TAG_LIST);
+	if (!map->keys)
+		return -ENOMEM;
+
+	map->values = (void **)no_os_calloc_tag(capacity, sizeof(*map->values),
+						NO_OS_ALLOC_TAG_LIST);
+	if (!map->values) {
+		no_os_free(map->keys);
+		map->keys = NULL;
+		return -ENOMEM;
+	}
+
+	map->nb_elements = 0;
+	map->capacity = capacity;
+
+	return 0;
+}
+
+/**
+ * @brief Free the storage of an ordered map.
+ * @param map - Map descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_map_remove(struct no_os_map *map)
+{
+	if (!map)
+		return -EINVAL;
+
+	no_os_free(map->keys);
+	no_os_free(map->values);
+	map->keys = NULL;
+	map->values = NULL;
+	map->nb_elements = 0;
+	map->capacity = 0;
+
+	return 0;
+}
+
+/* Index of the first key not lower than key, nb_elements if there is none */
+static uint32_t no_os_map_lower_bound(struct no_os_map *map, uint32_t key)
+{
+	uint32_t low = 0;
+	uint32_t high = map->nb_elements;
+	uint32_t mid;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (map->keys[mid] < key)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/**
+ * @brief Add an entry to an ordered map, or replace the value of an existing
+ * key.
+ * @param map - Map descriptor.
+ * @param key - Key of the entry.
+ * @param value - Value of the entry.
+ * @return 0 in case of success, -ENOSPC if the map is full.
+ */
+int32_t no_os_map_add(struct no_os_map *map, uint32_t key, void *value)
+{
+	uint32_t i;
+
+	if (!map || !map->keys)
+		return -EINVAL;
+
+	i = no_os_map_lower_bound(map, key);
+	if (i < map->nb_elements && map->keys[i] == key) {
+		map->values[i] = value;
+		return 0;
+	}
+
+	if (map->nb_elements == map->capacity)
+		return -ENOSPC;
+
+	memmove(&map->keys[i + 1], &map->keys[i],
+		(map->nb_elements - i) * sizeof(*map->keys));
+	memmove(&map->values[i + 1], &map->values[i],
+		(map->nb_elements - i) * sizeof(*map->values));
+	map->keys[i] = key;
+	map->values[i] = value;
+	map->nb_elements++;
+
+	return 0;
+}
+
+/**
+ * @brief Read the value of a key.
+ * @param map - Map descriptor.
+ * @param key - Key to look for.
+ * @param value - Value of the key.
+ * @return 0 in case of success, -ENOENT if the key is not in the map.
+ */
+int32_t no_os_map_read(struct no_os_map *map, uint32_t key, void **value)
+{
+	uint32_t i;
+
+	if (!map || !value)
+		return -EINVAL;
+
+	i = no_os_map_lower_bound(map, key);
+	if (i == map->nb_elements || map->keys[i] != key)
+		return -ENOENT;
+
+	*value = map->values[i];
+
+	return 0;
+}
+
+/**
+ * @brief Read the value of a key and remove the entry.
+ * @param map - Map descriptor.
+ * @param key - Key to look for.
+ * @param value - Value of the key. May be NULL.
+ * @return 0 in case of success, -ENOENT if the key is not in the map.
+ */
+int32_t no_os_map_get(struct no_os_map *map, uint32_t key, void **value)
+{
+	uint32_t i;
+
+	if (!map)
+		return -EINVAL;
+
+	i = no_os_map_lower_bound(map, key);
+	if (i == map->nb_elements || map->keys[i] != key)
+		return -ENOENT;
+
+	if (value)
+		*value = map->values[i];
+
+	map->nb_elements--;
+	memmove(&map->keys[i], &map->keys[i + 1],
+		(map->nb_elements - i) * sizeof(*map->keys));
+	memmove(&map->values[i], &map->values[i + 1],
+		(map->nb_elements - i) * sizeof(*map->values));
+
+	return 0;
+}
+
+/**
+ * @brief Read the entry at a position, to iterate over the map in increasing
+ * order of the keys.
+ * @param map - Map descriptor.
+ * @param idx - Position of the entry, lower than map->nb_elements.
+ * @param key - Key of the entry. May be NULL.
+ * @param value - Value of the entry. May be NULL.
+ * @return 0 in case of success, -ENOENT if idx is out of range.
+ */
+int32_t no_os_map_read_idx(struct no_os_map *map, uint32_t idx, uint32_t *key,
+			   void **value)
+{
+	if (!map)
+		return -EINVAL;
+
+	if (idx >= map->nb_elements)
+		return -ENOENT;
+
+	if (key)
+		*key = map->keys[idx];
+	if (value)
+		*value = map->values[idx];
+
+	return 0;
+}